@@ -1,13 +1,11 @@
 /**
- * adc.c
+ * adc.h
  * ------
- * ADC driver for single-channel sampling using interrupts.
+ * ADC driver for single-channel sampling.
  *
- * Handles ADC initialization, software-triggered conversions,
- * and ISR-based sample acquisition.
- *
- * Raw samples are processed through an
- * envelope filter before being stored.
+ * The interrupt mode starts a conversion on each TIM2 tick and the ISR
+ * stores raw samples into ping-pong blocks; the oversampling mode fills
+ * them by DMA. Each completed block is handed to a PendSV bottom half.
  **/
 
 #ifndef ADC_H
@@ -18,13 +16,76 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "stm32f4xx_ll_adc.h"
+#include "stm32f4xx_ll_dma.h"
 #include "stm32f4xx.h"
 #include "circbuf.h"
+#include "perf.h"
+#include "ramfunc.h"
+
+#define ADC_BLOCK_SIZE 32 // samples per block handed to the bottom half
+#define ADC_MIDRAIL 2048 // 12-bit mid-rail (microphone amp bias point)
+#define ADC_CLOCK_MAX_HZ 36000000U // ADCCLK limit (VDDA >= 2.4 V)
+#define ADC_CHANNEL LL_ADC_CHANNEL_1 // PA1 input
+#define ADC_OVS_SAMPLINGTIME LL_ADC_SAMPLINGTIME_15CYCLES // oversampling mode (27 of ~35 ADCCLK per sample)
+#define ADC_AWD_CHANNEL LL_ADC_AWD_CHANNEL_1_REG // analog watchdog on the regular PA1 conversions
+
+// DMA settings for ADC1 -> memory transfers (DMA2 Stream0, DMA acquisition modes)
+#define ADC_DMA_FIFO_THRESHOLD LL_DMA_FIFOTHRESHOLD_FULL // collect 8 half-word samples per memory burst
+#define ADC_DMA_MEMORY_SIZE LL_DMA_MDATAALIGN_WORD // two samples per AHB write (blocks are word aligned)
+#define ADC_DMA_MBURST LL_DMA_MBURST_INC4 // 4-word (16 byte) memory bursts
+#define ADC_DMA_STREAM LL_DMA_STREAM_0 // ADC1 request (flag accessors below are Stream0 ones)
+#define ADC_DMA_CHANNEL LL_DMA_CHANNEL_0
+
+typedef enum {
+
+	ADC_MODE_NORMAL = 0, // TIM2 ISR starts each conversion, EOC interrupt per sample
+	ADC_MODE_OVERSAMPLE // TIM2 TRGO hardware trigger, DMA into the oversample module
+
+} ADC_Mode_t;
+
+typedef enum {
+
+	ADC_PROFILE_FAST = 0, // 3 cycles, 12 bits
+	ADC_PROFILE_FAST8, // 3 cycles, 8 bits
+	ADC_PROFILE_MEDIUM, // 28 cycles, 12 bits
+	ADC_PROFILE_HIGHZ, // 144 cycles, 12 bits
+	ADC_PROFILE_PRECISE, // 480 cycles at <= 18 MHz, 12 bits
+	ADC_PROFILE_COUNT
+
+} ADC_Profile_t;
+
+// boot acquisition profile (override with -DADC_PROFILE_DEFAULT=ADC_PROFILE_MEDIUM)
+#ifndef ADC_PROFILE_DEFAULT
+#define ADC_PROFILE_DEFAULT ADC_PROFILE_FAST
+#endif
 
 typedef struct {
 	ADC_TypeDef* Instance; // which ADC
 	uint16_t sample; // converted sample
 	CircBuf* circ_buffer; // pointer to circ buffer struct
+	volatile uint32_t trigger_cycles; // cycle count at sample trigger (latency measurement)
+	uint16_t block[2][ADC_BLOCK_SIZE] __attribute__((aligned(16))); // ping-pong raw sample blocks
+	uint16_t fill_index; // next write position in the filling block
+	volatile uint32_t blocks_produced; // completed blocks (ISR); LSB selects filling block
+	uint32_t blocks_consumed; // blocks processed (bottom half)
+	uint32_t blocks_dropped; // blocks overwritten before processing
+	ADC_Mode_t mode; // active acquisition mode
+	volatile ADC_Mode_t requested; // mode to switch to (serviced in main loop)
+	ADC_Profile_t profile; // active acquisition profile (ADC_MODE_NORMAL)
+	volatile ADC_Profile_t requested_profile; // profile to switch to (serviced in main loop)
+	uint32_t adcclk_hz; // ADC clock after the ADCPRE divider
+	uint16_t conv_cycles; // ADCCLK per conversion in ADC_MODE_NORMAL (sampling + resolution)
+	uint8_t resolution; // bits per conversion in ADC_MODE_NORMAL (12, 10, 8, 6)
+	volatile uint8_t requested_resolution; // resolution to switch to (serviced in main loop)
+	uint8_t res_shift; // 12 - resolution: raw << res_shift is on the 12-bit scale
+	uint32_t dma_errors; // DMA transfer errors (oversampling mode)
+	volatile uint32_t samples; // samples in published blocks (both modes)
+	volatile uint32_t overruns; // ADC overruns (DR overwritten before it was read)
+	volatile uint8_t resync; // DMA mode: overrun seen, bottom half restarts the stream once it is disabled
+	uint32_t resync_start; // cycle count when the stream disable was requested
+	PERF_Stat_t resync_wait; // stream disable -> restart: count + max cycles
+	volatile uint32_t block_stamp[2]; // TIMER_STAMP at each block's completion (ISR), per block slot
+	uint32_t stamp; // timestamp of the newest sample of the block being processed (bottom half)
 
 } ADC_Handle_t;
 
@@ -39,18 +100,117 @@ extern ADC_Handle_t adc;
 **/
 void adc_init(ADC_Handle_t* adc, CircBuf* circ_buf);
 
+/**
+  * @brief  Select the smallest ADC prescaler that keeps ADCCLK in spec
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  pclk_hz APB2 clock in Hz
+  * @retval Void
+**/
+void adc_set_clock(ADC_Handle_t* adc, uint32_t pclk_hz);
+
+/**
+  * @brief  Select an acquisition profile (ADCCLK limit, sampling time, resolution)
+  * @note   Thread mode only; one sample may be lost, an active capture restarts.
+  *         The ADCCLK limit picks the smallest ADCPRE divider that stays at or
+  *         below it; the oversampling mode keeps its own setting.
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  profile Profile to run in ADC_MODE_NORMAL
+  * @retval true on success, false for an unknown profile
+**/
+bool adc_set_profile(ADC_Handle_t* adc, ADC_Profile_t profile);
+
+/**
+  * @brief  Short name of an acquisition profile
+  * @param  profile Profile
+  * @retval Name, "?" for an unknown profile
+**/
+const char* adc_profile_name(ADC_Profile_t profile);
+
+/**
+  * @brief  Conversion rate limit of a profile (back-to-back conversions)
+  * @param  profile Profile
+  * @param  pclk_hz APB2 clock in Hz
+  * @retval Conversions per second, 0 for an unknown profile
+**/
+uint32_t adc_profile_rate(ADC_Profile_t profile, uint32_t pclk_hz);
+
+/**
+  * @brief  Duration of a number of ADC clock cycles at the current ADCCLK
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  cycles ADC clock cycles
+  * @retval Duration in ns
+**/
+uint32_t adc_cycles_ns(const ADC_Handle_t* adc, uint32_t cycles);
+
+/**
+  * @brief  Switch acquisition mode
+  * @note   Thread mode only; restarts block accounting for the new mode
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  mode Acquisition mode to run
+  * @retval Void
+**/
+void adc_set_mode(ADC_Handle_t* adc, ADC_Mode_t mode);
+
+/**
+  * @brief  Select the conversion resolution of the interrupt mode
+  * @note   Thread mode only; one sample may be lost, an active capture restarts.
+  *         Results are shifted up by 'res_shift', so later stages stay on the
+  *         12-bit scale and only the step size changes.
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  bits 12, 10, 8 or 6
+  * @retval true on success, false for an unsupported resolution
+**/
+bool adc_set_resolution(ADC_Handle_t* adc, uint8_t bits);
+
+/**
+  * @brief  Arm the analog watchdog on the input channel
+  * @note   The interrupt fires once, then disarms itself
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  low Lower threshold, 12-bit counts
+  * @param  high Upper threshold, 12-bit counts
+  * @retval Void
+**/
+void adc_arm_watchdog(ADC_Handle_t* adc, uint16_t low, uint16_t high);
+
+/**
+  * @brief  Disarm the analog watchdog
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @retval Void
+**/
+void adc_disarm_watchdog(ADC_Handle_t* adc);
+
 /**
   * @brief  Start Analog-to-Digital Conversion
   * @param  *adc Pointer to the ADC_Handle_t instance
   * @retval Void
 **/
-void adc_start_conversion(ADC_Handle_t* adc);
+RAMFUNC void adc_start_conversion(ADC_Handle_t* adc);
+
+/**
+  * @brief  Read ADC sample upon IT, store into current block
+  * @note   Also takes the injected, overrun and analog watchdog interrupts (shared ADC vector).
+  *         DMA mode overrun: the stream is stopped here, the bottom half re-arms
+  *         it before clearing OVR (RM0390 order).
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @retval Void
+**/
+RAMFUNC void adc_handle_irq(ADC_Handle_t* adc);
+
+/**
+  * @brief  DMA half / full transfer: publish the completed half as a block
+  * @note   DMA2 Stream0 interrupt, oversampling mode only
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @retval Void
+**/
+RAMFUNC void adc_handle_dma_irq(ADC_Handle_t* adc);
 
 /**
-  * @brief  Read, process, and store ADC sample upon IT
+  * @brief  Bottom half: filter the latest completed block, update sample
+  * @note   Called from PendSV via the defer module; publishes the block's
+  *         TIMER_STAMP in 'adc.stamp' for the stages that time-stamp output
   * @param  *adc Pointer to the ADC_Handle_t instance
   * @retval Void
 **/
-void adc_handle_irq(ADC_Handle_t* adc);
+void adc_process_block(ADC_Handle_t* adc);
 
 #endif
@@ -0,0 +1,67 @@
+/**
+ * bench.h
+ * --------
+ * On-target benchmarks for the sampling, DSP and transport paths.
+ *
+ * Only built when BENCH_ENABLE is defined. 'bench_run' is called
+ * once from main before sampling starts; results (in core cycles)
+ * are kept in the global 'bench' instance and printed over UART.
+ *
+ * 'bench_poll' prints a one-off size-versus-speed report (build,
+ * clock, flash / RAM footprint, worst-case cycles per stage) once
+ * sampling has run for BENCH_REPORT_TICKS display ticks, one line
+ * per tick and only while the TX backlog is below BENCH_TX_LEVEL, so
+ * the overwriting circular buffer never truncates it.
+ **/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include "uart.h"
+
+#define BENCH_REPORT_TICKS 300 // display ticks (~10 s at 30 Hz) before the report
+#define BENCH_FFT_SIZES 4 // FFT sizes timed: 256, 512, 1024, 2048
+#define BENCH_REPORT_LINES 10 // lines in the 'bench_poll' report
+#define BENCH_TX_LEVEL 128 // print the next line only below this TX backlog (bytes)
+
+typedef struct {
+
+	uint32_t dsp_quiet; // DSP kernel over SRAM data, no DMA traffic
+	uint32_t dsp_dma_byte; // same kernel while DMA moves a block with byte accesses
+	uint32_t dsp_dma_burst; // same kernel while DMA moves the block with FIFO + word bursts
+	uint32_t filter_flash; // envelope filter loop executed from flash (ART on)
+	uint32_t filter_ram; // identical loop executed from SRAM (RAMFUNC)
+	uint32_t rms_fixed; // RMS meter, fixed-point engine (push + sqrt per block)
+	uint32_t rms_float; // RMS meter, FPU engine (push + sqrt per block)
+	uint32_t fft[BENCH_FFT_SIZES]; // real FFT (window + transform + magnitude), 256 .. 2048 points
+	uint32_t dc_track; // DC tracker, cycles per sample
+	uint32_t octave_octave; // octave bank, cycles per input sample (8 bands)
+	uint32_t octave_third; // 1/3-octave bank, cycles per input sample (24 bands, full size)
+	uint32_t decim_block; // polyphase decimator, one ADC block in
+	uint32_t goertzel_full; // Goertzel bank fed one ADC block at the full rate
+	uint32_t goertzel_decim; // decimator + Goertzel bank on the decimated block
+	uint32_t ovs_half; // oversampling CIC + compensation FIR, one DMA half (960 samples)
+
+} BENCH_Results_t;
+
+// global BENCH_Results_t instance
+extern BENCH_Results_t bench;
+
+/**
+  * @brief  Run all benchmarks and print the results
+  * @note   Blocking; call before timers are started
+  * @param  *uart Pointer to the UART_Handle_t used for the report
+  * @retval Void
+**/
+void bench_run(UART_Handle_t* uart);
+
+/**
+  * @brief  Print the size / speed report once, after BENCH_REPORT_TICKS calls
+  * @note   Call on every display tick from the main loop
+  * @param  *uart Pointer to the UART_Handle_t used for the report
+  * @retval Void
+**/
+void bench_poll(UART_Handle_t* uart);
+
+#endif
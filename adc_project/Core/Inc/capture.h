@@ -0,0 +1,171 @@
+/**
+ * capture.h
+ * ----------
+ * Event capture with a pre-trigger ring buffer.
+ *
+ * While armed, every ADC block is copied into a CAPTURE_RING sample
+ * ring, so the 'pre' samples before a trigger are always available.
+ * The trigger fires on the first raw sample more than 'level' counts
+ * away from the tracked DC offset, found either by
+ *
+ *   CAPTURE_TRIG_AWD   : the ADC analog watchdog (window offset +- level);
+ *                        blocks are copied with memcpy and only scanned
+ *                        after the watchdog interrupt, or
+ *   CAPTURE_TRIG_LEVEL : a software compare on every sample.
+ *
+ * 'post' samples (trigger sample included) are then collected and the
+ * ring is frozen. The snapshot is streamed from the main loop while
+ * acquisition carries on, a short frame at a time and only when the
+ * TX buffer has drained, so it never overruns the other output:
+ *
+ *   cap n=2 src=awd pre=1024 post=3072 level=1800 dc=2031 bits=12 t=9310871
+ *   0xA5 0x5C | seq | chunk (2 bytes LE) | stamp (4 bytes LE) | count | count x sample (2 bytes LE) | xor
+ *
+ * At an ADC resolution of 8 bits or less the samples carry no more
+ * than 8 significant bits, so they are sent one byte each (12-bit
+ * scale >> 4), twice as many per frame:
+ *
+ *   0xA5 0x5D | seq | chunk (2 bytes LE) | stamp (4 bytes LE) | count | count x sample (1 byte) | xor
+ *
+ * 't' is the TIMER_STAMP of the trigger sample, 'stamp' the one of the
+ * first sample in the frame.
+ *
+ * The capture re-arms (refilling the pre-trigger part first) once the
+ * snapshot is sent and 'holdoff' samples have passed since the trigger.
+ * Capture runs on the 20 kHz block stream (ADC_MODE_NORMAL) only.
+ **/
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart.h"
+#include "ramfunc.h"
+
+#define CAPTURE_RING 4096 // ring size in samples (power of two, multiple of ADC_BLOCK_SIZE)
+#define CAPTURE_PRE_DEFAULT 1024 // samples before the trigger (51 ms at 20 kHz)
+#define CAPTURE_POST_DEFAULT 3072 // samples from the trigger on (154 ms)
+#define CAPTURE_HOLDOFF_MS_DEFAULT 1000 // minimum time between triggers
+#define CAPTURE_LEVEL_DEFAULT 1800 // counts from the DC offset (about -1 dBFS)
+#define CAPTURE_CHUNK 32 // samples per stream frame (2 x in packed frames)
+#define CAPTURE_TX_LEVEL 64 // send the next frame only below this TX backlog (bytes)
+#define CAPTURE_FRAME_SYNC0 0xA5 // binary frame sync bytes
+#define CAPTURE_FRAME_SYNC1 0x5C
+#define CAPTURE_FRAME_SYNC1_PACKED 0x5D // 1 byte per sample
+
+typedef enum {
+
+	CAPTURE_TRIG_OFF = 0, // capture disabled
+	CAPTURE_TRIG_AWD, // ADC analog watchdog
+	CAPTURE_TRIG_LEVEL // software level compare
+
+} CAPTURE_Trigger_t;
+
+typedef enum {
+
+	CAPTURE_STATE_OFF = 0, // not capturing
+	CAPTURE_STATE_PREFILL, // filling the pre-trigger part of the ring
+	CAPTURE_STATE_ARMED, // waiting for a trigger
+	CAPTURE_STATE_POST, // collecting post-trigger samples
+	CAPTURE_STATE_SEND, // ring frozen, streaming from the main loop
+	CAPTURE_STATE_HOLDOFF // sent, waiting out the holdoff
+
+} CAPTURE_State_t;
+
+typedef struct {
+
+	uint16_t ring[CAPTURE_RING] __attribute__((aligned(4))); // raw samples
+	uint16_t head; // next write position
+
+	// configuration
+	CAPTURE_Trigger_t trigger; // active trigger source
+	volatile CAPTURE_Trigger_t requested; // source to switch to (serviced in 'capture_poll')
+	uint16_t pre; // samples before the trigger
+	uint16_t post; // samples from the trigger on
+	uint32_t holdoff; // samples from one trigger to the next re-arm
+	uint16_t level; // trigger distance from the DC offset, counts
+
+	// bottom half
+	volatile CAPTURE_State_t state; // capture state
+	uint16_t low, high; // trigger window for this arm
+	uint32_t filled; // samples written since (re-)arming
+	uint16_t remaining; // post-trigger samples still to collect
+	uint32_t stamp; // TIMER_STAMP of the trigger sample
+	uint32_t since; // samples since the trigger
+	volatile uint8_t awd_hit; // watchdog fired (ADC ISR), find the sample
+	uint8_t awd_blocks; // blocks scanned for a watchdog hit
+
+	// streaming (main loop)
+	uint16_t start; // oldest snapshot sample in the ring
+	uint16_t sent; // snapshot samples sent
+	uint8_t bits; // ADC resolution while this capture was armed
+	bool announced; // text header for this snapshot sent
+	uint8_t seq; // frame sequence number
+	uint32_t captures; // completed snapshots
+
+} CAPTURE_Handle_t;
+
+// global CAPTURE_Handle_t instance
+extern CAPTURE_Handle_t capture;
+
+/**
+  * @brief  Initialize the capture module (disabled)
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  pre Samples before the trigger
+  * @param  post Samples from the trigger on
+  * @param  holdoff_ms Minimum time between triggers
+  * @retval Void
+**/
+void capture_init(CAPTURE_Handle_t* cap, uint16_t pre, uint16_t post, uint32_t holdoff_ms);
+
+/**
+  * @brief  Change pre / post lengths and holdoff, restarts an active capture
+  * @note   Thread mode only
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  pre Samples before the trigger
+  * @param  post Samples from the trigger on (at least 1)
+  * @param  holdoff_ms Minimum time between triggers
+  * @retval true on success, false if pre + post exceeds CAPTURE_RING
+**/
+bool capture_configure(CAPTURE_Handle_t* cap, uint16_t pre, uint16_t post, uint32_t holdoff_ms);
+
+/**
+  * @brief  Select the trigger source and (re-)arm, or stop capturing
+  * @note   Thread mode only
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  trigger Trigger source, CAPTURE_TRIG_OFF to stop
+  * @retval Void
+**/
+void capture_set_trigger(CAPTURE_Handle_t* cap, CAPTURE_Trigger_t trigger);
+
+/**
+  * @brief  Watchdog interrupt: note the hit for the bottom half
+  * @note   Called from the ADC ISR, which has already disabled the watchdog IT
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @retval Void
+**/
+static inline void capture_awd_hit(CAPTURE_Handle_t* cap) {
+	cap->awd_hit = 1;
+}
+
+/**
+  * @brief  Feed a block of raw ADC samples
+  * @note   Called from the ADC bottom half, before the DC tracker
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void capture_process_block(CAPTURE_Handle_t* cap, const uint16_t* blk, uint32_t len);
+
+/**
+  * @brief  Service trigger requests, stream the snapshot
+  * @note   Call on every main loop pass (not only on the display tick)
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void capture_poll(CAPTURE_Handle_t* cap, UART_Handle_t* uart);
+
+#endif
@@ -27,7 +27,7 @@ typedef struct {
 	uint16_t head; // pointer to head of circular buffer data
 	uint16_t tail; // pointer to tail of circular buffer data
 	uint16_t size; // size of buffer
-	uint8_t buffer[CIRC_BUF_SIZE];
+	uint8_t buffer[CIRC_BUF_SIZE] __attribute__((aligned(16))); // DMA word reads / 16-byte bursts
 
 } CircBuf;
 
@@ -60,6 +60,15 @@ void circbuf_peek_contiguous(CircBuf* circbuf, uint8_t** ptr, uint16_t* len);
 **/
 void circbuf_advance(CircBuf* circbuf, uint16_t len);
 
+/**
+  * @brief  Copy bytes out of the buffer into a linear destination, advance tail
+  * @param  *circbuf Pointer to the CircBuf instance
+  * @param  *dst Destination buffer
+  * @param  len Maximum number of bytes to copy
+  * @retval Number of bytes copied
+**/
+uint16_t circbuf_read(CircBuf* circbuf, uint8_t* dst, uint16_t len);
+
 /**
   * @brief  Return int of count of values currently in buffer
   * @param  *circbuf Pointer to the CircBuf instance
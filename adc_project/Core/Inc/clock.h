@@ -0,0 +1,69 @@
+/**
+ * clock.h
+ * --------
+ * System clock profiles and clock-dependent peripheral setup.
+ *
+ * Two profiles are available:
+ *   LOWPOWER    : 84 MHz, VOS scale 3, no over-drive, 2 wait states
+ *   PERFORMANCE : 180 MHz, VOS scale 1 + over-drive, 5 wait states
+ *
+ * The boot profile is chosen at build time with CLOCK_PROFILE_DEFAULT.
+ * At runtime, write 'sysclk.requested' (main loop / debugger) or call
+ * 'clock_set_profile' from thread mode. After every switch the timer
+ * prescalers, USART BRR and ADC clock divider are recomputed from the
+ * new bus clocks, so the sample rate and baud rate do not change.
+ **/
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+
+typedef enum {
+
+	CLOCK_PROFILE_LOWPOWER = 0, // 84 MHz, VOS scale 3
+	CLOCK_PROFILE_PERFORMANCE, // 180 MHz, VOS scale 1 + over-drive
+	CLOCK_PROFILE_COUNT
+
+} CLOCK_Profile_t;
+
+// boot profile (override with -DCLOCK_PROFILE_DEFAULT=CLOCK_PROFILE_PERFORMANCE)
+#ifndef CLOCK_PROFILE_DEFAULT
+#define CLOCK_PROFILE_DEFAULT CLOCK_PROFILE_LOWPOWER
+#endif
+
+typedef struct {
+
+	CLOCK_Profile_t profile; // active profile
+	volatile CLOCK_Profile_t requested; // profile to switch to (serviced in main loop)
+	uint32_t hclk_hz; // core / AHB clock
+	uint32_t pclk1_hz; // APB1 clock (USART2/3, UART4)
+	uint32_t pclk2_hz; // APB2 clock (ADC, USART1)
+	uint32_t tim_apb1_hz; // APB1 timer clock (TIM2, TIM3)
+	uint32_t switches; // runtime profile changes
+
+} CLOCK_Handle_t;
+
+// global CLOCK_Handle_t instance
+extern CLOCK_Handle_t sysclk;
+
+/**
+  * @brief  Apply boot clock profile
+  * @note   Call right after SystemClock_Config, before peripheral init
+  * @param  *clk Pointer to the CLOCK_Handle_t instance
+  * @param  profile Profile to run
+  * @retval Void
+**/
+void clock_init(CLOCK_Handle_t* clk, CLOCK_Profile_t profile);
+
+/**
+  * @brief  Switch clock profile at runtime
+  * @note   Thread mode only; blocks until UART TX is idle
+  * @param  *clk Pointer to the CLOCK_Handle_t instance
+  * @param  profile Profile to run
+  * @retval Void
+**/
+void clock_set_profile(CLOCK_Handle_t* clk, CLOCK_Profile_t profile);
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * dbfs.h
+ * -------
+ * Linear level -> dBFS conversion without libm.
+ *
+ * log2 is split into an integer part (leading-zero count) and a
+ * fractional part looked up in the generated 'dsp_log2_frac' table,
+ * then scaled by 20 * log10(2). Results are in tenths of a dB
+ * (deci-dB); full scale (0 dBFS) is DBFS_FULL_SCALE ADC counts.
+ **/
+
+#ifndef DBFS_H
+#define DBFS_H
+
+#include <stdint.h>
+
+#define DBFS_FULL_SCALE_LOG2 11 // 0 dBFS = 2048 counts (12-bit half range)
+#define DBFS_FLOOR_DB10 (-999) // returned for a zero level
+
+/**
+  * @brief  log2 of an unsigned integer
+  * @param  x Input value (> 0)
+  * @retval log2(x) in Q16
+**/
+int32_t dbfs_log2_q16(uint32_t x);
+
+/**
+  * @brief  Convert a linear level to dBFS
+  * @param  level Level in ADC counts
+  * @retval Level in deci-dB relative to full scale (DBFS_FLOOR_DB10 for 0)
+**/
+int32_t dbfs_from_level(uint32_t level);
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * dc_track.h
+ * -----------
+ * DC-offset tracker (one-pole high-pass) ahead of the level chain.
+ *
+ * The microphone amplifier bias is nominally ADC_MIDRAIL but drifts
+ * with supply and temperature. The tracker follows it with a one-pole
+ * low-pass in Q16 fixed point,
+ *
+ *   offset += (x - offset) >> shift
+ *
+ * and rewrites each block as x - offset + ADC_MIDRAIL, so every later
+ * stage can keep subtracting ADC_MIDRAIL. With the default shift of 13
+ * the time constant is 8192 samples (0.41 s at 20 kHz), a 0.39 Hz
+ * high-pass corner. Per sample this is a subtract, a shift, an add and
+ * a saturate.
+ *
+ * The tracked offset is published once per block (Q16 and counts) and
+ * reported in telemetry (dc=).
+ **/
+
+#ifndef DC_TRACK_H
+#define DC_TRACK_H
+
+#include <stdint.h>
+#include "ramfunc.h"
+
+#define DC_SHIFT_DEFAULT 13 // time constant 2^13 samples (0.41 s at 20 kHz)
+#define DC_SHIFT_MAX 16 // slowest setting (3.3 s at 20 kHz)
+
+typedef struct {
+
+	int32_t acc; // tracked offset, Q16 counts
+	uint8_t shift; // time constant, 2^shift samples
+	volatile int32_t offset_q16; // offset at the end of the last block, Q16 counts
+	volatile uint16_t offset; // same, rounded to counts
+
+} DC_Handle_t;
+
+// global DC_Handle_t instance
+extern DC_Handle_t dc;
+
+/**
+  * @brief  Initialize the tracker at mid-rail
+  * @param  *dc Pointer to the DC_Handle_t instance
+  * @param  shift Time constant, 2^shift samples (1..DC_SHIFT_MAX)
+  * @retval Void
+**/
+void dc_init(DC_Handle_t* dc, uint8_t shift);
+
+/**
+  * @brief  Track the offset over a block and re-centre it on ADC_MIDRAIL
+  * @note   Called from the ADC bottom half, before any other stage
+  * @param  *dc Pointer to the DC_Handle_t instance
+  * @param  *blk Raw 12-bit samples, corrected in place
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void dc_process_block(DC_Handle_t* dc, uint16_t* blk, uint32_t len);
+
+#endif
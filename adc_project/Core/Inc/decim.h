@@ -0,0 +1,72 @@
+/**
+ * decim.h
+ * --------
+ * Polyphase FIR decimator (Q15) between the ADC blocks and the
+ * stages that do not need the full 20 kHz rate.
+ *
+ * A length-N low-pass h[] decimating by M is split into M phases of
+ * L = N / M taps, phase p holding h[p], h[p + M], ... Every input
+ * sample feeds exactly one phase, and one output is produced per M
+ * inputs, so only the kept outputs are ever computed (N MACs each).
+ *
+ * Each phase keeps its own delay line, stored twice in a row so the
+ * newest L samples are always contiguous. With L even, a phase is
+ * L / 2 dual 16-bit MACs (__SMLAD) over packed sample / coefficient
+ * pairs.
+ *
+ * Input and output use the raw ADC block format (12-bit, mid-rail
+ * biased), so downstream consumers take decimated blocks unchanged.
+ * The default filter (DSP_DECIM_FACTOR / DSP_DECIM_TAPS) is generated
+ * by tools/gen_tables.py; any other polyphase Q15 table can be given
+ * to 'decim_init'.
+ **/
+
+#ifndef DECIM_H
+#define DECIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ramfunc.h"
+#include "dsp_tables.h"
+
+#define DECIM_FACTOR_MAX 8 // largest decimation factor
+#define DECIM_TAPS_MAX 128 // largest filter length
+
+typedef struct {
+
+	uint8_t factor; // decimation factor M
+	uint8_t phase; // phase fed by the next input sample
+	uint16_t taps; // filter length N
+	uint16_t phase_len; // taps per phase L = N / M
+	uint16_t pos; // delay line position (newest sample), shared by all phases
+	const int16_t* coef; // Q15, polyphase order [phase][tap]
+	int16_t line[2 * DECIM_TAPS_MAX] __attribute__((aligned(4))); // per phase: 2 x L samples
+	uint32_t outputs; // samples produced
+
+} DECIM_Handle_t;
+
+// global DECIM_Handle_t instance
+extern DECIM_Handle_t decim;
+
+/**
+  * @brief  Initialize the decimator
+  * @param  *d Pointer to the DECIM_Handle_t instance
+  * @param  factor Decimation factor M (1..DECIM_FACTOR_MAX)
+  * @param  taps Filter length N, a multiple of 2 * M, at most DECIM_TAPS_MAX
+  * @param  *coef Q15 coefficients in polyphase order [phase][tap]
+  * @retval true on success, false if the configuration is not supported
+**/
+bool decim_init(DECIM_Handle_t* d, uint8_t factor, uint16_t taps, const int16_t* coef);
+
+/**
+  * @brief  Decimate a block of raw ADC samples
+  * @note   Called from the ADC bottom half
+  * @param  *d Pointer to the DECIM_Handle_t instance
+  * @param  *in Raw 12-bit samples
+  * @param  *out Output samples, room for len / M + 1
+  * @param  len Number of input samples
+  * @retval Number of output samples written
+**/
+RAMFUNC uint32_t decim_process_block(DECIM_Handle_t* d, const uint16_t* in, uint16_t* out, uint32_t len);
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * defer.h
+ * --------
+ * Deferred-work ("bottom half") facility driven by PendSV.
+ *
+ * Top-half ISRs only acknowledge hardware and post a work item.
+ * Posting sets a bit in a lock-free pending mask and pends PendSV,
+ * which runs at the lowest priority and drains the mask, so
+ * high-priority sampling ISRs stay short and bounded.
+ *
+ * Work items are fixed at build time; lower index runs first.
+ **/
+
+#ifndef DEFER_H
+#define DEFER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include "ramfunc.h"
+
+typedef enum {
+
+	DEFER_ADC_BLOCK = 0, // process a completed ADC sample block
+	DEFER_UART1_TX, // retire / re-arm UART DMA transfer, one item per port (UART_Port_t order)
+	DEFER_UART2_TX,
+	DEFER_UART3_TX,
+	DEFER_UART4_TX,
+	DEFER_COUNT
+
+} DEFER_Work_t;
+
+// bottom-half handler signature
+typedef void (*DEFER_Func_t)(void* ctx);
+
+typedef struct {
+
+	volatile uint32_t pending; // bitmask of posted work items
+	DEFER_Func_t func[DEFER_COUNT]; // registered handlers
+	void* ctx[DEFER_COUNT]; // handler context pointers
+
+} DEFER_Handle_t;
+
+// global DEFER_Handle_t instance
+extern DEFER_Handle_t defer;
+
+/**
+  * @brief  Initialize defer module
+  * @param  *defer Pointer to the DEFER_Handle_t instance
+  * @retval Void
+**/
+void defer_init(DEFER_Handle_t* defer);
+
+/**
+  * @brief  Register the bottom-half handler for a work item
+  * @param  *defer Pointer to the DEFER_Handle_t instance
+  * @param  work Work item to bind
+  * @param  func Handler run from PendSV
+  * @param  *ctx Context pointer passed to the handler
+  * @retval Void
+**/
+void defer_register(DEFER_Handle_t* defer, DEFER_Work_t work, DEFER_Func_t func, void* ctx);
+
+/**
+  * @brief  Post a work item and pend PendSV
+  * @note   Lock-free, safe from any interrupt priority
+  * @param  *defer Pointer to the DEFER_Handle_t instance
+  * @param  work Work item to post
+  * @retval Void
+**/
+RAMFUNC void defer_post(DEFER_Handle_t* defer, DEFER_Work_t work);
+
+/**
+  * @brief  Drain all pending work items
+  * @note   Called from PendSV_Handler only
+  * @param  *defer Pointer to the DEFER_Handle_t instance
+  * @retval Void
+**/
+void defer_run(DEFER_Handle_t* defer);
+
+#endif
@@ -7,6 +7,20 @@
  * ASCII bar graph over UART.
  *
  * Includes envelope smoothing to improve visual responsiveness.
+ * The envelope follower has separate attack (rising) and release
+ * (falling) time constants, given in milliseconds and converted once
+ * to Q16 coefficients for the sample rate, so the per-sample update
+ * is a single multiply and shift.
+ *
+ * The bar can follow either the envelope filter or the sliding
+ * window RMS meter (rms module), selected by 'source'.
+ *
+ * The bar is computed, not looked up: either linear (0..750 counts)
+ * or dBFS over a configurable range (table-based log2, no libm on the
+ * update path), with a peak-hold marker that decays after a hold time.
+ *
+ * With view DISPLAY_VIEW_BANDS the line shows one small bar per band
+ * of the octave analyzer instead (octave module, same dB range).
  **/
 
 #ifndef DISPLAY_H_
@@ -15,11 +29,59 @@
 
 #include "circbuf.h"
 #include "adc.h"
+#include "ramfunc.h"
+
+#define DISPLAY_ATTACK_MS 1 // envelope rise time constant
+#define DISPLAY_RELEASE_MS 120 // envelope fall time constant
+#define DISPLAY_COEF_SHIFT 16 // coefficients are Q16
+
+#define DISPLAY_BAR_CHARS 20 // bar width in characters
+#define DISPLAY_BAR_STEPS (2 * DISPLAY_BAR_CHARS) // half-character resolution
+#define DISPLAY_LINEAR_FULL 750 // level (counts) for a full bar, linear scale
+#define DISPLAY_DB_MIN (-600) // empty bar, deci-dB (-60 dBFS)
+#define DISPLAY_DB_MAX 0 // full bar, deci-dB (0 dBFS)
+#define DISPLAY_PEAK_HOLD_TICKS 45 // peak marker hold (~1.5 s at 30 Hz)
+#define DISPLAY_PEAK_DECAY_TICKS 2 // display ticks per step of peak decay
+#define DISPLAY_BANDS_CHARS 24 // band view: characters shared by all bands
+
+
+typedef enum {
+
+	DISPLAY_SOURCE_ENVELOPE = 0, // rectified IIR envelope (adc->sample)
+	DISPLAY_SOURCE_RMS // sliding-window RMS (rms.level)
+
+} DISPLAY_Source_t;
+
+typedef enum {
+
+	DISPLAY_SCALE_LINEAR = 0, // bar proportional to level
+	DISPLAY_SCALE_DB // bar proportional to dBFS between db_min and db_max
+
+} DISPLAY_Scale_t;
+
+typedef enum {
 
+	DISPLAY_VIEW_LEVEL = 0, // single level bar (source / scale above)
+	DISPLAY_VIEW_BANDS // one bar per octave analyzer band
+
+} DISPLAY_View_t;
 
 typedef struct {
 
-	uint16_t isf; // inverse smoothing factor (for LPF)
+	uint16_t attack_ms; // rise time constant (ms)
+	uint16_t release_ms; // fall time constant (ms)
+	uint32_t attack_coef; // Q16 per-sample coefficient for rising input
+	uint32_t release_coef; // Q16 per-sample coefficient for falling input
+	int32_t env; // envelope state, Q16 ADC counts
+	DISPLAY_View_t view; // what the line shows
+	DISPLAY_Source_t source; // level shown by the bar
+	DISPLAY_Scale_t scale; // bar scale
+	int16_t db_min; // dB scale: empty bar level, deci-dB
+	int16_t db_max; // dB scale: full bar level, deci-dB
+	int32_t db; // last displayed level, deci-dB
+	int32_t peak_step; // peak-hold marker position (bar steps)
+	uint16_t peak_hold; // ticks left before the marker decays
+	uint16_t peak_decay; // ticks since the last decay step
 
 } DISPLAY_Handle_t;
 
@@ -34,16 +96,36 @@ extern DISPLAY_Handle_t disp;
 **/
 void display_init(DISPLAY_Handle_t* disp);
 
+/**
+  * @brief  Set attack / release time constants
+  * @note   Converts to Q16 coefficients for the given sample rate
+  * @param  disp Pointer to the DISP_Handle_t instance
+  * @param  attack_ms Rise time constant in ms
+  * @param  release_ms Fall time constant in ms
+  * @param  sample_rate_hz Rate at which the filter is fed
+  * @retval Void
+**/
+void display_set_time_constants(DISPLAY_Handle_t* disp, uint16_t attack_ms, uint16_t release_ms, uint32_t sample_rate_hz);
+
 /**
   * @brief  Process sample value using envelope filter
   * @param  disp Pointer to the DISP_Handle_t instance
   * @param  raw sample value to process
   * @retval Void
 **/
-uint16_t display_envelope_filter(DISPLAY_Handle_t* disp, uint16_t raw);
+RAMFUNC uint16_t display_envelope_filter(DISPLAY_Handle_t* disp, uint16_t raw);
 
 /**
-  * @brief  Process sample value using envelope filter
+  * @brief  Set the dB range covered by the bar (DISPLAY_SCALE_DB)
+  * @param  disp Pointer to the DISP_Handle_t instance
+  * @param  min_db10 Level at an empty bar, deci-dB (e.g. -600 = -60 dBFS)
+  * @param  max_db10 Level at a full bar, deci-dB
+  * @retval Void
+**/
+void display_set_db_range(DISPLAY_Handle_t* disp, int16_t min_db10, int16_t max_db10);
+
+/**
+  * @brief  Render the level bar (and dB readout) to the UART
   * @param  adc Pointer to ADC_Handle_t instance
   * @param  circ_buf Pointer to CircBuf instance
   * @retval Void
@@ -0,0 +1,44 @@
+/**
+ * dsp_tables.h
+ * -------------
+ * Constant DSP tables.
+ *
+ * GENERATED by tools/gen_tables.py - do not edit by hand.
+ **/
+
+#ifndef DSP_TABLES_H
+#define DSP_TABLES_H
+
+#include <stdint.h>
+
+#define DSP_LOG2_BITS 8 // log2 fraction table index bits
+extern const uint16_t dsp_log2_frac[256]; // log2(1 + i / 256), Q16
+
+#define DSP_FFT_MAX_BITS 11 // log2 of the largest FFT size
+extern const int16_t dsp_fft_hann[2048]; // periodic Hann window, Q15
+
+extern const int16_t dsp_fft_twiddle[2048]; // W^k = exp(-j 2 pi k / 2048), k < 1024, {re, im} Q15
+
+#define DSP_OCT_SECTIONS 3 // biquads per band / per decimation low-pass
+#define DSP_OCT_CENTER_DIV 5 // band centre = stage rate / DSP_OCT_CENTER_DIV
+extern const float dsp_oct_lp[15]; // decimation low-pass, {b0, b1, b2, a1, a2} per section
+extern const float dsp_oct_band[15]; // octave band-pass, {b0, b1, b2, a1, a2} per section
+extern const float dsp_oct_third[45]; // 1/3-octave band-passes, low to high
+
+#define DSP_WEIGHT_FS_HZ 20000 // sample rate the weighting filters were designed for
+#define DSP_WEIGHT_A_SECTIONS 3 // biquads in the A-weighting filter
+#define DSP_WEIGHT_C_SECTIONS 2 // biquads in the C-weighting filter
+extern const float dsp_weight_a[15]; // A-weighting, {b0, b1, b2, a1, a2} per section
+extern const float dsp_weight_c[10]; // C-weighting, {b0, b1, b2, a1, a2} per section
+
+#define DSP_DECIM_FACTOR 4 // default decimation factor
+#define DSP_DECIM_TAPS 96 // default decimator length
+extern const int16_t dsp_decim_coef[96]; // Q15, polyphase order [phase][tap]
+
+#define DSP_OVS_CIC_RATIO 30 // CIC decimation ratio R
+#define DSP_OVS_CIC_ORDER 4 // CIC stages N
+#define DSP_OVS_FIR_DECIM 2 // compensation FIR decimation factor
+#define DSP_OVS_FIR_TAPS 48 // compensation FIR length
+extern const float dsp_ovs_fir[48]; // CIC compensation FIR, unity DC gain
+
+#endif
@@ -0,0 +1,146 @@
+/**
+ * fft.h
+ * ------
+ * Fixed-point spectrum analyzer on the ADC block stream.
+ *
+ * Every 'period' display ticks one frame of 'points' samples is
+ * collected from the ADC bottom half, then transformed in the main
+ * loop (never in an ISR):
+ *
+ *   - mid-rail removal, scale to Q15 with one bit of headroom,
+ *     periodic Hann window
+ *   - N-point real FFT computed as an N/2-point complex radix-2 FFT
+ *     (scaled by 1/2 per stage, no overflow) plus a split step
+ *   - magnitude squared per bin, bins 0 .. N/2-1
+ *
+ * Window and twiddle tables are generated by tools/gen_tables.py for
+ * the largest size and strided for smaller ones. N is a power of two
+ * from FFT_POINTS_MIN to FFT_POINTS_MAX.
+ *
+ * Output (selected by 'output') is grouped into FFT_BANDS bands (peak
+ * bin per band), either as an ASCII spectrum line:
+ *
+ *   fft  .:-=+*#%@ ...
+ *
+ * or as a binary frame on USART2:
+ *
+ *   0xA5 0x5A | log2(N) | bands | seq | stamp (4 bytes LE) | bands x level | xor
+ *
+ * where 'stamp' is the TIMER_STAMP of the newest sample in the frame,
+ * each level byte is 0.5 dB per LSB above FFT_DB_MIN and 'xor' covers
+ * every byte after the sync pair.
+ **/
+
+#ifndef FFT_H
+#define FFT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart.h"
+#include "ramfunc.h"
+#include "dsp_tables.h"
+
+#define FFT_POINTS_MIN 256 // smallest transform size
+#define FFT_POINTS_MAX (1 << DSP_FFT_MAX_BITS) // largest size (table length)
+#define FFT_POINTS_DEFAULT 1024 // 51 ms of signal, 19.5 Hz bins at 20 kHz
+#define FFT_PERIOD_TICKS 15 // display ticks between spectra (~2 per second)
+#define FFT_BANDS 64 // output bands (bins grouped, peak per band)
+#define FFT_DB_MIN (-900) // bottom of the output scale, deci-dB
+#define FFT_ASCII_DB_MIN (-600) // ASCII scale: blank at or below, deci-dB (top is 0 dBFS)
+#define FFT_FRAME_SYNC0 0xA5 // binary frame sync bytes
+#define FFT_FRAME_SYNC1 0x5A
+
+// a full-scale sine (+-16384 after scaling) peaks at 8192 per bin: 8192^2
+#define FFT_FULL_SCALE_LOG2 26
+
+typedef enum {
+
+	FFT_OUTPUT_OFF = 0, // transform only (results in 'mag')
+	FFT_OUTPUT_ASCII, // one text line per spectrum
+	FFT_OUTPUT_BINARY // one binary frame per spectrum
+
+} FFT_Output_t;
+
+typedef enum {
+
+	FFT_IDLE = 0, // waiting for the next period
+	FFT_COLLECTING, // ADC bottom half is filling 'buf'
+	FFT_READY // frame complete, waiting for the main loop
+
+} FFT_State_t;
+
+typedef struct {
+
+	uint16_t points; // transform size N
+	uint16_t period; // display ticks between spectra, 0 = off
+	uint16_t ticks; // ticks since the last spectrum
+	FFT_Output_t output; // output format
+	volatile FFT_State_t state; // collect / transform hand-off
+	uint16_t fill; // samples collected in this frame
+	uint8_t seq; // binary frame sequence number
+	uint32_t stamp; // TIMER_STAMP of the newest sample in the frame
+	uint32_t frames; // spectra computed
+	uint32_t cycles; // cycles of the last transform (window + FFT + magnitude)
+	int16_t buf[FFT_POINTS_MAX] __attribute__((aligned(4))); // samples, then complex work area
+	uint32_t mag[FFT_POINTS_MAX / 2]; // magnitude squared per bin
+
+} FFT_Handle_t;
+
+// global FFT_Handle_t instance
+extern FFT_Handle_t fft;
+
+/**
+  * @brief  Initialize the spectrum analyzer
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  points Transform size (see fft_set_points)
+  * @param  period Display ticks between spectra, 0 disables it
+  * @retval Void
+**/
+void fft_init(FFT_Handle_t* fft, uint16_t points, uint16_t period);
+
+/**
+  * @brief  Change the transform size
+  * @note   Rounded down to a power of two and clamped to
+  *         FFT_POINTS_MIN..FFT_POINTS_MAX; restarts the frame
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  points Requested transform size
+  * @retval Void
+**/
+void fft_set_points(FFT_Handle_t* fft, uint16_t points);
+
+/**
+  * @brief  Copy ADC samples into the frame being collected
+  * @note   Called from the ADC bottom half; no-op unless collecting
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void fft_collect(FFT_Handle_t* fft, const uint16_t* blk, uint32_t len);
+
+/**
+  * @brief  Window, transform and take magnitude squared of a frame in place
+  * @param  *buf N Q15 samples in, complex work area out
+  * @param  *mag N/2 magnitude squared bins out
+  * @param  points Transform size N (power of two, FFT_POINTS_MIN..FFT_POINTS_MAX)
+  * @retval Void
+**/
+void fft_real_q15(int16_t* buf, uint32_t* mag, uint16_t points);
+
+/**
+  * @brief  Convert a magnitude squared bin to deci-dB relative to full scale
+  * @param  mag2 Magnitude squared
+  * @retval Level in deci-dB, at least FFT_DB_MIN
+**/
+int32_t fft_bin_db(uint32_t mag2);
+
+/**
+  * @brief  Count a display tick, start / finish / send a spectrum
+  * @note   Call on every display tick from the main loop
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void fft_poll(FFT_Handle_t* fft, UART_Handle_t* uart);
+
+#endif
@@ -0,0 +1,128 @@
+/**
+ * goertzel.h
+ * -----------
+ * Goertzel tone-detector bank.
+ *
+ * Watches a handful of fixed frequencies (mains hum and harmonics,
+ * pilot tones) at a fraction of the cost of a full FFT. Every
+ * detector runs the second-order Goertzel recurrence
+ *
+ *   s[n] = x[n] + coef * s[n-1] - s[n-2],  coef = 2 cos(2 pi f / fs)
+ *
+ * over a common window of 'window' samples; at the window end each
+ * magnitude is computed once and the states are cleared.
+ *
+ * State is kept as a struct of arrays (coef / s1 / s2 per detector)
+ * so one pass over an ADC block updates the whole bank with
+ * sequential loads and no per-detector call overhead. Arithmetic is
+ * single-precision float on the FPU: at 50 Hz and 20 kHz the
+ * coefficient is 1.9995, too close to 2 for a Q15 / Q14 format.
+ *
+ * The bank is fed from the decimator (decim module), so it runs at a
+ * quarter of the ADC rate; every watched tone is below 2 kHz.
+ *
+ * Each detector has a threshold (ADC counts of sine amplitude) with
+ * 1/8 hysteresis; crossings set an event bit that 'goertzel_poll'
+ * reports from the main loop:
+ *
+ *   tone f=50 on mag=312 t=8250394
+ **/
+
+#ifndef GOERTZEL_H
+#define GOERTZEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart.h"
+#include "ramfunc.h"
+
+#define GOERTZEL_MAX 12 // detectors in the bank
+#define GOERTZEL_WINDOW_DEFAULT 1000 // 200 ms at the decimated 5 kHz, 5 Hz resolution
+#define GOERTZEL_THRESHOLD_DEFAULT 40 // counts of sine amplitude (~-34 dBFS)
+
+typedef struct {
+
+	// per detector (struct of arrays, index = detector)
+	float coef[GOERTZEL_MAX]; // 2 cos(2 pi f / fs)
+	float s1[GOERTZEL_MAX]; // s[n-1]
+	float s2[GOERTZEL_MAX]; // s[n-2]
+	uint16_t freq_hz[GOERTZEL_MAX]; // detector frequency
+	uint16_t threshold[GOERTZEL_MAX]; // event threshold, counts of amplitude
+	volatile uint16_t mag[GOERTZEL_MAX]; // amplitude of the last window, counts
+
+	// bank
+	uint8_t count; // detectors in use
+	uint16_t window; // samples per measurement
+	uint16_t index; // samples into the current window
+	uint32_t sample_rate_hz; // input rate
+	uint32_t active; // bitmask: detector above threshold
+	volatile uint32_t events; // bitmask: detector changed state (main loop clears)
+	uint32_t windows; // completed windows
+	volatile uint32_t stamp; // TIMER_STAMP of the block that closed the last window
+
+} GOERTZEL_Handle_t;
+
+// global GOERTZEL_Handle_t instance
+extern GOERTZEL_Handle_t goertzel;
+
+/**
+  * @brief  Initialize the bank with the default detectors
+  * @note   Mains 50 / 60 Hz with harmonics up to the 5th, 1 kHz pilot
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @param  sample_rate_hz Rate of the samples fed to the bank
+  * @param  window Samples per measurement window
+  * @retval Void
+**/
+void goertzel_init(GOERTZEL_Handle_t* g, uint32_t sample_rate_hz, uint16_t window);
+
+/**
+  * @brief  Remove all detectors
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @retval Void
+**/
+void goertzel_clear(GOERTZEL_Handle_t* g);
+
+/**
+  * @brief  Add a detector to the bank
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @param  freq_hz Frequency to watch (below sample_rate_hz / 2)
+  * @param  threshold Event threshold, counts of sine amplitude
+  * @retval Detector index, or -1 if the bank is full or freq_hz is invalid
+**/
+int32_t goertzel_add(GOERTZEL_Handle_t* g, uint16_t freq_hz, uint16_t threshold);
+
+/**
+  * @brief  Feed one sample to every detector
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @param  x Sample with mid-rail removed
+  * @retval Void
+**/
+static inline void goertzel_push(GOERTZEL_Handle_t* g, float x) {
+
+	for (uint32_t d = 0; d < g->count; d++) {
+		float s0 = x + g->coef[d] * g->s1[d] - g->s2[d];
+		g->s2[d] = g->s1[d];
+		g->s1[d] = s0;
+	}
+}
+
+/**
+  * @brief  Feed a block of raw ADC samples, finish windows as they fill
+  * @note   Called from the ADC bottom half
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void goertzel_process_block(GOERTZEL_Handle_t* g, const uint16_t* blk, uint32_t len);
+
+/**
+  * @brief  Report threshold crossings over UART
+  * @note   Call from the main loop
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void goertzel_poll(GOERTZEL_Handle_t* g, UART_Handle_t* uart);
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * housekeeping.h
+ * ---------------
+ * Supply and temperature housekeeping on ADC1 injected channels.
+ *
+ * Vrefint (IN17), the temperature sensor and VBAT (both IN18, selected
+ * with the VBATE path bit) are converted one at a time as a single
+ * injected conversion. The trigger is TIM2 channel 1 (PWM2, rising
+ * edge at TIMER_HK_TRIGGER_US into each 50 us sample period), so the
+ * conversion always starts after the regular sample has finished and
+ * ends well before the next one:
+ *
+ *   0 us     regular start (TIM2 ISR), 15 ADCCLK
+ *   5 us     injected start (TIM2 CC1), 480 + 12 ADCCLK = 23.4 us at 21 MHz
+ *   50 us    next regular start
+ *
+ * The trigger edge is enabled for one conversion only: the main loop
+ * arms it every 'period' display ticks, the ADC ISR stores the result
+ * and disarms it. Regular sample timing is untouched. Housekeeping
+ * only runs in ADC_MODE_NORMAL (back-to-back conversions leave no gap
+ * in the oversampling mode), and only with an acquisition profile whose
+ * regular conversion ends before the trigger and leaves room for the
+ * injected one (FAST, FAST8 and MEDIUM; not HIGHZ or PRECISE).
+ *
+ * Results use the factory calibration values (VREFINT_CAL, TS_CAL1 /
+ * TS_CAL2) and are reported in telemetry:
+ *
+ *   vdda=3298 temp=31.5 vbat=3012
+ **/
+
+#ifndef HOUSEKEEPING_H
+#define HOUSEKEEPING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HK_PERIOD_TICKS 10 // display ticks between conversions (each channel once a second)
+#define HK_TIMEOUT_TICKS 3 // armed conversion not seen after this many ticks: give up
+#define HK_SAMPLINGTIME LL_ADC_SAMPLINGTIME_480CYCLES // >= 10 us (Vrefint / temperature sensor)
+#define HK_CONVERSION_CYCLES (480U + 12U) // ADCCLK per injected conversion
+#define HK_VBAT_DIVIDER 4 // VBAT bridge ratio on STM32F446
+
+typedef enum {
+
+	HK_VREFINT = 0, // internal reference -> VDDA
+	HK_TEMP, // temperature sensor
+	HK_VBAT, // backup battery (VBAT / HK_VBAT_DIVIDER)
+	HK_CHANNELS
+
+} HK_Channel_t;
+
+typedef enum {
+
+	HK_IDLE = 0, // nothing armed
+	HK_ARMED, // trigger enabled, waiting for the conversion
+	HK_DONE // ISR stored 'raw', main loop converts it
+
+} HK_State_t;
+
+typedef struct {
+
+	uint16_t period; // display ticks between conversions, 0 = off
+	uint16_t ticks; // ticks since the last conversion was armed
+	uint8_t wait; // ticks spent in HK_ARMED
+	HK_Channel_t channel; // channel armed / converted last
+	volatile HK_State_t state; // main loop / ISR hand-off
+	volatile uint16_t raw; // result of the last conversion
+	uint16_t raw_ch[HK_CHANNELS]; // last raw result per channel
+	uint16_t vdda_mv; // analog supply from Vrefint, mV
+	int16_t temp_c10; // die temperature, 0.1 degC
+	uint16_t vbat_mv; // backup battery, mV
+	uint32_t conversions; // completed conversions
+	uint32_t timeouts; // armed conversions that never completed
+
+} HK_Handle_t;
+
+// global HK_Handle_t instance
+extern HK_Handle_t hk;
+
+/**
+  * @brief  Configure the injected group and internal channels
+  * @note   Call after 'adc_init' and 'timer_init'
+  * @param  *hk Pointer to the HK_Handle_t instance
+  * @param  period Display ticks between conversions, 0 disables housekeeping
+  * @retval Void
+**/
+void housekeeping_init(HK_Handle_t* hk, uint16_t period);
+
+/**
+  * @brief  Store an injected result
+  * @note   Called from the ADC ISR, which has already disarmed the trigger
+  * @param  *hk Pointer to the HK_Handle_t instance
+  * @param  raw Injected conversion result
+  * @retval Void
+**/
+static inline void housekeeping_store(HK_Handle_t* hk, uint16_t raw) {
+	hk->raw = raw;
+	hk->state = HK_DONE;
+}
+
+/**
+  * @brief  Convert a finished result, arm the next channel when due
+  * @note   Call on every display tick from the main loop
+  * @param  *hk Pointer to the HK_Handle_t instance
+  * @retval Void
+**/
+void housekeeping_poll(HK_Handle_t* hk);
+
+#endif
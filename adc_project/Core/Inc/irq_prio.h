@@ -0,0 +1,66 @@
+/**
+ * irq_prio.h
+ * -----------
+ * Central NVIC priority plan for the sampling engine.
+ *
+ * All interrupt priorities are defined here and applied once
+ * at startup by 'irq_prio_init', so the relative ordering of
+ * the system lives in a single table.
+ *
+ * Priority grouping 4 is used: 4 bits of pre-emption priority,
+ * no subpriority. Lower number = higher urgency.
+ *
+ *   Level | Group      | IRQs                       | Reason
+ *   ------+------------+----------------------------+---------------------------------
+ *     0   | (reserved) | -                          | free for future hard real-time
+ *     1   | sampling   | TIM2_IRQn, ADC_IRQn,       | sample trigger + capture, short
+ *         |            | DMA2_Stream0_IRQn          | (DMA: oversampling mode)
+ *     4   | transport  | DMA1_Stream6_IRQn,         | UART TX top halves, may be
+ *         |            | USART2_IRQn,               | pre-empted by sampling
+ *         |            | stream of UART_AUX_PORT    | (second port, UART_AUX_ENABLE)
+ *     8   | display    | TIM3_IRQn                  | 30 Hz display tick
+ *    15   | deferred   | PendSV_IRQn                | bottom halves, never delays
+ *         |            |                            | any hardware interrupt
+ *
+ * The CubeMX 'MX_*_Init' functions only enable the IRQs; they carry
+ * no NVIC_SetPriority / NVIC_SetPriorityGrouping calls, so this table
+ * is the single source of truth. After regenerating code from the
+ * .ioc, delete the priority lines CubeMX emits again.
+ *
+ * Building with IRQ_PRIO_FLAT defined restores the original flat
+ * plan (everything at 0,0 with grouping 0) so worst-case sampling
+ * latency can be measured before/after with the perf module.
+ **/
+
+#ifndef IRQ_PRIO_H
+#define IRQ_PRIO_H
+
+#include <stdint.h>
+
+#ifndef IRQ_PRIO_FLAT
+
+#define IRQ_PRIO_GROUPING 		0x00000003U // NVIC_PRIORITYGROUP_4
+#define IRQ_PRIO_SAMPLING 		1U // TIM2 trigger + ADC capture (IRQ or DMA)
+#define IRQ_PRIO_TRANSPORT 		4U // DMA TX complete + USART
+#define IRQ_PRIO_DISPLAY 		8U // display refresh tick
+#define IRQ_PRIO_DEFERRED 		15U // PendSV bottom halves (lowest)
+
+#else
+
+#define IRQ_PRIO_GROUPING 		0x00000007U // NVIC_PRIORITYGROUP_0
+#define IRQ_PRIO_SAMPLING 		0U
+#define IRQ_PRIO_TRANSPORT 		0U
+#define IRQ_PRIO_DISPLAY 		0U
+#define IRQ_PRIO_DEFERRED 		0U
+
+#endif
+
+/**
+  * @brief  Apply priority grouping and per-IRQ priorities from the table
+  * @note   Call after the CubeMX peripheral init, before timers are started
+  * @param  Void
+  * @retval Void
+**/
+void irq_prio_init(void);
+
+#endif
@@ -0,0 +1,165 @@
+/**
+ * octave.h
+ * ---------
+ * Octave / 1/3-octave band analyzer.
+ *
+ * Multirate filter bank: the input runs through OCTAVE_STAGES stages,
+ * each one half the rate of the previous. Every stage filters its
+ * input with the same band-pass design(s) (one band for octaves,
+ * three for 1/3 octaves), then low-passes and drops every other
+ * sample for the next stage. Since the designs are normalized to the
+ * stage rate, one set of coefficients covers every octave:
+ *
+ *   stage 0 (20 kHz): 4 kHz band     stage 4 (1.25 kHz): 250 Hz
+ *   stage 1 (10 kHz): 2 kHz          stage 5: 125 Hz
+ *   stage 2 (5 kHz) : 1 kHz          stage 6: 62.5 Hz
+ *   stage 3 (2.5 kHz): 500 Hz        stage 7: 31.25 Hz
+ *
+ * The whole bank costs under twice the top stage, however low the
+ * bottom band goes.
+ *
+ * Filters are cascaded float DF2T biquads, coefficients generated by
+ * tools/gen_tables.py (6th-order Butterworth band-passes and a
+ * 6th-order Butterworth decimation low-pass).
+ *
+ * Per-band RMS is integrated over 'window' input samples and
+ * published in 'level' (lowest band first). Levels can be shown by
+ * the display module (DISPLAY_VIEW_BANDS) or sent as binary frames:
+ *
+ *   0xA5 0x5B | bands | seq | stamp (4 bytes LE) | bands x level | xor
+ *
+ * where each level byte is 0.5 dB per LSB above OCTAVE_DB_MIN.
+ *
+ * The bank only runs while something reads it (binary output on, or
+ * the display on DISPLAY_VIEW_BANDS); the ADC bottom half calls
+ * 'octave_pause' otherwise, and the next block restarts the filters
+ * and the window from a clean state.
+ **/
+
+#ifndef OCTAVE_H
+#define OCTAVE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart.h"
+#include "ramfunc.h"
+#include "dsp_tables.h"
+
+#define OCTAVE_STAGES 8 // decimation stages (one octave each)
+#define OCTAVE_SECTIONS DSP_OCT_SECTIONS // biquads per filter
+#define OCTAVE_BANDS_MAX (3 * OCTAVE_STAGES) // 1/3-octave bank size
+#define OCTAVE_WINDOW_DEFAULT 5000 // input samples per level (250 ms at 20 kHz)
+#define OCTAVE_DB_MIN (-900) // bottom of the frame scale, deci-dB
+#define OCTAVE_FRAME_SYNC0 0xA5 // binary frame sync bytes
+#define OCTAVE_FRAME_SYNC1 0x5B
+
+typedef enum {
+
+	OCTAVE_MODE_OCTAVE = 0, // one band per stage
+	OCTAVE_MODE_THIRD // three 1/3-octave bands per stage
+
+} OCTAVE_Mode_t;
+
+typedef enum {
+
+	OCTAVE_OUTPUT_OFF = 0, // levels only (display / debugger)
+	OCTAVE_OUTPUT_BINARY // one binary frame per window
+
+} OCTAVE_Output_t;
+
+typedef struct {
+
+	float s1; // DF2T state
+	float s2;
+
+} OCTAVE_State_t;
+
+typedef struct {
+
+	OCTAVE_Mode_t mode; // bank layout
+	OCTAVE_Output_t output; // frame output
+	uint8_t per_stage; // bands per stage (1 or 3)
+	uint8_t bands; // bands in use
+	uint8_t seq; // binary frame sequence number
+	uint16_t window; // input samples per level
+	uint16_t index; // input samples into the current window
+	uint8_t phase[OCTAVE_STAGES]; // decimation phase per stage
+	uint32_t count[OCTAVE_STAGES]; // samples per stage in this window
+	OCTAVE_State_t lp[OCTAVE_STAGES - 1][OCTAVE_SECTIONS]; // decimation low-pass state
+	OCTAVE_State_t band[OCTAVE_BANDS_MAX][OCTAVE_SECTIONS]; // band-pass state, lowest band first
+	float sumsq[OCTAVE_BANDS_MAX]; // band output energy in this window
+	volatile uint16_t level[OCTAVE_BANDS_MAX]; // band RMS, ADC counts, lowest band first
+	volatile uint32_t windows; // completed windows
+	volatile uint32_t stamp; // TIMER_STAMP of the block that closed the last window
+	uint32_t sent; // windows sent as frames
+	bool active; // fed on the last block (false: restart on the next one)
+
+} OCTAVE_Handle_t;
+
+// global OCTAVE_Handle_t instance
+extern OCTAVE_Handle_t octave;
+
+/**
+  * @brief  Initialize the band analyzer
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  mode Octave or 1/3-octave bank
+  * @param  window Input samples per level
+  * @retval Void
+**/
+void octave_init(OCTAVE_Handle_t* oct, OCTAVE_Mode_t mode, uint16_t window);
+
+/**
+  * @brief  Switch between octave and 1/3-octave bank, clears all state
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  mode Octave or 1/3-octave bank
+  * @retval Void
+**/
+void octave_set_mode(OCTAVE_Handle_t* oct, OCTAVE_Mode_t mode);
+
+/**
+  * @brief  Centre frequency of a band
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  band Band index, lowest first
+  * @param  sample_rate_hz Input rate
+  * @retval Centre frequency in Hz
+**/
+float octave_band_hz(OCTAVE_Handle_t* oct, uint32_t band, uint32_t sample_rate_hz);
+
+/**
+  * @brief  Feed one sample through the bank
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  x Sample with mid-rail removed
+  * @retval Void
+**/
+RAMFUNC void octave_push(OCTAVE_Handle_t* oct, float x);
+
+/**
+  * @brief  Feed a block of raw ADC samples
+  * @note   Called from the ADC bottom half
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void octave_process_block(OCTAVE_Handle_t* oct, const uint16_t* blk, uint32_t len);
+
+/**
+  * @brief  Note that a block was skipped, the next one restarts the bank
+  * @note   Called from the ADC bottom half instead of 'octave_process_block'
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @retval Void
+**/
+static inline void octave_pause(OCTAVE_Handle_t* oct) {
+	oct->active = false;
+}
+
+/**
+  * @brief  Send a binary frame when a new window has completed
+  * @note   Call on every display tick from the main loop
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void octave_poll(OCTAVE_Handle_t* oct, UART_Handle_t* uart);
+
+#endif
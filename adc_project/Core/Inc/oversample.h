@@ -0,0 +1,129 @@
+/**
+ * oversample.h
+ * -------------
+ * Oversampling acquisition: CIC decimator + compensation FIR.
+ *
+ * In ADC_MODE_OVERSAMPLE the ADC is triggered by TIM2 TRGO at
+ * OVS_ADC_RATE_HZ (600 kHz) and DMA2 Stream0 writes the samples into
+ * the two halves of 'dma' in circular mode. Each completed half goes
+ * through the ADC bottom half to 'oversample_process_block':
+ *
+ *   600 kHz -> CIC, N = 4, R = 30 -> 20 kHz -> FIR / 2 -> 10 kHz
+ *
+ * The CIC runs in wrapping 32-bit integer arithmetic (12 + N log2 R
+ * bits fit), the compensation FIR (inverse sinc^N droop, flat to
+ * 3 kHz) is float and only computes the kept outputs. The ADC noise
+ * acts as dither, so every x4 in rate buys about one more bit; the
+ * output is published in 12-bit counts with a fraction ('sample') and
+ * as a 16-bit code ('code').
+ *
+ * Mean and RMS noise of the output and of the raw ADC samples are
+ * measured over 'window' outputs; with a quiet (DC) input,
+ * 'oversample_poll' reports the noise-limited resolution and noise
+ * floor once per window:
+ *
+ *   ovs n=3 mean=2047.30 noise=0.101 enob=13.5 floor=-83.1 raw_noise=0.851 raw_enob=10.4 t=4001322
+ *
+ * where enob = log2(4096 / (noise * sqrt(12))) and floor is the noise
+ * relative to a full-scale sine, in dBFS.
+ **/
+
+#ifndef OVERSAMPLE_H
+#define OVERSAMPLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart.h"
+#include "ramfunc.h"
+#include "timer.h"
+#include "dsp_tables.h"
+
+#define OVS_CIC_RATIO DSP_OVS_CIC_RATIO // CIC decimation ratio R
+#define OVS_CIC_ORDER DSP_OVS_CIC_ORDER // CIC stages N
+#define OVS_FIR_DECIM DSP_OVS_FIR_DECIM // compensation FIR decimation
+#define OVS_FIR_TAPS DSP_OVS_FIR_TAPS // compensation FIR length
+#define OVS_ADC_RATE_HZ (TIM2_RATE_HZ * OVS_CIC_RATIO) // ADC trigger rate (600 kHz)
+#define OVS_RATE_HZ (TIM2_RATE_HZ / OVS_FIR_DECIM) // output rate (10 kHz)
+#define OVS_DMA_HALF (32 * OVS_CIC_RATIO) // samples per DMA half (1.6 ms, 32 CIC outputs)
+#define OVS_WINDOW_DEFAULT 10000 // outputs per statistics window (1 s)
+
+typedef struct {
+
+	// DMA target, two halves of one circular transfer
+	uint16_t dma[2][OVS_DMA_HALF] __attribute__((aligned(16)));
+
+	// CIC state (wrapping arithmetic)
+	uint32_t integ[OVS_CIC_ORDER]; // integrators, input rate
+	uint32_t comb[OVS_CIC_ORDER]; // comb delays, CIC output rate
+	uint8_t cic_phase; // input samples into the current CIC output
+	float cic_scale; // 1 / R^N
+
+	// compensation FIR
+	float line[2 * OVS_FIR_TAPS]; // delay line, stored twice
+	uint16_t pos; // newest sample in 'line'
+	uint8_t fir_phase; // CIC outputs into the current FIR output
+
+	// output
+	volatile float sample; // latest output, ADC counts
+	volatile uint16_t code; // latest output, 16-bit code (counts x 16)
+	uint32_t outputs; // samples produced
+
+	// statistics (bottom half), relative to the previous window mean
+	uint32_t window; // outputs per window
+	uint32_t count; // outputs in this window
+	float ref; // output reference
+	float sum, sumsq; // output deviation sums
+	int32_t raw_ref; // raw reference, counts
+	int64_t raw_sum, raw_sumsq; // raw deviation sums
+	uint32_t raw_count; // raw samples in this window
+	bool primed; // references set (first window after reset is discarded)
+
+	// published once per window
+	volatile float mean; // output mean, counts
+	volatile float noise; // output RMS noise, counts (12-bit LSB)
+	volatile float raw_noise; // raw ADC RMS noise, counts
+	volatile uint32_t windows; // completed windows
+	volatile uint32_t stamp; // TIMER_STAMP of the DMA half that closed the last window
+	uint32_t reported; // windows reported by 'oversample_poll'
+
+} OVS_Handle_t;
+
+// global OVS_Handle_t instance
+extern OVS_Handle_t ovs;
+
+/**
+  * @brief  Initialize the oversampling chain
+  * @param  *ovs Pointer to the OVS_Handle_t instance
+  * @param  window Outputs per statistics window
+  * @retval Void
+**/
+void oversample_init(OVS_Handle_t* ovs, uint32_t window);
+
+/**
+  * @brief  Clear filter and statistics state
+  * @note   Called by 'adc_set_mode' before the DMA is started
+  * @param  *ovs Pointer to the OVS_Handle_t instance
+  * @retval Void
+**/
+void oversample_reset(OVS_Handle_t* ovs);
+
+/**
+  * @brief  Run one DMA half through the CIC and compensation FIR
+  * @note   Called from the ADC bottom half
+  * @param  *ovs Pointer to the OVS_Handle_t instance
+  * @param  *in Raw 12-bit samples at OVS_ADC_RATE_HZ
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void oversample_process_block(OVS_Handle_t* ovs, const uint16_t* in, uint32_t len);
+
+/**
+  * @brief  Report mean, noise and resolution when a window has completed
+  * @note   Call on every display tick from the main loop
+  * @param  *ovs Pointer to the OVS_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void oversample_poll(OVS_Handle_t* ovs, UART_Handle_t* uart);
+
+#endif
@@ -0,0 +1,64 @@
+/**
+ * perf.h
+ * -------
+ * Cycle-level performance instrumentation using the DWT cycle counter.
+ *
+ * Provides count / last / worst-case statistics for timing-critical
+ * paths. Results live in the global 'perf' instance so they can be
+ * watched live from the debugger (Live Expressions).
+ **/
+
+#ifndef PERF_H
+#define PERF_H
+
+#include <stdint.h>
+#include "stm32f4xx.h"
+#include "ramfunc.h"
+
+// read current core cycle count
+#define PERF_CYCLES() (DWT->CYCCNT)
+
+typedef struct {
+
+	uint32_t count; // number of recorded measurements
+	uint32_t last; // most recent measurement (cycles)
+	uint32_t max; // worst-case measurement (cycles)
+
+} PERF_Stat_t;
+
+typedef struct {
+
+	uint32_t cycles_per_us; // core cycles per microsecond
+	PERF_Stat_t sample_latency; // TIM2 update event -> sample captured
+	PERF_Stat_t adc_isr; // ADC top-half duration
+	PERF_Stat_t adc_block; // ADC bottom half (filter one block)
+
+} PERF_Handle_t;
+
+// global PERF_Handle_t instance
+extern PERF_Handle_t perf;
+
+/**
+  * @brief  Initialize perf module, enable DWT cycle counter
+  * @note   Call again after changing the core clock
+  * @param  *perf Pointer to the PERF_Handle_t instance
+  * @retval Void
+**/
+void perf_init(PERF_Handle_t* perf);
+
+/**
+  * @brief  Record a single measurement
+  * @param  *stat Pointer to the PERF_Stat_t to update
+  * @param  cycles Measured duration in core cycles
+  * @retval Void
+**/
+RAMFUNC void perf_record(PERF_Stat_t* stat, uint32_t cycles);
+
+/**
+  * @brief  Clear a statistic
+  * @param  *stat Pointer to the PERF_Stat_t to clear
+  * @retval Void
+**/
+void perf_reset(PERF_Stat_t* stat);
+
+#endif
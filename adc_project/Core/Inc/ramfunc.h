@@ -0,0 +1,28 @@
+/**
+ * ramfunc.h
+ * ----------
+ * Placement of hot code in SRAM.
+ *
+ * Functions marked RAMFUNC go to the '.ramfunc' output section, which
+ * the linker script places in RAM with its load image in flash; the
+ * startup code copies it next to '.data'. Code in SRAM runs without
+ * flash wait states, which matters most at 180 MHz (5 wait states).
+ *
+ * RAMFUNC must appear on both the prototype and the definition:
+ * 'long_call' makes callers in flash use a register branch, since
+ * SRAM is out of range of a plain BL from flash.
+ *
+ * Build with RAMFUNC_DISABLE to keep everything in flash (for
+ * flash vs RAM comparisons with the perf / bench modules).
+ **/
+
+#ifndef RAMFUNC_H
+#define RAMFUNC_H
+
+#ifdef RAMFUNC_DISABLE
+#define RAMFUNC
+#else
+#define RAMFUNC __attribute__((section(".ramfunc"), long_call, noinline))
+#endif
+
+#endif
@@ -0,0 +1,153 @@
+/**
+ * rms.h
+ * ------
+ * Sliding-window RMS level meter.
+ *
+ * Keeps a ring of squared (mid-rail removed) samples and a running
+ * sum, so each new sample costs O(1): add the new square, subtract
+ * the one leaving the window. The square root is taken once per
+ * block, not per sample.
+ *
+ * Two engines are provided:
+ *   RMS_Fixed_t : uint32 squares, uint64 sum, exact (no drift)
+ *   RMS_Float_t : float squares / sum on the FPU; the running sum
+ *                 is rebuilt from the ring once per window, so
+ *                 add/subtract rounding (1 ulp = 512 near a
+ *                 full-scale sum of 4e9) cannot accumulate
+ * The live meter uses the fixed engine unless RMS_USE_FPU is
+ * defined; the bench module times both.
+ **/
+
+#ifndef RMS_H
+#define RMS_H
+
+#include <stdint.h>
+#include "ramfunc.h"
+
+#define RMS_WINDOW_MAX 1024 // ring capacity (samples)
+#define RMS_WINDOW_DEFAULT 400 // 20 ms at 20 kHz
+
+typedef struct {
+
+	uint16_t window; // samples in the window (<= RMS_WINDOW_MAX)
+	uint16_t index; // oldest entry / next write position
+	uint64_t sum; // running sum of squares
+	uint32_t sq[RMS_WINDOW_MAX]; // ring of squared samples
+
+} RMS_Fixed_t;
+
+typedef struct {
+
+	uint16_t window; // samples in the window (<= RMS_WINDOW_MAX)
+	uint16_t index; // oldest entry / next write position
+	float sum; // running sum of squares
+	float sq[RMS_WINDOW_MAX]; // ring of squared samples
+
+} RMS_Float_t;
+
+typedef struct {
+
+#ifdef RMS_USE_FPU
+	RMS_Float_t eng; // FPU engine
+#else
+	RMS_Fixed_t eng; // fixed-point engine
+#endif
+	volatile uint16_t level; // RMS level in ADC counts (updated per block)
+
+} RMS_Handle_t;
+
+// global RMS_Handle_t instance
+extern RMS_Handle_t rms;
+
+/**
+  * @brief  Push one sample into the fixed-point window
+  * @param  *eng Pointer to the RMS_Fixed_t engine
+  * @param  x Sample with mid-rail removed
+  * @retval Void
+**/
+static inline void rms_fixed_push(RMS_Fixed_t* eng, int32_t x) {
+
+	uint32_t sq = (uint32_t)(x * x);
+	eng->sum += sq;
+	eng->sum -= eng->sq[eng->index];
+	eng->sq[eng->index] = sq;
+	if (++eng->index >= eng->window) {
+		eng->index = 0;
+	}
+}
+
+/**
+  * @brief  Rebuild the FPU running sum from the ring
+  * @note   Called once per window from 'rms_float_push' (O(1) per sample on average)
+  * @param  *eng Pointer to the RMS_Float_t engine
+  * @retval Void
+**/
+RAMFUNC void rms_float_resum(RMS_Float_t* eng);
+
+/**
+  * @brief  Push one sample into the FPU window
+  * @param  *eng Pointer to the RMS_Float_t engine
+  * @param  x Sample with mid-rail removed
+  * @retval Void
+**/
+static inline void rms_float_push(RMS_Float_t* eng, int32_t x) {
+
+	float xf = (float)x;
+	float sq = xf * xf;
+	eng->sum += sq - eng->sq[eng->index];
+	eng->sq[eng->index] = sq;
+	if (++eng->index >= eng->window) {
+		eng->index = 0;
+		rms_float_resum(eng);
+	}
+}
+
+/**
+  * @brief  Reset the fixed-point engine with a new window length
+  * @param  *eng Pointer to the RMS_Fixed_t engine
+  * @param  window Window length in samples (clamped to 1..RMS_WINDOW_MAX)
+  * @retval Void
+**/
+void rms_fixed_init(RMS_Fixed_t* eng, uint16_t window);
+
+/**
+  * @brief  Current RMS of the fixed-point window
+  * @param  *eng Pointer to the RMS_Fixed_t engine
+  * @retval RMS in ADC counts
+**/
+uint16_t rms_fixed_value(RMS_Fixed_t* eng);
+
+/**
+  * @brief  Reset the FPU engine with a new window length
+  * @param  *eng Pointer to the RMS_Float_t engine
+  * @param  window Window length in samples (clamped to 1..RMS_WINDOW_MAX)
+  * @retval Void
+**/
+void rms_float_init(RMS_Float_t* eng, uint16_t window);
+
+/**
+  * @brief  Current RMS of the FPU window
+  * @param  *eng Pointer to the RMS_Float_t engine
+  * @retval RMS in ADC counts
+**/
+uint16_t rms_float_value(RMS_Float_t* eng);
+
+/**
+  * @brief  Initialize the live meter
+  * @param  *rms Pointer to the RMS_Handle_t instance
+  * @param  window Window length in samples
+  * @retval Void
+**/
+void rms_init(RMS_Handle_t* rms, uint16_t window);
+
+/**
+  * @brief  Feed a block of raw ADC samples, publish the new level
+  * @note   Called from the ADC bottom half
+  * @param  *rms Pointer to the RMS_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void rms_process_block(RMS_Handle_t* rms, const uint16_t* blk, uint32_t len);
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * selftest.h
+ * -----------
+ * ADC acquisition profile self-test.
+ *
+ * For every ADC_Profile_t the ADC runs SELFTEST_SAMPLES back-to-back
+ * conversions (continuous mode, DMA2 Stream0 into a local buffer, no
+ * interrupts). The time from the first to the last DMA transfer gives
+ * the measured conversion rate, to compare against the computed limit
+ * 'adc_profile_rate'; the settled samples give mean and RMS noise on
+ * the 12-bit scale (input quiet for a meaningful noise figure):
+ *
+ *   selftest prof=fast clk=21000000 max=1400000 meas=1399986 mean=2047.31 noise=0.412
+ *
+ * 'selftest_run' is called once from main before the timers start;
+ * writing 'selftest.requested' repeats it at runtime (ADC_MODE_NORMAL
+ * only). Sampling pauses for the duration (under 0.1 s) and resumes
+ * on the profile that was active before.
+ **/
+
+#ifndef SELFTEST_H
+#define SELFTEST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "adc.h"
+#include "uart.h"
+
+#define SELFTEST_SAMPLES 1024 // conversions per profile
+#define SELFTEST_SETTLE 16 // first conversions left out of the noise figure
+#define SELFTEST_TX_LEVEL 128 // print the next line only below this TX backlog (bytes)
+
+typedef struct {
+
+	uint32_t adcclk_hz; // ADC clock the profile ran at
+	uint32_t rate_max; // computed conversions per second
+	uint32_t rate; // measured conversions per second, 0 = timed out
+	float mean; // mean of the settled samples, 12-bit counts
+	float noise; // RMS noise of the settled samples, 12-bit counts
+
+} SELFTEST_Result_t;
+
+typedef struct {
+
+	volatile uint8_t requested; // run again (serviced in 'selftest_poll')
+	uint32_t runs; // completed self-tests
+	SELFTEST_Result_t result[ADC_PROFILE_COUNT]; // last result per profile
+
+} SELFTEST_Handle_t;
+
+// global SELFTEST_Handle_t instance
+extern SELFTEST_Handle_t selftest;
+
+/**
+  * @brief  Measure conversion rate and noise of every acquisition profile
+  * @note   Blocking, thread mode only; call after 'adc_init'
+  * @param  *st Pointer to the SELFTEST_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for the report
+  * @retval Void
+**/
+void selftest_run(SELFTEST_Handle_t* st, UART_Handle_t* uart);
+
+/**
+  * @brief  Run the self-test when requested
+  * @note   Call from the main loop
+  * @param  *st Pointer to the SELFTEST_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for the report
+  * @retval Void
+**/
+void selftest_poll(SELFTEST_Handle_t* st, UART_Handle_t* uart);
+
+#endif
@@ -63,6 +63,12 @@ void TIM2_IRQHandler(void);
 void TIM3_IRQHandler(void);
 void USART2_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void DMA2_Stream0_IRQHandler(void);
+#ifdef UART_AUX_ENABLE
+void DMA2_Stream7_IRQHandler(void);
+void DMA1_Stream3_IRQHandler(void);
+void DMA1_Stream4_IRQHandler(void);
+#endif
 
 /* USER CODE END EFP */
 
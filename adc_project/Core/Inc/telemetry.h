@@ -0,0 +1,51 @@
+/**
+ * telemetry.h
+ * ------------
+ * Periodic telemetry line over UART.
+ *
+ * Every 'period' display ticks a single line of key=value pairs is
+ * queued to the TX circular buffer, on its own line so host tools
+ * can grep it out of the bar-graph stream:
+ *
+ *   tlm n=12 src=rms wt=A dc=2031.4 env=143 rms=161 db=-22.1 blk=7500 drop=0 smp=240000 ovr=0 prof=fast res=12 t=12001544 vdda=3298 temp=31.5 vbat=3012
+ *
+ * A period of 0 disables telemetry.
+ **/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "uart.h"
+
+#define TELEMETRY_PERIOD_TICKS 30 // display ticks between lines (~1 s at 30 Hz)
+
+typedef struct {
+
+	uint16_t period; // display ticks between lines, 0 = off
+	uint16_t ticks; // ticks since the last line
+	uint32_t frames; // lines sent
+
+} TELEM_Handle_t;
+
+// global TELEM_Handle_t instance
+extern TELEM_Handle_t telem;
+
+/**
+  * @brief  Initialize telemetry module
+  * @param  *telem Pointer to the TELEM_Handle_t instance
+  * @param  period Display ticks between lines, 0 disables output
+  * @retval Void
+**/
+void telemetry_init(TELEM_Handle_t* telem, uint16_t period);
+
+/**
+  * @brief  Count a display tick, send a line when the period elapses
+  * @note   Call on every display tick from the main loop
+  * @param  *telem Pointer to the TELEM_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void telemetry_poll(TELEM_Handle_t* telem, UART_Handle_t* uart);
+
+#endif
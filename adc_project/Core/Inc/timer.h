@@ -6,23 +6,46 @@
  * Uses hardware timers to generate fixed-rate software ticks
  * for ADC sampling and display updates.
  *
- * Timer ISRs set software flags that are serviced in the main loop
- * to avoid blocking or heavy processing in interrupt context.
+ * The TIM2 ISR starts each ADC conversion directly so sample timing
+ * never depends on the main loop. The TIM3 ISR sets a software flag
+ * that is serviced in the main loop to avoid heavy processing in
+ * interrupt context.
+ *
+ * Prescalers are derived from the APB1 timer clock so both timers
+ * always count at TIMER_TICK_HZ, whatever the active clock profile.
+ *
+ * For the oversampling acquisition mode TIM2 is switched to a hardware
+ * ADC trigger instead ('timer_set_adc_trigger'): no interrupt, TRGO on
+ * update, counting at the full timer clock.
+ *
+ * TIM2 channel 1 (PWM2, no pin) rises TIMER_HK_TRIGGER_US into each
+ * sample period, after the regular conversion; it is the trigger for
+ * the injected housekeeping conversions.
+ *
+ * TIM5 (32-bit) free-runs at TIMER_STAMP_HZ as the timestamp base for
+ * ADC blocks and outgoing frames. It wraps after 2^32 us (71.6 min);
+ * host tools unwrap it. A clock profile switch keeps the count.
  **/
 
 #ifndef TIMER_H
 #define TIMER_H
 
 #include <stdint.h>
+#include "stm32f4xx.h"
+#include "ramfunc.h"
 
-#define TIM2_PRESCALER 83 // 1 Mhz timer clock
-#define TIM2_AUTORELOAD 49 // ~20 kHz ADC trigger
-#define TIM3_PRESCALER 83 // 1 Mhz timer clock
-#define TIM3_AUTORELOAD 33332// ~ 30 Hz display update
+#define TIMER_TICK_HZ 1000000U // 1 Mhz timer clock (both timers)
+#define TIM2_RATE_HZ 20000U // 20 kHz ADC trigger
+#define TIM3_RATE_HZ 30U // ~ 30 Hz display update
+#define TIMER_HK_TRIGGER_US 5U // TIM2 CC1 edge (injected housekeeping trigger) into each sample period
+#define TIMER_STAMP_HZ 1000000U // TIM5 timestamp rate (1 us per tick)
+#define TIMER_STAMP_PER_SAMPLE (TIMER_STAMP_HZ / TIM2_RATE_HZ) // timestamp ticks per 20 kHz sample
 
+// current timestamp (TIM5 counter): a single register read
+#define TIMER_STAMP() (TIM5->CNT)
 
-// global adc_tick and display_tick software flags
-extern volatile uint8_t adc_tick;
+
+// global display_tick software flag
 extern volatile uint8_t display_tick;
 
 typedef struct {
@@ -31,6 +54,8 @@ typedef struct {
 	uint32_t autoreload2; // timer 2 autoreload value
 	uint32_t prescaler3; // timer 3 prescaler value
 	uint32_t autoreload3; // timer 3 autoreload value
+	uint32_t prescaler5; // timer 5 (timestamp) prescaler value
+	uint32_t adc_trigger_hz; // TIM2 TRGO rate in hardware trigger mode, 0 = ISR trigger
 
 } TIM_Handle_t;
 
@@ -45,11 +70,29 @@ extern TIM_Handle_t timer;
 void timer_init(TIM_Handle_t* timer);
 
 /**
-  * @brief  Update adc_tick software flag
+  * @brief  Recompute prescalers for a new timer clock
+  * @note   Counters should be stopped by the caller
+  * @param  *timer Pointer to the TIM_Handle_t instance
+  * @param  tim_clk_hz APB1 timer clock in Hz
+  * @retval Void
+**/
+void timer_set_clock(TIM_Handle_t* timer, uint32_t tim_clk_hz);
+
+/**
+  * @brief  Switch TIM2 between ISR trigger and hardware (TRGO) ADC trigger
+  * @note   Stops and restarts TIM2; rate_hz must divide the timer clock
+  * @param  *timer Pointer to the TIM_Handle_t instance
+  * @param  rate_hz TRGO rate, or 0 for the TIM2_RATE_HZ interrupt trigger
+  * @retval Void
+**/
+void timer_set_adc_trigger(TIM_Handle_t* timer, uint32_t rate_hz);
+
+/**
+  * @brief  Start ADC conversion, stamp trigger time
   * @param  Void
   * @retval Void
 **/
-void timer_handle_irq2(void);
+RAMFUNC void timer_handle_irq2(void);
 
 /**
   * @brief  Update display_tick software flag
@@ -3,9 +3,10 @@
  * -------
  * UART transmission driver using DMA and a circular buffer.
  *
- * Provides non-blocking output over USART2 by
+ * Provides non-blocking output over a USART by
  * buffering characters (with circbuf module) and
  * transmitting the largest contiguous chunk via DMA.
+ * One handle per port, each with its own buffer.
  *
  * Designed for low CPU burden.
  **/
@@ -18,45 +19,143 @@
 #include "stm32f4xx_ll_dma.h"
 #include "stm32f4xx_ll_usart.h"
 #include "circbuf.h"
+#include "perf.h"
+#include "defer.h"
+#include "ramfunc.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
 
+#define UART_BAUDRATE 115200U // line rate, BRR recomputed per clock profile
+#define UART_AUX_BAUDRATE 115200U // second port line rate (UART_AUX_ENABLE)
+#define UART_AUX_PORT UART_PORT_USART1 // second port: USART1, USART3 or UART4 (stream handlers in stm32f4xx_it.c)
+
+#define UART_DBM_CHUNK 64 // bytes per double-buffer half (continuous mode)
+
+#define UART_DMA_FIFO 1 // 1: FIFO mode, word reads where aligned; 0: direct mode (byte reads)
+#define UART_DMA_FIFO_THRESHOLD LL_DMA_FIFOTHRESHOLD_FULL // FIFO level (16 bytes) that drains to memory side
+#define UART_DMA_BURST_BEATS 4 // memory burst in words: 1 or 4 (4 x 4 bytes must fit the threshold)
+
+typedef enum {
+
+	UART_PORT_USART1 = 0, // TX PA9, DMA2 Stream7 channel 4 (APB2)
+	UART_PORT_USART2, // TX PA2, DMA1 Stream6 channel 4 (APB1, ST-LINK VCP)
+	UART_PORT_USART3, // TX PB10, DMA1 Stream3 channel 4 (APB1)
+	UART_PORT_UART4, // TX PA0, DMA1 Stream4 channel 4 (APB1)
+	UART_PORT_COUNT
+
+} UART_Port_t;
+
+typedef enum {
+
+	UART_TX_IDLE = 0, // stream disabled, may be configured
+	UART_TX_ACTIVE, // transfer in flight
+	UART_TX_STREAMING, // double-buffer (DBM) transfer running
+	UART_TX_COMPLETE, // TC/TE seen, chunk waiting to be retired by bottom half
+	UART_TX_WAIT_DISABLE // disable requested, bottom half resumes on the stream's TC (no spin)
+
+} UART_TxState_t;
+
 typedef struct {
 
 	USART_TypeDef* Instance; // which USART
+	DMA_TypeDef* DMA; // DMA controller serving its TX request
 	uint32_t DMA_Stream; // DMA stream index-pointer (for LL functions)
+	volatile uint32_t* dma_isr; // LISR / HISR holding the stream's flags
+	volatile uint32_t* dma_ifcr; // LIFCR / HIFCR clearing them
+	uint32_t dma_shift; // position of the stream's flag group in those registers
+	DEFER_Work_t defer_work; // TX bottom-half work item
+	bool apb2; // USART clocked from APB2 (else APB1)
+	uint32_t baudrate; // line rate
 	CircBuf* circ_buffer; // pointer to circ buffer struct
 	uint8_t* tx_buffer; // pointer to active buffer
 	uint32_t tx_length; // number of bytes remaining
-	volatile bool tx_busy; // is DMA busy?
+	volatile UART_TxState_t tx_state; // TX engine state
+	uint32_t tx_errors; // DMA transfer errors (chunk dropped)
+	uint32_t tx_wait_start; // cycle count when a wait for EN=0 began
+	PERF_Stat_t tx_wait; // waits for stream disable: count + max cycles
+	uint32_t tx_tc_cycles; // cycle count of the last TC (gap measurement)
+	PERF_Stat_t tx_gap; // normal mode: TC -> next stream enable (line idle)
+	bool continuous; // allow DBM streaming when backlog >= 2 chunks
+	uint8_t dbm_buf[2][UART_DBM_CHUNK] __attribute__((aligned(16))); // M0AR / M1AR buffers (16-byte bursts)
+	volatile uint8_t dbm_fresh[2]; // buffer refilled since it was last sent
+	volatile uint8_t dbm_idle; // buffer that just drained, awaiting refill
+	volatile uint8_t dbm_stopping; // stopped at HT, rest of the current buffer still to send
+	uint32_t dbm_stops; // streaming stopped because the producer ran dry
+	PERF_Stat_t dbm_refill; // continuous mode: TC -> idle buffer refilled
+	uint32_t tx_word_xfers; // transfers started with word-sized memory reads
+	uint32_t tx_byte_xfers; // transfers started with byte-sized memory reads
 
 } UART_Handle_t;
 
 // global UART_Handle_t struct
 extern UART_Handle_t uart;
 
+#ifdef UART_AUX_ENABLE
+// second port (UART_AUX_PORT) and its buffer
+extern UART_Handle_t uart_aux;
+extern CircBuf auxbuf;
+#endif
+
 /**
   * @brief  Initialize uart_init module
+  * @note   Sets up the TX pin, USART (8N1) and DMA stream of the port
   * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  port USART to drive
+  * @param  baudrate Line rate
   * @param  *circ_buf Pointer to CircBuf instance
   * @retval Void
 **/
-void uart_init(UART_Handle_t* uart, CircBuf* circ_buf);
+void uart_init(UART_Handle_t* uart, UART_Port_t port, uint32_t baudrate, CircBuf* circ_buf);
+
+/**
+  * @brief  DMA stream interrupt of a port
+  * @param  port USART
+  * @retval IRQ number from the port table
+**/
+IRQn_Type uart_port_irq(UART_Port_t port);
+
+/**
+  * @brief  Recompute BRR for a new bus clock
+  * @note   TX must be idle (no frame on the line)
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  pclk_hz APB2 clock if 'uart->apb2', APB1 clock otherwise, in Hz
+  * @retval Void
+**/
+void uart_set_clock(UART_Handle_t* uart, uint32_t pclk_hz);
 
 /**
   * @brief  Send largest contiguous chunk of data from circular buffer over DMA
+  * @note   Only starts a transfer from UART_TX_IDLE; never waits
   * @param  *uart Pointer to the UART_Handle_t instance
   * @retval Void
 **/
 void uart_send_dma(UART_Handle_t* uart);
 
 /**
-  * @brief  reset flags after DMA tranfer complete, recur if more data in buffer
+  * @brief  Enable / disable continuous (double-buffer) streaming
   * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  enable true to allow DBM streaming
   * @retval Void
 **/
-void uart_handle_dma_irq(UART_Handle_t* uart);
+void uart_set_continuous(UART_Handle_t* uart, bool enable);
+
+/**
+  * @brief  Acknowledge DMA flags, defer buffer advance / re-arm to PendSV
+  * @note   A stream stopped by software raises TC once EN reads 0; that
+  *         interrupt drives UART_TX_WAIT_DISABLE on
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @retval Void
+**/
+RAMFUNC void uart_handle_dma_irq(UART_Handle_t* uart);
+
+/**
+  * @brief  Bottom half: retire completed chunk, start next chunk if any
+  * @note   Called from PendSV via the defer module
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @retval Void
+**/
+void uart_service_tx(UART_Handle_t* uart);
 
 /**
   * @brief  Print sring to console using polling
@@ -67,13 +166,35 @@ void uart_handle_dma_irq(UART_Handle_t* uart);
 **/
 void uart_DMA_printf(UART_Handle_t* uart, char* str);
 
+/**
+  * @brief  Queue raw bytes (binary frames) using circular buffer and DMA
+  * @note   Same path as 'uart_DMA_printf', but NUL bytes are sent too
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  *data Pointer to first byte
+  * @param  len Number of bytes
+  * @retval Void
+**/
+void uart_DMA_write(UART_Handle_t* uart, const uint8_t* data, uint16_t len);
+
 /**
   * @brief  Print string to console using circular buffer and DMA
-  * @note   This function uses the 'uart_send_dma' function
+  * @note   DMA is (re)started from PendSV via 'uart_service_tx'
   * @param  *uart Pointer to the UART_Handle_t instance
   * @param  *str  Pointer to first char in string
   * @retval Void
 **/
 void uart_printf(UART_Handle_t* uart, char* str);
 
+/**
+  * @brief  Format a non-negative value with a fixed number of decimals
+  * @note   Report lines without the float printf support of newlib-nano
+  * @param  *buf Output buffer
+  * @param  size Buffer size
+  * @param  v Value
+  * @param  scale 10^decimals
+  * @param  decimals Number of decimals
+  * @retval Void
+**/
+void uart_format_fixed(char* buf, size_t size, float v, uint32_t scale, uint32_t decimals);
+
 #endif
@@ -0,0 +1,91 @@
+/**
+ * weighting.h
+ * ------------
+ * A / C frequency weighting (IEC 61672-1) ahead of the level detectors.
+ *
+ * The envelope filter and the RMS meter see the weighted block, so the
+ * bar and telemetry read dB(A) / dB(C) style levels; spectral modules
+ * (fft, goertzel, octave) keep the raw samples.
+ *
+ * Filters are float DF2T biquad cascades with coefficients generated
+ * by tools/gen_tables.py for the ADC sample rate (DSP_WEIGHT_FS_HZ),
+ * 0 dB at 1 kHz. The build fails if TIM2_RATE_HZ no longer matches.
+ **/
+
+#ifndef WEIGHTING_H
+#define WEIGHTING_H
+
+#include <stdint.h>
+#include "ramfunc.h"
+#include "dsp_tables.h"
+
+#define WEIGHT_SECTIONS_MAX DSP_WEIGHT_A_SECTIONS // largest cascade
+
+typedef enum {
+
+	WEIGHT_Z = 0, // flat (no weighting), the raw block is passed through
+	WEIGHT_A, // A-weighting
+	WEIGHT_C // C-weighting
+
+} WEIGHT_Mode_t;
+
+// weighting at boot, override with -DWEIGHT_DEFAULT=WEIGHT_A
+#ifndef WEIGHT_DEFAULT
+#define WEIGHT_DEFAULT WEIGHT_Z
+#endif
+
+typedef struct {
+
+	float s1; // DF2T state
+	float s2;
+
+} WEIGHT_State_t;
+
+typedef struct {
+
+	WEIGHT_Mode_t mode; // active weighting
+	const float* coef; // {b0, b1, b2, a1, a2} per section
+	uint8_t sections; // biquads in use
+	WEIGHT_State_t state[WEIGHT_SECTIONS_MAX]; // filter state
+
+} WEIGHT_Handle_t;
+
+// global WEIGHT_Handle_t instance
+extern WEIGHT_Handle_t weight;
+
+/**
+  * @brief  Initialize the weighting filter
+  * @param  *w Pointer to the WEIGHT_Handle_t instance
+  * @param  mode Z (flat), A or C
+  * @retval Void
+**/
+void weighting_init(WEIGHT_Handle_t* w, WEIGHT_Mode_t mode);
+
+/**
+  * @brief  Select the weighting, clears the filter state
+  * @param  *w Pointer to the WEIGHT_Handle_t instance
+  * @param  mode Z (flat), A or C
+  * @retval Void
+**/
+void weighting_set_mode(WEIGHT_Handle_t* w, WEIGHT_Mode_t mode);
+
+/**
+  * @brief  Weight a block of raw ADC samples
+  * @note   Called from the ADC bottom half. Output keeps the raw format
+  *         (12-bit, mid-rail biased, clamped) so the detectors are unchanged
+  * @param  *w Pointer to the WEIGHT_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  *out Output buffer, 'len' samples
+  * @param  len Number of samples
+  * @retval 'blk' when flat, otherwise 'out'
+**/
+RAMFUNC const uint16_t* weighting_process_block(WEIGHT_Handle_t* w, const uint16_t* blk, uint16_t* out, uint32_t len);
+
+/**
+  * @brief  Weighting letter for reports
+  * @param  *w Pointer to the WEIGHT_Handle_t instance
+  * @retval 'Z', 'A' or 'C'
+**/
+char weighting_letter(WEIGHT_Handle_t* w);
+
+#endif
@@ -6,8 +6,24 @@
  * Handles ADC initialization, software-triggered conversions,
  * and ISR-based sample acquisition.
  *
- * Raw samples are processed through an
- * envelope filter before being stored.
+ * The ISR (top half) only stores raw samples into ping-pong
+ * blocks. Each completed block is handed to a PendSV bottom half
+ * that runs the envelope filter and updates the stored sample.
+ *
+ * In ADC_MODE_OVERSAMPLE the samples arrive by DMA instead and every
+ * completed DMA half goes to the oversample module.
+ *
+ * Injected housekeeping results (Vrefint, temperature, VBAT) also
+ * arrive on the ADC vector and are handed to the housekeeping module.
+ *
+ * The interrupt mode runs the acquisition profile from 'adc_profile',
+ * the oversampling mode its own fixed setting.
+ *
+ * Overruns are counted by the ADC ISR; in DMA mode the stream is
+ * restarted from the bottom half.
+ *
+ * The analog watchdog shares the ADC vector; the ISR only reports the
+ * hit to the capture module and disables the watchdog interrupt.
  **/
 
 
@@ -20,12 +36,53 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "stm32f4xx_ll_adc.h"
+#include "stm32f4xx_ll_dma.h"
+#include "stm32f4xx_ll_bus.h"
 #include "stm32f4xx.h"
 #include "circbuf.h"
+#include "perf.h"
+#include "defer.h"
+#include "clock.h"
+#include "rms.h"
+#include "fft.h"
+#include "goertzel.h"
+#include "octave.h"
+#include "weighting.h"
+#include "decim.h"
+#include "oversample.h"
+#include "timer.h"
+#include "dc_track.h"
+#include "capture.h"
+#include "housekeeping.h"
+
+typedef struct {
+
+	const char* name; // short name for reports
+	uint32_t clock_max_hz; // ADCCLK limit, selects the ADCPRE divider
+	uint32_t sampling; // LL_ADC_SAMPLINGTIME_xCYCLES
+	uint16_t sampling_cycles; // same, in ADC clock cycles
+	uint8_t resolution; // bits per conversion
+
+} ADC_ProfileConfig_t;
+
+// acquisition profile table, indexed by ADC_Profile_t
+static const ADC_ProfileConfig_t adc_profile[ADC_PROFILE_COUNT] = {
+
+	[ADC_PROFILE_FAST] = { "fast", ADC_CLOCK_MAX_HZ, LL_ADC_SAMPLINGTIME_3CYCLES, 3, 12 },
+	[ADC_PROFILE_FAST8] = { "fast8", ADC_CLOCK_MAX_HZ, LL_ADC_SAMPLINGTIME_3CYCLES, 3, 8 },
+	[ADC_PROFILE_MEDIUM] = { "medium", ADC_CLOCK_MAX_HZ, LL_ADC_SAMPLINGTIME_28CYCLES, 28, 12 },
+	[ADC_PROFILE_HIGHZ] = { "highz", ADC_CLOCK_MAX_HZ, LL_ADC_SAMPLINGTIME_144CYCLES, 144, 12 },
+	[ADC_PROFILE_PRECISE] = { "precise", 18000000U, LL_ADC_SAMPLINGTIME_480CYCLES, 480, 12 },
+};
 
 // initialize global ADC_Handle_t instance
 ADC_Handle_t adc;
 
+// defer module adapter for the block bottom half
+static void adc_block_bottom_half(void* ctx) {
+	adc_process_block((ADC_Handle_t*)ctx);
+}
+
 /**
   * @brief  Initialize adc module
   * @param  *adc Pointer to the ADC_Handle_t instance
@@ -39,6 +96,41 @@ void adc_init(ADC_Handle_t* adc, CircBuf* circ_buf) {
 	adc->Instance = ADC1;
 	adc->sample = 0;
 	adc->circ_buffer = circ_buf;
+	adc->trigger_cycles = 0;
+	adc->fill_index = 0;
+	adc->blocks_produced = 0;
+	adc->blocks_consumed = 0;
+	adc->blocks_dropped = 0;
+	adc->mode = ADC_MODE_NORMAL;
+	adc->requested = ADC_MODE_NORMAL;
+	adc->profile = ADC_PROFILE_DEFAULT;
+	adc->requested_profile = ADC_PROFILE_DEFAULT;
+	adc->adcclk_hz = 0;
+	adc->conv_cycles = 0;
+	adc->resolution = 12;
+	adc->requested_resolution = 12;
+	adc->res_shift = 0;
+	adc->dma_errors = 0;
+	adc->samples = 0;
+	adc->overruns = 0;
+	adc->resync = 0;
+	adc->resync_start = 0;
+	perf_reset(&adc->resync_wait);
+	adc->block_stamp[0] = 0;
+	adc->block_stamp[1] = 0;
+	adc->stamp = 0;
+
+	// DMA2 Stream0 is only armed by 'adc_set_mode' (oversampling)
+	LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA2);
+	NVIC_EnableIRQ(DMA2_Stream0_IRQn);
+
+	// register block bottom half
+	defer_register(&defer, DEFER_ADC_BLOCK, adc_block_bottom_half, adc);
+
+	// ADC clock divider, sampling time and resolution of the boot profile
+	if (!adc_set_profile(adc, ADC_PROFILE_DEFAULT)) {
+		adc_set_profile(adc, ADC_PROFILE_FAST);
+	}
 
 	// clear potential flags + flush DR
 		LL_ADC_ClearFlag_EOCS(adc->Instance);
@@ -50,6 +142,341 @@ void adc_init(ADC_Handle_t* adc, CircBuf* circ_buf) {
 
 	// enable flags
 	LL_ADC_EnableIT_EOCS(adc->Instance);
+	LL_ADC_EnableIT_OVR(adc->Instance);
+}
+
+/**
+  * @brief  Smallest ADC prescaler that keeps ADCCLK at or below a limit
+  * @param  pclk_hz APB2 clock in Hz
+  * @param  max_hz ADCCLK limit in Hz
+  * @retval Divider index: 0 .. 3 for divide by 2, 4, 6, 8 (fallback: 8)
+**/
+static uint32_t adc_prescaler_index(uint32_t pclk_hz, uint32_t max_hz) {
+
+	uint32_t i = 0;
+	while (i < 3 && pclk_hz / (2U * (i + 1U)) > max_hz) {
+		i++;
+	}
+	return i;
+}
+
+/**
+  * @brief  Select the smallest ADC prescaler that keeps ADCCLK in spec
+  * @note   The limit is the active profile's in ADC_MODE_NORMAL, ADC_CLOCK_MAX_HZ otherwise
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  pclk_hz APB2 clock in Hz
+  * @retval Void
+**/
+void adc_set_clock(ADC_Handle_t* adc, uint32_t pclk_hz) {
+
+	static const uint32_t prescaler[4] = {
+		LL_ADC_CLOCK_SYNC_PCLK_DIV2, LL_ADC_CLOCK_SYNC_PCLK_DIV4,
+		LL_ADC_CLOCK_SYNC_PCLK_DIV6, LL_ADC_CLOCK_SYNC_PCLK_DIV8
+	};
+
+	uint32_t max_hz = (adc->mode == ADC_MODE_NORMAL) ? adc_profile[adc->profile].clock_max_hz : ADC_CLOCK_MAX_HZ;
+	uint32_t i = adc_prescaler_index(pclk_hz, max_hz);
+	adc->adcclk_hz = pclk_hz / (2U * (i + 1U));
+
+	// ADCPRE must not change while the ADC is on
+	bool enabled = LL_ADC_IsEnabled(adc->Instance);
+	LL_ADC_Disable(adc->Instance);
+	LL_ADC_SetCommonClock(__LL_ADC_COMMON_INSTANCE(adc->Instance), prescaler[i]);
+	if (enabled) {
+		LL_ADC_Enable(adc->Instance);
+	}
+}
+
+/**
+  * @brief  Select an acquisition profile (ADCCLK limit, sampling time, resolution)
+  * @note   Thread mode only; one sample may be lost, an active capture restarts
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  profile Profile to run in ADC_MODE_NORMAL
+  * @retval true on success, false for an unknown profile
+**/
+bool adc_set_profile(ADC_Handle_t* adc, ADC_Profile_t profile) {
+
+	if ((uint32_t)profile >= ADC_PROFILE_COUNT) {
+		adc->requested_profile = adc->profile;
+		return false;
+	}
+
+	const ADC_ProfileConfig_t* cfg = &adc_profile[profile];
+	adc->profile = profile;
+	adc->requested_profile = profile;
+
+	// the oversampling mode keeps its own setting, 'adc_set_mode' applies this one on return
+	bool enabled = LL_ADC_IsEnabled(adc->Instance);
+	if (adc->mode == ADC_MODE_NORMAL) {
+		LL_ADC_Disable(adc->Instance);
+		adc_set_clock(adc, sysclk.pclk2_hz);
+		LL_ADC_SetChannelSamplingTime(adc->Instance, ADC_CHANNEL, cfg->sampling);
+	}
+
+	// resolution last: it also restarts an active capture
+	adc_set_resolution(adc, cfg->resolution);
+
+	if (enabled) {
+		LL_ADC_Enable(adc->Instance);
+	}
+	return true;
+}
+
+/**
+  * @brief  Short name of an acquisition profile
+  * @param  profile Profile
+  * @retval Name, "?" for an unknown profile
+**/
+const char* adc_profile_name(ADC_Profile_t profile) {
+
+	return ((uint32_t)profile < ADC_PROFILE_COUNT) ? adc_profile[profile].name : "?";
+}
+
+/**
+  * @brief  Conversion rate limit of a profile (back-to-back conversions)
+  * @param  profile Profile
+  * @param  pclk_hz APB2 clock in Hz
+  * @retval Conversions per second, 0 for an unknown profile
+**/
+uint32_t adc_profile_rate(ADC_Profile_t profile, uint32_t pclk_hz) {
+
+	if ((uint32_t)profile >= ADC_PROFILE_COUNT) {
+		return 0;
+	}
+
+	// sampling + one ADC clock per bit (RM0390 13.5: 3 + 12 = 15 at 12 bits)
+	const ADC_ProfileConfig_t* cfg = &adc_profile[profile];
+	uint32_t i = adc_prescaler_index(pclk_hz, cfg->clock_max_hz);
+	return (pclk_hz / (2U * (i + 1U))) / ((uint32_t)cfg->sampling_cycles + cfg->resolution);
+}
+
+/**
+  * @brief  Duration of a number of ADC clock cycles at the current ADCCLK
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  cycles ADC clock cycles
+  * @retval Duration in ns
+**/
+uint32_t adc_cycles_ns(const ADC_Handle_t* adc, uint32_t cycles) {
+
+	if (adc->adcclk_hz == 0) {
+		return 0;
+	}
+	return (uint32_t)(((uint64_t)cycles * 1000000000U) / adc->adcclk_hz);
+}
+
+/**
+  * @brief  LL resolution setting for a bit count
+  * @param  bits 12, 10, 8 or 6
+  * @retval LL_ADC_RESOLUTION_xB value, 0xFFFFFFFF if unsupported
+**/
+static uint32_t adc_resolution_code(uint8_t bits) {
+
+	switch (bits) {
+	case 12: return LL_ADC_RESOLUTION_12B;
+	case 10: return LL_ADC_RESOLUTION_10B;
+	case 8: return LL_ADC_RESOLUTION_8B;
+	case 6: return LL_ADC_RESOLUTION_6B;
+	default: return 0xFFFFFFFFU;
+	}
+}
+
+/**
+  * @brief  Select the conversion resolution of the interrupt mode
+  * @note   Thread mode only; one sample may be lost, an active capture restarts
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  bits 12, 10, 8 or 6
+  * @retval true on success, false for an unsupported resolution
+**/
+bool adc_set_resolution(ADC_Handle_t* adc, uint8_t bits) {
+
+	uint32_t code = adc_resolution_code(bits);
+	if (code == 0xFFFFFFFFU) {
+		adc->requested_resolution = adc->resolution;
+		return false;
+	}
+
+	adc->resolution = bits;
+	adc->requested_resolution = bits;
+	adc->conv_cycles = (uint16_t)(adc_profile[adc->profile].sampling_cycles + bits);
+
+	// the oversampling mode keeps 12 bits, 'adc_set_mode' applies it on return
+	if (adc->mode == ADC_MODE_NORMAL) {
+
+		// RES and the scale shift change together while no conversion can run
+		bool enabled = LL_ADC_IsEnabled(adc->Instance);
+		LL_ADC_Disable(adc->Instance);
+		LL_ADC_SetResolution(adc->Instance, code);
+		adc->res_shift = (uint8_t)(12U - bits);
+		if (enabled) {
+			LL_ADC_Enable(adc->Instance);
+		}
+
+		// the ring holds samples of the old step size: restart an active capture
+		capture_set_trigger(&capture, capture.trigger);
+	}
+	return true;
+}
+
+/**
+  * @brief  Arm DMA2 Stream0: ADC1 DR -> both halves of ovs.dma, circular
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @retval Void
+**/
+static void adc_dma_start(ADC_Handle_t* adc) {
+
+	LL_DMA_SetChannelSelection(DMA2, ADC_DMA_STREAM, ADC_DMA_CHANNEL);
+	LL_DMA_SetDataTransferDirection(DMA2, ADC_DMA_STREAM, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+	LL_DMA_SetStreamPriorityLevel(DMA2, ADC_DMA_STREAM, LL_DMA_PRIORITY_HIGH);
+	LL_DMA_SetMode(DMA2, ADC_DMA_STREAM, LL_DMA_MODE_CIRCULAR);
+	LL_DMA_SetPeriphIncMode(DMA2, ADC_DMA_STREAM, LL_DMA_PERIPH_NOINCREMENT);
+	LL_DMA_SetMemoryIncMode(DMA2, ADC_DMA_STREAM, LL_DMA_MEMORY_INCREMENT);
+	LL_DMA_SetPeriphSize(DMA2, ADC_DMA_STREAM, LL_DMA_PDATAALIGN_HALFWORD);
+
+	// FIFO packs half-words into word bursts (half size is a multiple of 8 samples)
+	LL_DMA_EnableFifoMode(DMA2, ADC_DMA_STREAM);
+	LL_DMA_SetFIFOThreshold(DMA2, ADC_DMA_STREAM, ADC_DMA_FIFO_THRESHOLD);
+	LL_DMA_SetMemorySize(DMA2, ADC_DMA_STREAM, ADC_DMA_MEMORY_SIZE);
+	LL_DMA_SetMemoryBurstxfer(DMA2, ADC_DMA_STREAM, ADC_DMA_MBURST);
+
+	LL_DMA_SetPeriphAddress(DMA2, ADC_DMA_STREAM, LL_ADC_DMA_GetRegAddr(adc->Instance, LL_ADC_DMA_REG_REGULAR_DATA));
+	LL_DMA_SetMemoryAddress(DMA2, ADC_DMA_STREAM, (uint32_t)ovs.dma);
+	LL_DMA_SetDataLength(DMA2, ADC_DMA_STREAM, 2U * OVS_DMA_HALF);
+
+	LL_DMA_EnableIT_HT(DMA2, ADC_DMA_STREAM);
+	LL_DMA_EnableIT_TC(DMA2, ADC_DMA_STREAM);
+	LL_DMA_EnableIT_TE(DMA2, ADC_DMA_STREAM);
+	LL_DMA_EnableStream(DMA2, ADC_DMA_STREAM);
+}
+
+/**
+  * @brief  DMA mode overrun recovery: re-arm the stream, then clear OVR
+  * @note   Called from the ADC bottom half once the stream reads disabled
+  *         (posted by the TC that follows the disable in the ISR)
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @retval Void
+**/
+static void adc_dma_resync(ADC_Handle_t* adc) {
+
+	perf_record(&adc->resync_wait, PERF_CYCLES() - adc->resync_start);
+	LL_DMA_ClearFlag_HT0(DMA2);
+	LL_DMA_ClearFlag_TC0(DMA2);
+	LL_DMA_ClearFlag_TE0(DMA2);
+	LL_DMA_ClearFlag_FE0(DMA2);
+	LL_DMA_ClearFlag_DME0(DMA2);
+
+	// the gap breaks the filter history: drop partial halves, restart the chain
+	adc->blocks_consumed = adc->blocks_produced;
+	oversample_reset(&ovs);
+
+	// DMA bit toggled so the ADC issues requests again; clearing OVR resumes on the next trigger
+	LL_ADC_REG_SetDMATransfer(adc->Instance, LL_ADC_REG_DMA_TRANSFER_NONE);
+	adc_dma_start(adc);
+	LL_ADC_REG_SetDMATransfer(adc->Instance, LL_ADC_REG_DMA_TRANSFER_UNLIMITED);
+	adc->resync = 0;
+	LL_ADC_ClearFlag_OVR(adc->Instance);
+	LL_ADC_EnableIT_OVR(adc->Instance);
+}
+
+/**
+  * @brief  Switch acquisition mode
+  * @note   Thread mode only; restarts block accounting for the new mode
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  mode Acquisition mode to run
+  * @retval Void
+**/
+void adc_set_mode(ADC_Handle_t* adc, ADC_Mode_t mode) {
+
+	// stop conversions and the DMA stream before reconfiguring
+	LL_ADC_Disable(adc->Instance);
+	LL_DMA_DisableIT_HT(DMA2, ADC_DMA_STREAM);
+	LL_DMA_DisableIT_TC(DMA2, ADC_DMA_STREAM);
+	LL_DMA_DisableIT_TE(DMA2, ADC_DMA_STREAM);
+	LL_DMA_DisableStream(DMA2, ADC_DMA_STREAM);
+	while (LL_DMA_IsEnabledStream(DMA2, ADC_DMA_STREAM)) {
+	}
+	LL_DMA_ClearFlag_HT0(DMA2);
+	LL_DMA_ClearFlag_TC0(DMA2);
+	LL_DMA_ClearFlag_TE0(DMA2);
+	LL_DMA_ClearFlag_FE0(DMA2);
+	LL_DMA_ClearFlag_DME0(DMA2);
+	LL_ADC_ClearFlag_EOCS(adc->Instance);
+	LL_ADC_ClearFlag_OVR(adc->Instance);
+
+	// an armed housekeeping conversion is dropped (it times out in 'housekeeping_poll')
+	LL_ADC_INJ_StopConversionExtTrig(adc->Instance);
+
+	// ADCCLK limit of the new mode (the ADC stays off)
+	adc->mode = mode;
+	adc_set_clock(adc, sysclk.pclk2_hz);
+
+	// nothing is pending any more (PendSV pre-empts thread mode)
+	adc->fill_index = 0;
+	adc->blocks_consumed = adc->blocks_produced;
+	adc->resync = 0;
+
+	if (mode == ADC_MODE_OVERSAMPLE) {
+
+		// TIM2 TRGO -> conversion -> DMA request, no per-sample interrupt
+		oversample_reset(&ovs);
+		LL_ADC_DisableIT_EOCS(adc->Instance);
+		LL_ADC_SetResolution(adc->Instance, LL_ADC_RESOLUTION_12B);
+		adc->res_shift = 0;
+		LL_ADC_SetChannelSamplingTime(adc->Instance, ADC_CHANNEL, ADC_OVS_SAMPLINGTIME);
+		LL_ADC_REG_SetTriggerSource(adc->Instance, LL_ADC_REG_TRIG_EXT_TIM2_TRGO);
+		LL_ADC_REG_SetDMATransfer(adc->Instance, LL_ADC_REG_DMA_TRANSFER_UNLIMITED);
+		adc_dma_start(adc);
+		LL_ADC_Enable(adc->Instance);
+		LL_ADC_REG_StartConversionExtTrig(adc->Instance, LL_ADC_REG_TRIG_EXT_RISING);
+		timer_set_adc_trigger(&timer, OVS_ADC_RATE_HZ);
+
+	} else {
+
+		// TIM2 ISR -> software start -> EOC interrupt
+		LL_ADC_REG_StopConversionExtTrig(adc->Instance);
+		LL_ADC_REG_SetDMATransfer(adc->Instance, LL_ADC_REG_DMA_TRANSFER_NONE);
+		LL_ADC_REG_SetTriggerSource(adc->Instance, LL_ADC_REG_TRIG_SOFTWARE);
+		LL_ADC_SetResolution(adc->Instance, adc_resolution_code(adc->resolution));
+		adc->res_shift = (uint8_t)(12U - adc->resolution);
+		LL_ADC_SetChannelSamplingTime(adc->Instance, ADC_CHANNEL, adc_profile[adc->profile].sampling);
+		LL_ADC_Enable(adc->Instance);
+		LL_ADC_EnableIT_EOCS(adc->Instance);
+		timer_set_adc_trigger(&timer, 0);
+	}
+
+	adc->requested = mode;
+
+	// the ring holds samples of the old mode: restart an active capture
+	capture_set_trigger(&capture, capture.trigger);
+}
+
+/**
+  * @brief  Arm the analog watchdog on the input channel
+  * @note   The interrupt fires once, then disarms itself
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @param  low Lower threshold, 12-bit counts
+  * @param  high Upper threshold, 12-bit counts
+  * @retval Void
+**/
+void adc_arm_watchdog(ADC_Handle_t* adc, uint16_t low, uint16_t high) {
+
+	LL_ADC_DisableIT_AWD1(adc->Instance);
+	LL_ADC_SetAnalogWDThresholds(adc->Instance, LL_ADC_AWD_THRESHOLD_HIGH, high);
+	LL_ADC_SetAnalogWDThresholds(adc->Instance, LL_ADC_AWD_THRESHOLD_LOW, low);
+	LL_ADC_SetAnalogWDMonitChannels(adc->Instance, ADC_AWD_CHANNEL);
+	LL_ADC_ClearFlag_AWD1(adc->Instance);
+	LL_ADC_EnableIT_AWD1(adc->Instance);
+}
+
+/**
+  * @brief  Disarm the analog watchdog
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @retval Void
+**/
+void adc_disarm_watchdog(ADC_Handle_t* adc) {
+
+	LL_ADC_DisableIT_AWD1(adc->Instance);
+	LL_ADC_SetAnalogWDMonitChannels(adc->Instance, LL_ADC_AWD_DISABLE);
+	LL_ADC_ClearFlag_AWD1(adc->Instance);
 }
 
 /**
@@ -57,38 +484,206 @@ void adc_init(ADC_Handle_t* adc, CircBuf* circ_buf) {
   * @param  *adc Pointer to the ADC_Handle_t instance
   * @retval Void
 **/
-void adc_start_conversion(ADC_Handle_t* adc) {
+RAMFUNC void adc_start_conversion(ADC_Handle_t* adc) {
 
 	// start conversion
 	LL_ADC_REG_StartConversionSWStart(adc->Instance);
 }
 
 /**
-  * @brief  Read, process, and store ADC sample upon IT
+  * @brief  Read ADC sample upon IT, store into current block
+  * @note   Also takes the analog watchdog interrupt (shared ADC vector)
   * @param  *adc Pointer to the ADC_Handle_t instance
   * @retval Void
 **/
-void adc_handle_irq(ADC_Handle_t* adc) {
+RAMFUNC void adc_handle_irq(ADC_Handle_t* adc) {
 
-	// variable for new sample
-	uint16_t raw_data;
-	uint16_t data;
+	uint32_t start = PERF_CYCLES();
 
-	// if End of Conversion flag active, configure and load new sample
+	// if End of Conversion flag active, store new sample
 	if (LL_ADC_IsActiveFlag_EOCS(adc->Instance)) {
 
-		// read sample data (clear flag to be safe)
-		raw_data = LL_ADC_REG_ReadConversionData12(adc->Instance);
+		// read sample data (clear flag to be safe), scaled to 12 bits
+		uint16_t raw_data = (uint16_t)(LL_ADC_REG_ReadConversionData12(adc->Instance) << adc->res_shift);
 		LL_ADC_ClearFlag_EOCS(adc->Instance);
 
-		// apply envelope / smoothing filter for stable visual output
-		data = display_envelope_filter(&disp, raw_data);
+		// store into the block currently being filled
+		adc->block[adc->blocks_produced & 1][adc->fill_index++] = raw_data;
+
+		// record trigger -> captured latency
+		perf_record(&perf.sample_latency, PERF_CYCLES() - adc->trigger_cycles);
+
+		// block full: publish it, switch blocks, defer processing
+		if (adc->fill_index >= ADC_BLOCK_SIZE) {
+			adc->fill_index = 0;
+			adc->block_stamp[adc->blocks_produced & 1] = TIMER_STAMP();
+			adc->samples += ADC_BLOCK_SIZE;
+			adc->blocks_produced++;
+			defer_post(&defer, DEFER_ADC_BLOCK);
+		}
+	}
+
+	// overrun: a conversion finished before DR was read, that sample is lost
+	// (IT disabled while a DMA mode recovery is pending: OVR stays set until then)
+	if (LL_ADC_IsActiveFlag_OVR(adc->Instance) && LL_ADC_IsEnabledIT_OVR(adc->Instance)) {
+		adc->overruns++;
+		if (adc->mode == ADC_MODE_OVERSAMPLE) {
+			// stream first, OVR stays set (no conversions) until the DMA is re-armed;
+			// the TC raised once EN reads 0 posts the bottom half (already off: post now)
+			LL_ADC_DisableIT_OVR(adc->Instance);
+			adc->resync = 1;
+			adc->resync_start = PERF_CYCLES();
+			LL_DMA_DisableStream(DMA2, ADC_DMA_STREAM);
+			if (!LL_DMA_IsEnabledStream(DMA2, ADC_DMA_STREAM)) {
+				defer_post(&defer, DEFER_ADC_BLOCK);
+			}
+		} else {
+			// next software start converts normally
+			LL_ADC_ClearFlag_OVR(adc->Instance);
+		}
+	}
 
-		// set processed sample to adc->sample (update adc->sample)
-		adc->sample = data;
+	// injected housekeeping conversion: one-shot, hand the result to the main loop
+	if (LL_ADC_IsActiveFlag_JEOS(adc->Instance) && LL_ADC_IsEnabledIT_JEOS(adc->Instance)) {
+		LL_ADC_INJ_StopConversionExtTrig(adc->Instance);
+		LL_ADC_ClearFlag_JEOS(adc->Instance);
+		housekeeping_store(&hk, (uint16_t)(LL_ADC_INJ_ReadConversionData12(adc->Instance, LL_ADC_INJ_RANK_1) << adc->res_shift));
 	}
 
+	// analog watchdog: one-shot, the bottom half finds the sample
+	if (LL_ADC_IsActiveFlag_AWD1(adc->Instance) && LL_ADC_IsEnabledIT_AWD1(adc->Instance)) {
+		LL_ADC_DisableIT_AWD1(adc->Instance);
+		LL_ADC_ClearFlag_AWD1(adc->Instance);
+		capture_awd_hit(&capture);
+	}
+
+	perf_record(&perf.adc_isr, PERF_CYCLES() - start);
 }
 
+/**
+  * @brief  DMA half / full transfer: publish the completed half as a block
+  * @note   DMA2 Stream0 interrupt, oversampling mode only
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @retval Void
+**/
+RAMFUNC void adc_handle_dma_irq(ADC_Handle_t* adc) {
+
+	uint32_t start = PERF_CYCLES();
+
+	// transfer error: the stream stops, count it
+	if (LL_DMA_IsActiveFlag_TE0(DMA2)) {
+		LL_DMA_ClearFlag_TE0(DMA2);
+		adc->dma_errors++;
+	}
 
+	// overrun recovery: the stream has stopped (TC after the software disable), no block
+	if (adc->resync) {
+		LL_DMA_ClearFlag_HT0(DMA2);
+		LL_DMA_ClearFlag_TC0(DMA2);
+		defer_post(&defer, DEFER_ADC_BLOCK);
+		perf_record(&perf.adc_isr, PERF_CYCLES() - start);
+		return;
+	}
+
+	// one DMA half is complete (half transfer or transfer complete)
+	if (LL_DMA_IsActiveFlag_HT0(DMA2)) {
+		LL_DMA_ClearFlag_HT0(DMA2);
+		adc->block_stamp[0] = TIMER_STAMP();
+		adc->samples += OVS_DMA_HALF;
+		adc->blocks_produced++;
+		defer_post(&defer, DEFER_ADC_BLOCK);
+	}
+	if (LL_DMA_IsActiveFlag_TC0(DMA2)) {
+		LL_DMA_ClearFlag_TC0(DMA2);
+		adc->block_stamp[1] = TIMER_STAMP();
+		adc->samples += OVS_DMA_HALF;
+		adc->blocks_produced++;
+		defer_post(&defer, DEFER_ADC_BLOCK);
+	}
+
+	perf_record(&perf.adc_isr, PERF_CYCLES() - start);
+}
+
+/**
+  * @brief  Bottom half: filter the latest completed block, update sample
+  * @note   Called from PendSV via the defer module
+  * @param  *adc Pointer to the ADC_Handle_t instance
+  * @retval Void
+**/
+void adc_process_block(ADC_Handle_t* adc) {
 
+	// DMA mode overrun: restart the stream before looking at blocks, once it is
+	// disabled (still enabled: the stream's TC posts this again, never wait here)
+	if (adc->resync) {
+		if (!LL_DMA_IsEnabledStream(DMA2, ADC_DMA_STREAM)) {
+			adc_dma_resync(adc);
+		}
+		return;
+	}
+
+	// single read of the producer count; it also selects the block
+	uint32_t produced = adc->blocks_produced;
+	if (produced == adc->blocks_consumed) {
+		return;
+	}
+
+	// account for blocks that were overwritten before we got to them
+	if (produced - adc->blocks_consumed > 1) {
+		adc->blocks_dropped += produced - adc->blocks_consumed - 1;
+	}
+	adc->blocks_consumed = produced;
+
+	uint32_t start = PERF_CYCLES();
+
+	// oversampling: latest completed DMA half is the one the DMA is not writing
+	if (adc->mode == ADC_MODE_OVERSAMPLE) {
+		uint32_t half = (LL_DMA_GetDataLength(DMA2, ADC_DMA_STREAM) > OVS_DMA_HALF) ? 1 : 0;
+		adc->stamp = adc->block_stamp[half];
+		oversample_process_block(&ovs, ovs.dma[half], OVS_DMA_HALF);
+		perf_record(&perf.adc_block, PERF_CYCLES() - start);
+		return;
+	}
+
+	// latest completed block is the one the ISR is not filling
+	uint16_t* blk = adc->block[(produced - 1) & 1];
+	adc->stamp = adc->block_stamp[(produced - 1) & 1];
+
+	// event capture keeps the raw samples (pre-trigger ring)
+	capture_process_block(&capture, blk, ADC_BLOCK_SIZE);
+
+	// track the amplifier bias, re-centre the block on ADC_MIDRAIL
+	dc_process_block(&dc, blk, ADC_BLOCK_SIZE);
+
+	// A / C weighting ahead of the level detectors (raw block when flat)
+	uint16_t weighted[ADC_BLOCK_SIZE];
+	const uint16_t* lvl = weighting_process_block(&weight, blk, weighted, ADC_BLOCK_SIZE);
+
+	// apply envelope / smoothing filter for stable visual output
+	uint16_t data = adc->sample;
+	for (uint16_t i = 0; i < ADC_BLOCK_SIZE; i++) {
+		data = display_envelope_filter(&disp, lvl[i]);
+	}
+
+	// set processed sample to adc->sample (update adc->sample)
+	adc->sample = data;
+
+	// sliding-window RMS over the same block
+	rms_process_block(&rms, lvl, ADC_BLOCK_SIZE);
+
+	// spectrum analyzer frame (only while it is collecting)
+	fft_collect(&fft, blk, ADC_BLOCK_SIZE);
+
+	// reduced-rate consumers: tone detectors on the decimated block
+	uint16_t reduced[ADC_BLOCK_SIZE]; // len / M + 1 <= len for any M
+	uint32_t n = decim_process_block(&decim, blk, reduced, ADC_BLOCK_SIZE);
+	goertzel_process_block(&goertzel, reduced, n);
+
+	// octave band levels (multirate filter bank), only while frames or the band view use them
+	if (octave.output != OCTAVE_OUTPUT_OFF || disp.view == DISPLAY_VIEW_BANDS) {
+		octave_process_block(&octave, blk, ADC_BLOCK_SIZE);
+	} else {
+		octave_pause(&octave);
+	}
+
+	perf_record(&perf.adc_block, PERF_CYCLES() - start);
+}
@@ -0,0 +1,554 @@
+/**
+ * bench.c
+ * --------
+ * On-target benchmarks for the sampling, DSP and transport paths.
+ *
+ * Only built when BENCH_ENABLE is defined. 'bench_run' is called
+ * once from main before sampling starts; results (in core cycles)
+ * are kept in the global 'bench' instance and printed over UART.
+ *
+ * 'bench_poll' prints a one-off size-versus-speed report (build,
+ * clock, flash / RAM footprint, worst-case cycles per stage) once
+ * sampling has run for BENCH_REPORT_TICKS display ticks.
+ **/
+
+#include "bench.h"
+
+#ifdef BENCH_ENABLE
+
+#include "perf.h"
+#include "uart.h"
+#include "ramfunc.h"
+#include "clock.h"
+#include "rms.h"
+#include "adc.h"
+#include "fft.h"
+#include "octave.h"
+#include "decim.h"
+#include "goertzel.h"
+#include "timer.h"
+#include "oversample.h"
+#include "dc_track.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_ll_bus.h"
+#include "stm32f4xx_ll_dma.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define BENCH_DSP_LEN 1024 // Q15 samples per DSP pass
+#define BENCH_DSP_PASSES 32 // passes per measurement (outlasts the byte-mode copy)
+#define BENCH_DMA_LEN 8192 // bytes moved by DMA during one measurement
+#define BENCH_DMA_STREAM LL_DMA_STREAM_1 // DMA2 stream reserved for memory-to-memory tests
+
+// build label for the report
+#ifdef PERF_BUILD
+#define BENCH_BUILD "performance"
+#else
+#define BENCH_BUILD "default"
+#endif
+
+// section boundaries from the linker script
+extern uint32_t _sidata, _sdata, _edata, _sramfunc, _eramfunc, _ebss;
+
+// initialize global BENCH_Results_t instance
+BENCH_Results_t bench;
+
+// benchmark data, all in SRAM
+static int16_t dsp_x[BENCH_DSP_LEN] __attribute__((aligned(4)));
+static int16_t dsp_y[BENCH_DSP_LEN] __attribute__((aligned(4)));
+static uint32_t dma_src[BENCH_DMA_LEN / 4] __attribute__((aligned(16))); // 16-byte bursts never cross 1 KB
+static uint32_t dma_dst[BENCH_DMA_LEN / 4] __attribute__((aligned(16)));
+static volatile int32_t bench_sink; // keeps the kernel result alive
+static uint32_t bench_ticks; // display ticks seen by bench_poll
+static uint8_t bench_line; // next report line printed by bench_poll
+static RMS_Fixed_t bench_rms_fixed; // RMS engines under test
+static RMS_Float_t bench_rms_float;
+static OCTAVE_Handle_t bench_octave; // band analyzer under test
+static DECIM_Handle_t bench_decim; // decimator under test
+static GOERTZEL_Handle_t bench_goertzel; // tone bank under test
+static DC_Handle_t bench_dc; // DC tracker under test
+static OVS_Handle_t bench_ovs; // oversampling chain under test (its DMA halves hold the input)
+
+/**
+  * @brief  Q15 dot-product kernel (dual 16-bit MAC) over SRAM data
+  * @param  Void
+  * @retval Kernel duration in core cycles
+**/
+static uint32_t bench_dsp_kernel(void) {
+
+	const uint32_t* x = (const uint32_t*)dsp_x;
+	const uint32_t* y = (const uint32_t*)dsp_y;
+	int32_t acc = 0;
+
+	uint32_t start = PERF_CYCLES();
+	for (uint32_t pass = 0; pass < BENCH_DSP_PASSES; pass++) {
+		for (uint32_t i = 0; i < BENCH_DSP_LEN / 2; i++) {
+			acc = (int32_t)__SMLAD(x[i], y[i], (uint32_t)acc);
+		}
+	}
+	uint32_t cycles = PERF_CYCLES() - start;
+
+	bench_sink = acc;
+	return cycles;
+}
+
+/**
+  * @brief  Envelope filter loop shared by the flash and RAM variants
+  * @note   Forced inline so each variant carries its own copy of the code
+  * @param  Void
+  * @retval Final envelope value
+**/
+static inline __attribute__((always_inline)) int32_t bench_filter_body(void) {
+
+	// Q16 attack / release coefficients (~1 ms / ~120 ms at 20 kHz)
+	const uint32_t attack = 3196;
+	const uint32_t release = 27;
+
+	int32_t env = 0;
+	for (uint32_t pass = 0; pass < BENCH_DSP_PASSES; pass++) {
+		for (uint32_t i = 0; i < BENCH_DSP_LEN; i++) {
+			int32_t x = (dsp_x[i] & 0x0FFF) - 2048;
+			if (x < 0) x = -x;
+			int32_t diff = (x << 16) - env;
+			uint32_t coef = (diff > 0) ? attack : release;
+			env += (int32_t)(((int64_t)diff * coef) >> 16);
+		}
+	}
+	return env >> 16;
+}
+
+/**
+  * @brief  Envelope filter loop executed from flash
+  * @param  Void
+  * @retval Loop duration in core cycles
+**/
+static __attribute__((noinline)) uint32_t bench_filter_flash(void) {
+
+	uint32_t start = PERF_CYCLES();
+	bench_sink = bench_filter_body();
+	return PERF_CYCLES() - start;
+}
+
+/**
+  * @brief  Envelope filter loop executed from SRAM
+  * @param  Void
+  * @retval Loop duration in core cycles
+**/
+RAMFUNC static uint32_t bench_filter_ram(void) {
+
+	uint32_t start = PERF_CYCLES();
+	bench_sink = bench_filter_body();
+	return PERF_CYCLES() - start;
+}
+
+/**
+  * @brief  Fixed-point RMS meter over the test data, level per ADC block
+  * @param  Void
+  * @retval Duration in core cycles
+**/
+static uint32_t bench_rms_fixed_run(void) {
+
+	uint32_t level = 0;
+	rms_fixed_init(&bench_rms_fixed, RMS_WINDOW_DEFAULT);
+
+	uint32_t start = PERF_CYCLES();
+	for (uint32_t pass = 0; pass < BENCH_DSP_PASSES; pass++) {
+		for (uint32_t i = 0; i < BENCH_DSP_LEN; i++) {
+			rms_fixed_push(&bench_rms_fixed, (dsp_x[i] & 0x0FFF) - ADC_MIDRAIL);
+			if ((i % ADC_BLOCK_SIZE) == ADC_BLOCK_SIZE - 1) {
+				level += rms_fixed_value(&bench_rms_fixed);
+			}
+		}
+	}
+	uint32_t cycles = PERF_CYCLES() - start;
+
+	bench_sink = (int32_t)level;
+	return cycles;
+}
+
+/**
+  * @brief  FPU RMS meter over the test data, level per ADC block
+  * @param  Void
+  * @retval Duration in core cycles
+**/
+static uint32_t bench_rms_float_run(void) {
+
+	uint32_t level = 0;
+	rms_float_init(&bench_rms_float, RMS_WINDOW_DEFAULT);
+
+	uint32_t start = PERF_CYCLES();
+	for (uint32_t pass = 0; pass < BENCH_DSP_PASSES; pass++) {
+		for (uint32_t i = 0; i < BENCH_DSP_LEN; i++) {
+			rms_float_push(&bench_rms_float, (dsp_x[i] & 0x0FFF) - ADC_MIDRAIL);
+			if ((i % ADC_BLOCK_SIZE) == ADC_BLOCK_SIZE - 1) {
+				level += rms_float_value(&bench_rms_float);
+			}
+		}
+	}
+	uint32_t cycles = PERF_CYCLES() - start;
+
+	bench_sink = (int32_t)level;
+	return cycles;
+}
+
+/**
+  * @brief  One real FFT over the test data
+  * @note   Uses the spectrum analyzer buffers; run before sampling starts
+  * @param  points Transform size
+  * @retval Duration in core cycles
+**/
+static uint32_t bench_fft_run(uint16_t points) {
+
+	for (uint32_t i = 0; i < points; i++) {
+		fft.buf[i] = (int16_t)(((dsp_x[i % BENCH_DSP_LEN] & 0x0FFF) - ADC_MIDRAIL) << 3);
+	}
+
+	uint32_t start = PERF_CYCLES();
+	fft_real_q15(fft.buf, fft.mag, points);
+	uint32_t cycles = PERF_CYCLES() - start;
+
+	bench_sink = (int32_t)fft.mag[1];
+	return cycles;
+}
+
+/**
+  * @brief  Octave analyzer over the test data
+  * @param  mode Octave or 1/3-octave bank
+  * @retval Cycles per input sample
+**/
+static uint32_t bench_octave_run(OCTAVE_Mode_t mode) {
+
+	octave_init(&bench_octave, mode, OCTAVE_WINDOW_DEFAULT);
+
+	uint32_t start = PERF_CYCLES();
+	for (uint32_t pass = 0; pass < BENCH_DSP_PASSES; pass++) {
+		for (uint32_t i = 0; i < BENCH_DSP_LEN; i++) {
+			octave_push(&bench_octave, (float)((dsp_x[i] & 0x0FFF) - ADC_MIDRAIL));
+		}
+	}
+	uint32_t cycles = PERF_CYCLES() - start;
+
+	bench_sink = (int32_t)bench_octave.level[0];
+	return cycles / (BENCH_DSP_PASSES * BENCH_DSP_LEN);
+}
+
+/**
+  * @brief  Copy one ADC block worth of test data in raw 12-bit format
+  * @param  *raw Destination, ADC_BLOCK_SIZE samples
+  * @param  block Block index into dsp_x
+  * @retval Void
+**/
+static void bench_raw_block(uint16_t* raw, uint32_t block) {
+
+	for (uint32_t i = 0; i < ADC_BLOCK_SIZE; i++) {
+		raw[i] = dsp_x[block * ADC_BLOCK_SIZE + i] & 0x0FFF;
+	}
+}
+
+/**
+  * @brief  Decimator throughput, alone and in front of the Goertzel bank
+  * @note   Fills decim_block, goertzel_full and goertzel_decim (per ADC block)
+  * @param  Void
+  * @retval Void
+**/
+static void bench_decim_run(void) {
+
+	const uint32_t blocks = BENCH_DSP_LEN / ADC_BLOCK_SIZE;
+	uint16_t raw[ADC_BLOCK_SIZE];
+	uint16_t reduced[ADC_BLOCK_SIZE];
+	uint32_t t_decim = 0, t_full = 0, t_chain = 0;
+
+	decim_init(&bench_decim, DSP_DECIM_FACTOR, DSP_DECIM_TAPS, dsp_decim_coef);
+	goertzel_init(&bench_goertzel, TIM2_RATE_HZ, GOERTZEL_WINDOW_DEFAULT);
+
+	// decimator alone, and the bank at the full 20 kHz rate
+	for (uint32_t b = 0; b < blocks; b++) {
+		bench_raw_block(raw, b);
+
+		uint32_t start = PERF_CYCLES();
+		decim_process_block(&bench_decim, raw, reduced, ADC_BLOCK_SIZE);
+		t_decim += PERF_CYCLES() - start;
+
+		start = PERF_CYCLES();
+		goertzel_process_block(&bench_goertzel, raw, ADC_BLOCK_SIZE);
+		t_full += PERF_CYCLES() - start;
+	}
+
+	// the bank behind the decimator, as wired in adc_process_block
+	goertzel_init(&bench_goertzel, TIM2_RATE_HZ / DSP_DECIM_FACTOR, GOERTZEL_WINDOW_DEFAULT);
+	for (uint32_t b = 0; b < blocks; b++) {
+		bench_raw_block(raw, b);
+
+		uint32_t start = PERF_CYCLES();
+		uint32_t n = decim_process_block(&bench_decim, raw, reduced, ADC_BLOCK_SIZE);
+		goertzel_process_block(&bench_goertzel, reduced, n);
+		t_chain += PERF_CYCLES() - start;
+	}
+
+	bench.decim_block = t_decim / blocks;
+	bench.goertzel_full = t_full / blocks;
+	bench.goertzel_decim = t_chain / blocks;
+	bench_sink = (int32_t)bench_goertzel.mag[0];
+}
+
+/**
+  * @brief  DC tracker throughput
+  * @param  Void
+  * @retval Cycles per sample
+**/
+static uint32_t bench_dc_run(void) {
+
+	uint16_t raw[ADC_BLOCK_SIZE];
+	const uint32_t blocks = BENCH_DSP_LEN / ADC_BLOCK_SIZE;
+	uint32_t cycles = 0;
+
+	dc_init(&bench_dc, DC_SHIFT_DEFAULT);
+	for (uint32_t pass = 0; pass < BENCH_DSP_PASSES; pass++) {
+		for (uint32_t b = 0; b < blocks; b++) {
+			bench_raw_block(raw, b);
+
+			uint32_t start = PERF_CYCLES();
+			dc_process_block(&bench_dc, raw, ADC_BLOCK_SIZE);
+			cycles += PERF_CYCLES() - start;
+		}
+	}
+
+	bench_sink = (int32_t)bench_dc.offset;
+	return cycles / (BENCH_DSP_PASSES * BENCH_DSP_LEN);
+}
+
+/**
+  * @brief  Oversampling chain throughput (CIC + compensation FIR)
+  * @note   Fills ovs_half; one half must finish well inside 1.6 ms
+  * @param  Void
+  * @retval Void
+**/
+static void bench_ovs_run(void) {
+
+	oversample_init(&bench_ovs, OVS_WINDOW_DEFAULT);
+	for (uint32_t i = 0; i < OVS_DMA_HALF; i++) {
+		bench_ovs.dma[0][i] = dsp_x[i % BENCH_DSP_LEN] & 0x0FFF;
+	}
+
+	uint32_t start = PERF_CYCLES();
+	for (uint32_t p = 0; p < BENCH_DSP_PASSES; p++) {
+		oversample_process_block(&bench_ovs, bench_ovs.dma[0], OVS_DMA_HALF);
+	}
+	bench.ovs_half = (PERF_CYCLES() - start) / BENCH_DSP_PASSES;
+	bench_sink = (int32_t)bench_ovs.code;
+}
+
+/**
+  * @brief  Start a DMA2 memory-to-memory copy of BENCH_DMA_LEN bytes
+  * @param  burst true: word accesses + 4-beat bursts, false: byte accesses
+  * @retval Void
+**/
+static void bench_dma_start(bool burst) {
+
+	LL_DMA_DisableStream(DMA2, BENCH_DMA_STREAM);
+	while (LL_DMA_IsEnabledStream(DMA2, BENCH_DMA_STREAM)) {
+	}
+	LL_DMA_ClearFlag_TC1(DMA2);
+	LL_DMA_ClearFlag_TE1(DMA2);
+	LL_DMA_ClearFlag_FE1(DMA2);
+
+	// memory-to-memory requires FIFO mode; source is the "peripheral" port
+	LL_DMA_SetDataTransferDirection(DMA2, BENCH_DMA_STREAM, LL_DMA_DIRECTION_MEMORY_TO_MEMORY);
+	LL_DMA_SetPeriphAddress(DMA2, BENCH_DMA_STREAM, (uint32_t)dma_src);
+	LL_DMA_SetMemoryAddress(DMA2, BENCH_DMA_STREAM, (uint32_t)dma_dst);
+	LL_DMA_SetPeriphIncMode(DMA2, BENCH_DMA_STREAM, LL_DMA_PERIPH_INCREMENT);
+	LL_DMA_SetMemoryIncMode(DMA2, BENCH_DMA_STREAM, LL_DMA_MEMORY_INCREMENT);
+	LL_DMA_EnableFifoMode(DMA2, BENCH_DMA_STREAM);
+	LL_DMA_SetFIFOThreshold(DMA2, BENCH_DMA_STREAM, LL_DMA_FIFOTHRESHOLD_FULL);
+
+	if (burst) {
+		LL_DMA_SetPeriphSize(DMA2, BENCH_DMA_STREAM, LL_DMA_PDATAALIGN_WORD);
+		LL_DMA_SetMemorySize(DMA2, BENCH_DMA_STREAM, LL_DMA_MDATAALIGN_WORD);
+		LL_DMA_SetPeriphBurstxfer(DMA2, BENCH_DMA_STREAM, LL_DMA_PBURST_INC4);
+		LL_DMA_SetMemoryBurstxfer(DMA2, BENCH_DMA_STREAM, LL_DMA_MBURST_INC4);
+		LL_DMA_SetDataLength(DMA2, BENCH_DMA_STREAM, BENCH_DMA_LEN / 4);
+	} else {
+		LL_DMA_SetPeriphSize(DMA2, BENCH_DMA_STREAM, LL_DMA_PDATAALIGN_BYTE);
+		LL_DMA_SetMemorySize(DMA2, BENCH_DMA_STREAM, LL_DMA_MDATAALIGN_BYTE);
+		LL_DMA_SetPeriphBurstxfer(DMA2, BENCH_DMA_STREAM, LL_DMA_PBURST_SINGLE);
+		LL_DMA_SetMemoryBurstxfer(DMA2, BENCH_DMA_STREAM, LL_DMA_MBURST_SINGLE);
+		LL_DMA_SetDataLength(DMA2, BENCH_DMA_STREAM, BENCH_DMA_LEN);
+	}
+
+	LL_DMA_EnableStream(DMA2, BENCH_DMA_STREAM);
+}
+
+/**
+  * @brief  Wait for the benchmark DMA copy to finish
+  * @param  Void
+  * @retval Void
+**/
+static void bench_dma_wait(void) {
+
+	while (!LL_DMA_IsActiveFlag_TC1(DMA2) && !LL_DMA_IsActiveFlag_TE1(DMA2)) {
+	}
+	LL_DMA_ClearFlag_TC1(DMA2);
+}
+
+/**
+  * @brief  Print one benchmark result line
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  *name Result label
+  * @param  value Result value
+  * @param  *unit Unit label
+  * @retval Void
+**/
+static void bench_print(UART_Handle_t* uart, const char* name, uint32_t value, const char* unit) {
+
+	// the circular buffer overwrites when full: let it drain first
+	while (circbuf_count(uart->circ_buffer) > BENCH_TX_LEVEL) {
+	}
+
+	char line[64];
+	snprintf(line, sizeof(line), "bench %-16s %10lu %s\r\n", name, (unsigned long)value, unit);
+	uart_DMA_printf(uart, line);
+}
+
+/**
+  * @brief  Run all benchmarks and print the results
+  * @note   Blocking; call before timers are started
+  * @param  *uart Pointer to the UART_Handle_t used for the report
+  * @retval Void
+**/
+void bench_run(UART_Handle_t* uart) {
+
+	LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA2);
+
+	// deterministic test data
+	for (uint32_t i = 0; i < BENCH_DSP_LEN; i++) {
+		dsp_x[i] = (int16_t)(i * 37);
+		dsp_y[i] = (int16_t)(i * 11 - 5000);
+	}
+	for (uint32_t i = 0; i < BENCH_DMA_LEN / 4; i++) {
+		dma_src[i] = i;
+	}
+
+	// DSP alone, then with the same data volume moved by DMA in byte vs burst mode
+	bench.dsp_quiet = bench_dsp_kernel();
+
+	bench_dma_start(false);
+	bench.dsp_dma_byte = bench_dsp_kernel();
+	bench_dma_wait();
+
+	bench_dma_start(true);
+	bench.dsp_dma_burst = bench_dsp_kernel();
+	bench_dma_wait();
+
+	bench_print(uart, "dsp_quiet", bench.dsp_quiet, "cyc");
+	bench_print(uart, "dsp_dma_byte", bench.dsp_dma_byte, "cyc");
+	bench_print(uart, "dsp_dma_burst", bench.dsp_dma_burst, "cyc");
+
+	// flash vs SRAM execution of the same loop (equal unless RAMFUNC_DISABLE)
+	bench.filter_flash = bench_filter_flash();
+	bench.filter_ram = bench_filter_ram();
+
+	bench_print(uart, "filter_flash", bench.filter_flash, "cyc");
+	bench_print(uart, "filter_ram", bench.filter_ram, "cyc");
+
+	// RMS meter engines (same data, same window)
+	bench.rms_fixed = bench_rms_fixed_run();
+	bench.rms_float = bench_rms_float_run();
+
+	bench_print(uart, "rms_fixed", bench.rms_fixed, "cyc");
+	bench_print(uart, "rms_float", bench.rms_float, "cyc");
+
+	// cycles per FFT, smallest to largest size
+	for (uint32_t s = 0; s < BENCH_FFT_SIZES; s++) {
+		char name[16];
+		uint16_t points = (uint16_t)(FFT_POINTS_MIN << s);
+		bench.fft[s] = bench_fft_run(points);
+		snprintf(name, sizeof(name), "fft_%u", (unsigned)points);
+		bench_print(uart, name, bench.fft[s], "cyc");
+	}
+
+	// octave analyzer, per input sample
+	// DC tracker ahead of the level chain
+	bench.dc_track = bench_dc_run();
+
+	bench_print(uart, "dc_track", bench.dc_track, "cyc/smp");
+
+	bench.octave_octave = bench_octave_run(OCTAVE_MODE_OCTAVE);
+	bench.octave_third = bench_octave_run(OCTAVE_MODE_THIRD);
+
+	bench_print(uart, "octave_octave", bench.octave_octave, "cyc/smp");
+	bench_print(uart, "octave_third", bench.octave_third, "cyc/smp");
+
+	// decimator, and the Goertzel bank before / after moving behind it
+	bench_decim_run();
+
+	bench_print(uart, "decim_block", bench.decim_block, "cyc/blk");
+	bench_print(uart, "goertzel_full", bench.goertzel_full, "cyc/blk");
+	bench_print(uart, "goertzel_decim", bench.goertzel_decim, "cyc/blk");
+
+	// oversampling mode, per DMA half
+	bench_ovs_run();
+
+	bench_print(uart, "ovs_half", bench.ovs_half, "cyc/blk");
+}
+
+/**
+  * @brief  Print the size / speed report once, after BENCH_REPORT_TICKS calls
+  * @note   Call on every display tick from the main loop; one line per call,
+  *         skipped while the TX backlog is above BENCH_TX_LEVEL (never waits)
+  * @param  *uart Pointer to the UART_Handle_t used for the report
+  * @retval Void
+**/
+void bench_poll(UART_Handle_t* uart) {
+
+	if (bench_ticks < BENCH_REPORT_TICKS) {
+		bench_ticks++;
+		return;
+	}
+	if (bench_line >= BENCH_REPORT_LINES || circbuf_count(uart->circ_buffer) > BENCH_TX_LEVEL) {
+		return;
+	}
+
+	// footprint: flash holds code + load images, RAM holds ramfunc + data + bss
+	uint32_t flash = (uint32_t)&_sidata - FLASH_BASE + ((uint32_t)&_edata - (uint32_t)&_sdata);
+	uint32_t ram = (uint32_t)&_ebss - SRAM1_BASE;
+	uint32_t ramfunc = (uint32_t)&_eramfunc - (uint32_t)&_sramfunc;
+
+	switch (bench_line++) {
+	case 0:
+		uart_DMA_printf(uart, "\r\nbench report build " BENCH_BUILD "\r\n");
+		break;
+	case 1:
+		bench_print(uart, "core_clock", sysclk.hclk_hz / 1000000U, "MHz");
+		break;
+	case 2:
+		bench_print(uart, "flash", flash, "B");
+		break;
+	case 3:
+		bench_print(uart, "ram_static", ram, "B");
+		break;
+	case 4:
+		bench_print(uart, "ram_code", ramfunc, "B");
+		break;
+	// worst case per pipeline stage
+	case 5:
+		bench_print(uart, "sample_latency", perf.sample_latency.max, "cyc");
+		break;
+	case 6:
+		bench_print(uart, "adc_isr", perf.adc_isr.max, "cyc");
+		break;
+	case 7:
+		bench_print(uart, "adc_block", perf.adc_block.max, "cyc");
+		break;
+	case 8:
+		bench_print(uart, "uart_tx_gap", uart->tx_gap.max, "cyc");
+		break;
+	case 9:
+		bench_print(uart, "uart_dbm_refill", uart->dbm_refill.max, "cyc");
+		break;
+	default:
+		break;
+	}
+}
+
+#endif
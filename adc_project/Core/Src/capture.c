@@ -0,0 +1,326 @@
+/**
+ * capture.c
+ * ----------
+ * Event capture with a pre-trigger ring buffer.
+ *
+ * Blocks are block-aligned in the ring while waiting for a trigger,
+ * so the common case is one memcpy per block. Only the watchdog
+ * follow-up, the level compare and the post-trigger part walk the
+ * block sample by sample.
+ *
+ * The bottom half owns every state change except SEND -> HOLDOFF,
+ * which the main loop makes once the last frame is queued; thread
+ * mode only restarts the capture with the bottom half locked out by
+ * the OFF state.
+ **/
+
+#include "capture.h"
+#include "adc.h"
+#include "dc_track.h"
+#include "timer.h"
+#include "uart.h"
+#include "circbuf.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define CAPTURE_MASK (CAPTURE_RING - 1)
+#define CAPTURE_AWD_BLOCKS 2 // blocks scanned for a watchdog hit before re-arming
+
+// initialize global CAPTURE_Handle_t instance
+CAPTURE_Handle_t capture;
+
+/**
+  * @brief  Initialize the capture module (disabled)
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  pre Samples before the trigger
+  * @param  post Samples from the trigger on
+  * @param  holdoff_ms Minimum time between triggers
+  * @retval Void
+**/
+void capture_init(CAPTURE_Handle_t* cap, uint16_t pre, uint16_t post, uint32_t holdoff_ms) {
+
+	// initialize software state
+	cap->trigger = CAPTURE_TRIG_OFF;
+	cap->requested = CAPTURE_TRIG_OFF;
+	cap->state = CAPTURE_STATE_OFF;
+	cap->level = CAPTURE_LEVEL_DEFAULT;
+	cap->seq = 0;
+	cap->captures = 0;
+
+	// fall back to the defaults if the lengths do not fit the ring
+	if (!capture_configure(cap, pre, post, holdoff_ms)) {
+		capture_configure(cap, CAPTURE_PRE_DEFAULT, CAPTURE_POST_DEFAULT, holdoff_ms);
+	}
+}
+
+/**
+  * @brief  Change pre / post lengths and holdoff, restarts an active capture
+  * @note   Thread mode only
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  pre Samples before the trigger
+  * @param  post Samples from the trigger on (at least 1)
+  * @param  holdoff_ms Minimum time between triggers
+  * @retval true on success, false if pre + post exceeds CAPTURE_RING
+**/
+bool capture_configure(CAPTURE_Handle_t* cap, uint16_t pre, uint16_t post, uint32_t holdoff_ms) {
+
+	if (post == 0 || (uint32_t)pre + post > CAPTURE_RING) {
+		return false;
+	}
+
+	CAPTURE_Trigger_t trigger = cap->trigger;
+	capture_set_trigger(cap, CAPTURE_TRIG_OFF);
+
+	cap->pre = pre;
+	cap->post = post;
+	cap->holdoff = (uint32_t)(((uint64_t)holdoff_ms * TIM2_RATE_HZ) / 1000U);
+
+	capture_set_trigger(cap, trigger);
+	return true;
+}
+
+/**
+  * @brief  Select the trigger source and (re-)arm, or stop capturing
+  * @note   Thread mode only; a snapshot still being sent is dropped
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  trigger Trigger source, CAPTURE_TRIG_OFF to stop
+  * @retval Void
+**/
+void capture_set_trigger(CAPTURE_Handle_t* cap, CAPTURE_Trigger_t trigger) {
+
+	// lock out the bottom half first, then reset behind it
+	cap->state = CAPTURE_STATE_OFF;
+	adc_disarm_watchdog(&adc);
+
+	cap->head = 0;
+	cap->filled = 0;
+	cap->since = 0;
+	cap->awd_hit = 0;
+	cap->awd_blocks = 0;
+	cap->sent = 0;
+	cap->announced = false;
+	cap->bits = adc.resolution;
+	cap->trigger = trigger;
+	cap->requested = trigger;
+
+	if (trigger != CAPTURE_TRIG_OFF) {
+		cap->state = CAPTURE_STATE_PREFILL;
+	}
+}
+
+/**
+  * @brief  Set the trigger window around the tracked offset and wait for it
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @retval Void
+**/
+static void capture_arm(CAPTURE_Handle_t* cap) {
+
+	int32_t offset = dc.offset;
+	int32_t high = offset + cap->level;
+	int32_t low = offset - cap->level;
+	cap->high = (uint16_t)((high > 4095) ? 4095 : high);
+	cap->low = (uint16_t)((low < 0) ? 0 : low);
+
+	cap->awd_hit = 0;
+	cap->awd_blocks = 0;
+	cap->state = CAPTURE_STATE_ARMED;
+
+	if (cap->trigger == CAPTURE_TRIG_AWD) {
+		adc_arm_watchdog(&adc, cap->low, cap->high);
+	}
+}
+
+/**
+  * @brief  Feed a block of raw ADC samples
+  * @note   Called from the ADC bottom half, before the DC tracker
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void capture_process_block(CAPTURE_Handle_t* cap, const uint16_t* blk, uint32_t len) {
+
+	CAPTURE_State_t state = cap->state;
+
+	if (state == CAPTURE_STATE_OFF) {
+		return;
+	}
+
+	// snapshot out or waiting: only count time since the trigger
+	if (state == CAPTURE_STATE_SEND || state == CAPTURE_STATE_HOLDOFF) {
+		cap->since += len;
+		if (state == CAPTURE_STATE_SEND || cap->since < cap->holdoff) {
+			return;
+		}
+
+		// holdoff over: refill the pre-trigger part from the ring start
+		cap->head = 0;
+		cap->filled = 0;
+		state = CAPTURE_STATE_PREFILL;
+		cap->state = state;
+	}
+
+	// fast path: the block lands block-aligned in the ring (never wraps)
+	if (state == CAPTURE_STATE_PREFILL
+			|| (state == CAPTURE_STATE_ARMED && cap->trigger == CAPTURE_TRIG_AWD && !cap->awd_hit)) {
+		memcpy(&cap->ring[cap->head], blk, len * sizeof(uint16_t));
+		cap->head = (cap->head + len) & CAPTURE_MASK;
+		cap->filled += len;
+		if (state == CAPTURE_STATE_PREFILL && cap->filled >= cap->pre) {
+			capture_arm(cap);
+		}
+		return;
+	}
+
+	uint32_t head = cap->head;
+	uint32_t low = cap->low;
+	uint32_t high = cap->high;
+
+	// still collecting 'post': the holdoff runs from the trigger, count this block too
+	if (state == CAPTURE_STATE_POST) {
+		cap->since += len;
+	}
+
+	for (uint32_t i = 0; i < len; i++) {
+		uint32_t x = blk[i];
+
+		if (state == CAPTURE_STATE_ARMED) {
+			if (x <= high && x >= low) {
+				cap->ring[head] = (uint16_t)x;
+				head = (head + 1) & CAPTURE_MASK;
+				continue;
+			}
+
+			// trigger: this sample is the first of 'post'
+			cap->start = (uint16_t)((head - cap->pre) & CAPTURE_MASK);
+			cap->remaining = cap->post;
+			cap->since = len - i;
+			cap->stamp = adc.stamp - (len - 1 - i) * TIMER_STAMP_PER_SAMPLE;
+			adc_disarm_watchdog(&adc);
+			state = CAPTURE_STATE_POST;
+		}
+
+		cap->ring[head] = (uint16_t)x;
+		head = (head + 1) & CAPTURE_MASK;
+
+		// snapshot complete: freeze the ring
+		if (--cap->remaining == 0) {
+			state = CAPTURE_STATE_SEND;
+			break;
+		}
+	}
+
+	cap->head = (uint16_t)head;
+	cap->filled += len;
+
+	// watchdog fired but no sample left the window: give up, re-arm
+	if (state == CAPTURE_STATE_ARMED && cap->awd_hit && ++cap->awd_blocks >= CAPTURE_AWD_BLOCKS) {
+		capture_arm(cap);
+	}
+
+	cap->state = state;
+}
+
+/**
+  * @brief  Send the next snapshot frame
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+static void capture_send_frame(CAPTURE_Handle_t* cap, UART_Handle_t* uart) {
+
+	// 8 significant bits or less: one byte per sample, same frame size
+	bool packed = (cap->bits <= 8);
+	uint32_t per_frame = packed ? 2 * CAPTURE_CHUNK : CAPTURE_CHUNK;
+
+	uint32_t total = (uint32_t)cap->pre + cap->post;
+	uint32_t count = total - cap->sent;
+	if (count > per_frame) {
+		count = per_frame;
+	}
+	uint32_t chunk = cap->sent / per_frame;
+
+	uint8_t frame[2 * CAPTURE_CHUNK + 11];
+	uint32_t n = 0;
+	frame[n++] = CAPTURE_FRAME_SYNC0;
+	frame[n++] = packed ? CAPTURE_FRAME_SYNC1_PACKED : CAPTURE_FRAME_SYNC1;
+	frame[n++] = cap->seq++;
+	frame[n++] = (uint8_t)chunk;
+	frame[n++] = (uint8_t)(chunk >> 8);
+
+	// first sample of this frame relative to the trigger sample
+	uint32_t stamp = cap->stamp + (cap->sent - (uint32_t)cap->pre) * TIMER_STAMP_PER_SAMPLE;
+	frame[n++] = (uint8_t)stamp;
+	frame[n++] = (uint8_t)(stamp >> 8);
+	frame[n++] = (uint8_t)(stamp >> 16);
+	frame[n++] = (uint8_t)(stamp >> 24);
+	frame[n++] = (uint8_t)count;
+
+	uint32_t pos = cap->start + cap->sent;
+	if (packed) {
+		for (uint32_t i = 0; i < count; i++) {
+			frame[n++] = (uint8_t)(cap->ring[(pos + i) & CAPTURE_MASK] >> 4);
+		}
+	} else {
+		for (uint32_t i = 0; i < count; i++) {
+			uint16_t x = cap->ring[(pos + i) & CAPTURE_MASK];
+			frame[n++] = (uint8_t)x;
+			frame[n++] = (uint8_t)(x >> 8);
+		}
+	}
+
+	uint8_t x = 0;
+	for (uint32_t i = 2; i < n; i++) {
+		x ^= frame[i];
+	}
+	frame[n++] = x;
+
+	uart_DMA_write(uart, frame, (uint16_t)n);
+	cap->sent += count;
+}
+
+/**
+  * @brief  Service trigger requests, stream the snapshot
+  * @note   Call on every main loop pass (not only on the display tick)
+  * @param  *cap Pointer to the CAPTURE_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void capture_poll(CAPTURE_Handle_t* cap, UART_Handle_t* uart) {
+
+	// runtime trigger change (set capture.requested)
+	if (cap->requested != cap->trigger) {
+		capture_set_trigger(cap, cap->requested);
+	}
+
+	if (cap->state != CAPTURE_STATE_SEND) {
+		return;
+	}
+
+	// one frame at a time, and only once the other output has drained
+	if (circbuf_count(uart->circ_buffer) > CAPTURE_TX_LEVEL) {
+		return;
+	}
+
+	if (!cap->announced) {
+		char line[96];
+		snprintf(line, sizeof(line), "\r\ncap n=%lu src=%s pre=%u post=%u level=%u dc=%u bits=%u t=%lu\r\n",
+				(unsigned long)(cap->captures + 1), (cap->trigger == CAPTURE_TRIG_AWD) ? "awd" : "level",
+				cap->pre, cap->post, cap->level, dc.offset, cap->bits, (unsigned long)cap->stamp);
+		uart_DMA_printf(uart, line);
+		cap->announced = true;
+		return;
+	}
+
+	capture_send_frame(cap, uart);
+
+	// whole snapshot queued: hand the ring back to the bottom half
+	if (cap->sent >= (uint32_t)cap->pre + cap->post) {
+		cap->sent = 0;
+		cap->announced = false;
+		cap->captures++;
+		cap->state = CAPTURE_STATE_HOLDOFF;
+	}
+}
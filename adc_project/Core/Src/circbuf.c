@@ -13,6 +13,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 // initialize global CircBuf instance
@@ -95,6 +96,35 @@ void circbuf_advance(CircBuf* circbuf, uint16_t len) {
 
 }
 
+/**
+  * @brief  Copy bytes out of the buffer into a linear destination, advance tail
+  * @param  *circbuf Pointer to the CircBuf instance
+  * @param  *dst Destination buffer
+  * @param  len Maximum number of bytes to copy
+  * @retval Number of bytes copied
+**/
+uint16_t circbuf_read(CircBuf* circbuf, uint8_t* dst, uint16_t len) {
+
+	uint16_t copied = 0;
+	uint8_t* chunk_ptr;
+	uint16_t chunk_len;
+
+	// copy at most two contiguous chunks (before and after wrap)
+	while (copied < len) {
+		circbuf_peek_contiguous(circbuf, &chunk_ptr, &chunk_len);
+		if (chunk_len == 0) {
+			break;
+		}
+		if (chunk_len > len - copied) {
+			chunk_len = len - copied;
+		}
+		memcpy(&dst[copied], chunk_ptr, chunk_len);
+		circbuf_advance(circbuf, chunk_len);
+		copied += chunk_len;
+	}
+	return copied;
+}
+
 /**
   * @brief  Return int of count of values currently in buffer
   * @param  circbuf Pointer to the CircBuf instance
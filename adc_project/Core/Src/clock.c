@@ -0,0 +1,241 @@
+/**
+ * clock.c
+ * --------
+ * System clock profiles and clock-dependent peripheral setup.
+ *
+ * Two profiles are available:
+ *   LOWPOWER    : 84 MHz, VOS scale 3, no over-drive, 2 wait states
+ *   PERFORMANCE : 180 MHz, VOS scale 1 + over-drive, 5 wait states
+ *
+ * The boot profile is chosen at build time with CLOCK_PROFILE_DEFAULT.
+ * At runtime, write 'sysclk.requested' (main loop / debugger) or call
+ * 'clock_set_profile' from thread mode. After every switch the timer
+ * prescalers, USART BRR and ADC clock divider are recomputed from the
+ * new bus clocks, so the sample rate and baud rate do not change.
+ **/
+
+#include "clock.h"
+#include "stm32f4xx.h"
+#include "stm32f4xx_ll_rcc.h"
+#include "stm32f4xx_ll_pwr.h"
+#include "stm32f4xx_ll_system.h"
+#include "stm32f4xx_ll_utils.h"
+#include "stm32f4xx_ll_tim.h"
+#include "timer.h"
+#include "uart.h"
+#include "adc.h"
+#include "perf.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+
+	uint32_t sysclk_hz; // resulting core clock
+	uint32_t pllm; // PLL input divider (HSI 16 MHz -> VCO input)
+	uint32_t plln; // VCO multiplier
+	uint32_t pllp; // VCO -> SYSCLK divider
+	uint32_t vos; // regulator voltage scale
+	bool overdrive; // over-drive required
+	uint32_t latency; // flash wait states
+	uint32_t apb1_div; // APB1 prescaler (max 45 MHz)
+	uint32_t apb2_div; // APB2 prescaler (max 90 MHz)
+
+} CLOCK_Config_t;
+
+// profile table, indexed by CLOCK_Profile_t
+static const CLOCK_Config_t clock_config[CLOCK_PROFILE_COUNT] = {
+
+	// 16 MHz / 16 * 336 / 4 = 84 MHz, APB1 42 MHz, APB2 84 MHz
+	[CLOCK_PROFILE_LOWPOWER] = { 84000000U, LL_RCC_PLLM_DIV_16, 336, LL_RCC_PLLP_DIV_4,
+			LL_PWR_REGU_VOLTAGE_SCALE3, false, LL_FLASH_LATENCY_2, LL_RCC_APB1_DIV_2, LL_RCC_APB2_DIV_1 },
+
+	// 16 MHz / 8 * 180 / 2 = 180 MHz, APB1 45 MHz, APB2 90 MHz
+	[CLOCK_PROFILE_PERFORMANCE] = { 180000000U, LL_RCC_PLLM_DIV_8, 180, LL_RCC_PLLP_DIV_2,
+			LL_PWR_REGU_VOLTAGE_SCALE1, true, LL_FLASH_LATENCY_5, LL_RCC_APB1_DIV_4, LL_RCC_APB2_DIV_2 },
+};
+
+// initialize global CLOCK_Handle_t instance
+CLOCK_Handle_t sysclk;
+
+/**
+  * @brief  Reprogram PLL, regulator and bus prescalers for a profile
+  * @note   Runs from HSI while the PLL is reconfigured
+  * @param  *cfg Pointer to the profile configuration
+  * @retval Void
+**/
+static void clock_apply(const CLOCK_Config_t* cfg) {
+
+	// run from HSI while the PLL is down
+	LL_RCC_HSI_Enable();
+	while (LL_RCC_HSI_IsReady() != 1) {
+	}
+	LL_RCC_SetSysClkSource(LL_RCC_SYS_CLKSOURCE_HSI);
+	while (LL_RCC_GetSysClkSource() != LL_RCC_SYS_CLKSOURCE_STATUS_HSI) {
+	}
+
+	// worst-case wait states until the final clock is known
+	LL_FLASH_SetLatency(LL_FLASH_LATENCY_5);
+	while (LL_FLASH_GetLatency() != LL_FLASH_LATENCY_5) {
+	}
+
+	LL_RCC_PLL_Disable();
+	while (LL_RCC_PLL_IsReady() != 0) {
+	}
+
+	// over-drive may only be left while SYSCLK is not the PLL
+	if (!cfg->overdrive) {
+		LL_PWR_DisableOverDriveSwitching();
+		LL_PWR_DisableOverDriveMode();
+	}
+
+	// VOS takes effect once the PLL is enabled
+	LL_PWR_SetRegulVoltageScaling(cfg->vos);
+	LL_RCC_PLL_ConfigDomain_SYS(LL_RCC_PLLSOURCE_HSI, cfg->pllm, cfg->plln, cfg->pllp);
+	LL_RCC_PLL_Enable();
+	while (LL_RCC_PLL_IsReady() != 1) {
+	}
+
+	// over-drive sequence: enable, wait ready, then switch regulator
+	if (cfg->overdrive) {
+		LL_PWR_EnableOverDriveMode();
+		while (LL_PWR_IsActiveFlag_OD() == 0) {
+		}
+		LL_PWR_EnableOverDriveSwitching();
+		while (LL_PWR_IsActiveFlag_ODSW() == 0) {
+		}
+	}
+	while (LL_PWR_IsActiveFlag_VOS() == 0) {
+	}
+
+	LL_RCC_SetAHBPrescaler(LL_RCC_SYSCLK_DIV_1);
+	LL_RCC_SetAPB1Prescaler(cfg->apb1_div);
+	LL_RCC_SetAPB2Prescaler(cfg->apb2_div);
+	LL_RCC_SetSysClkSource(LL_RCC_SYS_CLKSOURCE_PLL);
+	while (LL_RCC_GetSysClkSource() != LL_RCC_SYS_CLKSOURCE_STATUS_PLL) {
+	}
+
+	// drop to the profile's wait states
+	LL_FLASH_SetLatency(cfg->latency);
+	while (LL_FLASH_GetLatency() != cfg->latency) {
+	}
+
+	LL_Init1msTick(cfg->sysclk_hz);
+	LL_SetSystemCoreClock(cfg->sysclk_hz);
+	LL_RCC_SetTIMPrescaler(LL_RCC_TIM_PRESCALER_TWICE);
+}
+
+/**
+  * @brief  Read back bus clocks into the handle
+  * @param  *clk Pointer to the CLOCK_Handle_t instance
+  * @retval Void
+**/
+static void clock_update_freqs(CLOCK_Handle_t* clk) {
+
+	LL_RCC_ClocksTypeDef freqs;
+	LL_RCC_GetSystemClocksFreq(&freqs);
+
+	clk->hclk_hz = freqs.HCLK_Frequency;
+	clk->pclk1_hz = freqs.PCLK1_Frequency;
+	clk->pclk2_hz = freqs.PCLK2_Frequency;
+
+	// timers on a divided APB run at twice the bus clock (TIMPRE = 0)
+	if (LL_RCC_GetAPB1Prescaler() == LL_RCC_APB1_DIV_1) {
+		clk->tim_apb1_hz = freqs.PCLK1_Frequency;
+	} else {
+		clk->tim_apb1_hz = 2U * freqs.PCLK1_Frequency;
+	}
+}
+
+/**
+  * @brief  Apply boot clock profile
+  * @note   Call right after SystemClock_Config, before peripheral init
+  * @param  *clk Pointer to the CLOCK_Handle_t instance
+  * @param  profile Profile to run
+  * @retval Void
+**/
+void clock_init(CLOCK_Handle_t* clk, CLOCK_Profile_t profile) {
+
+	// initialize software state
+	clk->profile = profile;
+	clk->requested = profile;
+	clk->switches = 0;
+
+	// ART accelerator: prefetch + instruction / data caches hide most flash wait states
+	LL_FLASH_EnablePrefetch();
+	LL_FLASH_EnableInstCache();
+	LL_FLASH_EnableDataCache();
+
+	// SystemClock_Config already runs the low-power profile
+	if (profile != CLOCK_PROFILE_LOWPOWER) {
+		clock_apply(&clock_config[profile]);
+	}
+	clock_update_freqs(clk);
+}
+
+/**
+  * @brief  Wait until a UART port has sent its backlog and the last frame
+  * @note   The bottom half runs in PendSV
+  * @param  *u Pointer to the UART_Handle_t instance
+  * @retval Void
+**/
+static void clock_uart_drain(UART_Handle_t* u) {
+
+	while (u->tx_state != UART_TX_IDLE || !circbuf_is_empty(u->circ_buffer)) {
+	}
+	while (!LL_USART_IsActiveFlag_TC(u->Instance)) {
+	}
+}
+
+/**
+  * @brief  Recompute BRR of a UART port from the bus it is clocked from
+  * @param  *clk Pointer to the CLOCK_Handle_t instance
+  * @param  *u Pointer to the UART_Handle_t instance
+  * @retval Void
+**/
+static void clock_uart_update(CLOCK_Handle_t* clk, UART_Handle_t* u) {
+
+	uart_set_clock(u, u->apb2 ? clk->pclk2_hz : clk->pclk1_hz);
+}
+
+/**
+  * @brief  Switch clock profile at runtime
+  * @note   Thread mode only; blocks until UART TX is idle
+  * @param  *clk Pointer to the CLOCK_Handle_t instance
+  * @param  profile Profile to run
+  * @retval Void
+**/
+void clock_set_profile(CLOCK_Handle_t* clk, CLOCK_Profile_t profile) {
+
+	if (profile >= CLOCK_PROFILE_COUNT || profile == clk->profile) {
+		clk->requested = clk->profile;
+		return;
+	}
+
+	// stop sample / display ticks so no new work is produced
+	LL_TIM_DisableCounter(TIM2);
+	LL_TIM_DisableCounter(TIM3);
+
+	// let the TX backlog drain on every port, then the last frame
+	clock_uart_drain(&uart);
+#ifdef UART_AUX_ENABLE
+	clock_uart_drain(&uart_aux);
+#endif
+
+	clock_apply(&clock_config[profile]);
+	clock_update_freqs(clk);
+	clk->profile = profile;
+	clk->requested = profile;
+	clk->switches++;
+
+	// recompute everything derived from the bus clocks
+	perf_init(&perf);
+	clock_uart_update(clk, &uart);
+#ifdef UART_AUX_ENABLE
+	clock_uart_update(clk, &uart_aux);
+#endif
+	adc_set_clock(&adc, clk->pclk2_hz);
+	timer_set_clock(&timer, clk->tim_apb1_hz);
+
+	LL_TIM_EnableCounter(TIM2);
+	LL_TIM_EnableCounter(TIM3);
+}
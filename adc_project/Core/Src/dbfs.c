@@ -0,0 +1,50 @@
+/**
+ * dbfs.c
+ * -------
+ * Linear level -> dBFS conversion without libm.
+ *
+ * log2 is split into an integer part (leading-zero count) and a
+ * fractional part looked up in the generated 'dsp_log2_frac' table,
+ * then scaled by 20 * log10(2). Results are in tenths of a dB
+ * (deci-dB); full scale (0 dBFS) is DBFS_FULL_SCALE ADC counts.
+ **/
+
+#include "dbfs.h"
+#include "dsp_tables.h"
+#include <stdint.h>
+
+// 200 * log10(2) deci-dB per octave, Q16
+#define DBFS_DB10_PER_OCTAVE_Q16 3945660
+
+/**
+  * @brief  log2 of an unsigned integer
+  * @param  x Input value (> 0)
+  * @retval log2(x) in Q16
+**/
+int32_t dbfs_log2_q16(uint32_t x) {
+
+	// integer part: position of the leading one
+	uint32_t lz = __builtin_clz(x);
+	int32_t ipart = 31 - (int32_t)lz;
+
+	// fraction: the DSP_LOG2_BITS bits below the leading one index the table
+	uint32_t mant = x << lz; // leading one at bit 31
+	uint32_t idx = (mant >> (31 - DSP_LOG2_BITS)) & ((1UL << DSP_LOG2_BITS) - 1);
+
+	return (ipart << 16) + dsp_log2_frac[idx];
+}
+
+/**
+  * @brief  Convert a linear level to dBFS
+  * @param  level Level in ADC counts
+  * @retval Level in deci-dB relative to full scale (DBFS_FLOOR_DB10 for 0)
+**/
+int32_t dbfs_from_level(uint32_t level) {
+
+	if (level == 0) {
+		return DBFS_FLOOR_DB10;
+	}
+
+	int32_t l2 = dbfs_log2_q16(level) - (DBFS_FULL_SCALE_LOG2 << 16);
+	return (int32_t)(((int64_t)l2 * DBFS_DB10_PER_OCTAVE_Q16 + (1LL << 31)) >> 32);
+}
@@ -0,0 +1,65 @@
+/**
+ * dc_track.c
+ * -----------
+ * DC-offset tracker (one-pole high-pass) ahead of the level chain.
+ *
+ * The offset is kept in Q16 counts so the shifted update keeps its
+ * fraction; the correction itself uses the rounded offset and one
+ * __USAT to stay inside the 12-bit range.
+ **/
+
+#include "dc_track.h"
+#include "adc.h"
+#include "stm32f4xx.h"
+#include <stdint.h>
+
+// initialize global DC_Handle_t instance
+DC_Handle_t dc;
+
+/**
+  * @brief  Initialize the tracker at mid-rail
+  * @param  *dc Pointer to the DC_Handle_t instance
+  * @param  shift Time constant, 2^shift samples (1..DC_SHIFT_MAX)
+  * @retval Void
+**/
+void dc_init(DC_Handle_t* dc, uint8_t shift) {
+
+	// initialize software state
+	if (shift == 0) {
+		shift = 1;
+	} else if (shift > DC_SHIFT_MAX) {
+		shift = DC_SHIFT_MAX;
+	}
+	dc->shift = shift;
+	dc->acc = (int32_t)ADC_MIDRAIL << 16;
+	dc->offset_q16 = dc->acc;
+	dc->offset = ADC_MIDRAIL;
+}
+
+/**
+  * @brief  Track the offset over a block and re-centre it on ADC_MIDRAIL
+  * @note   Called from the ADC bottom half, before any other stage
+  * @param  *dc Pointer to the DC_Handle_t instance
+  * @param  *blk Raw 12-bit samples, corrected in place
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void dc_process_block(DC_Handle_t* dc, uint16_t* blk, uint32_t len) {
+
+	int32_t acc = dc->acc;
+	uint32_t shift = dc->shift;
+
+	for (uint32_t i = 0; i < len; i++) {
+		int32_t x = blk[i];
+
+		// offset += (x - offset) >> shift, Q16
+		acc += ((x << 16) - acc) >> shift;
+
+		// x - round(offset) + mid-rail, saturated to 12 bits
+		blk[i] = (uint16_t)__USAT(x - ((acc + 0x8000) >> 16) + ADC_MIDRAIL, 12);
+	}
+
+	dc->acc = acc;
+	dc->offset_q16 = acc;
+	dc->offset = (uint16_t)((acc + 0x8000) >> 16);
+}
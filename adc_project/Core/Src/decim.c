@@ -0,0 +1,119 @@
+/**
+ * decim.c
+ * --------
+ * Polyphase FIR decimator (Q15).
+ *
+ * Every input sample is written to the delay line of one phase; when
+ * the phase-0 sample of an output period arrives, one output is
+ * computed as the sum of the M phase dot products. Delay lines are
+ * stored twice in a row, so the newest L samples of a phase are always
+ * contiguous and can be read as packed pairs for __SMLAD.
+ **/
+
+#include "decim.h"
+#include "adc.h"
+#include "stm32f4xx.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// raw 12-bit sample <-> Q15 (one bit of headroom, as in the FFT)
+#define DECIM_IN_SHIFT 3
+
+// initialize global DECIM_Handle_t instance
+DECIM_Handle_t decim;
+
+/**
+  * @brief  Initialize the decimator
+  * @param  *d Pointer to the DECIM_Handle_t instance
+  * @param  factor Decimation factor M (1..DECIM_FACTOR_MAX)
+  * @param  taps Filter length N, a multiple of 2 * M, at most DECIM_TAPS_MAX
+  * @param  *coef Q15 coefficients in polyphase order [phase][tap]
+  * @retval true on success, false if the configuration is not supported
+**/
+bool decim_init(DECIM_Handle_t* d, uint8_t factor, uint16_t taps, const int16_t* coef) {
+
+	if (factor == 0 || factor > DECIM_FACTOR_MAX || taps == 0 || taps > DECIM_TAPS_MAX
+			|| (taps % (2U * factor)) != 0 || coef == NULL) {
+		return false;
+	}
+
+	d->factor = factor;
+	d->taps = taps;
+	d->phase_len = taps / factor;
+	d->coef = coef;
+	d->phase = factor - 1;
+	d->pos = 0;
+	d->outputs = 0;
+	memset(d->line, 0, sizeof(d->line));
+	return true;
+}
+
+/**
+  * @brief  One output: sum of the phase dot products
+  * @param  *d Pointer to the DECIM_Handle_t instance
+  * @retval Output sample, Q15
+**/
+static inline int32_t decim_output(DECIM_Handle_t* d) {
+
+	uint32_t len = d->phase_len;
+	int32_t acc = 0;
+
+	for (uint32_t p = 0; p < d->factor; p++) {
+		const int16_t* x = &d->line[2 * len * p + d->pos];
+		const int16_t* h = &d->coef[len * p];
+
+		// two taps per __SMLAD (pairs may be halfword aligned; LDR allows it)
+		for (uint32_t i = 0; i < len; i += 2) {
+			acc = (int32_t)__SMLAD(__UNALIGNED_UINT32_READ(&x[i]), __UNALIGNED_UINT32_READ(&h[i]), (uint32_t)acc);
+		}
+	}
+	return acc >> 15;
+}
+
+/**
+  * @brief  Decimate a block of raw ADC samples
+  * @note   Called from the ADC bottom half
+  * @param  *d Pointer to the DECIM_Handle_t instance
+  * @param  *in Raw 12-bit samples
+  * @param  *out Output samples, room for len / M + 1
+  * @param  len Number of input samples
+  * @retval Number of output samples written
+**/
+RAMFUNC uint32_t decim_process_block(DECIM_Handle_t* d, const uint16_t* in, uint16_t* out, uint32_t len) {
+
+	uint32_t n = 0;
+	uint32_t l = d->phase_len;
+
+	for (uint32_t i = 0; i < len; i++) {
+
+		// a new output period starts with phase M-1: step every line back one slot
+		if (d->phase == d->factor - 1) {
+			d->pos = (d->pos == 0) ? l - 1 : d->pos - 1U;
+		}
+
+		// newest sample at 'pos', mirrored at 'pos + L'
+		int16_t x = (int16_t)(((int32_t)in[i] - ADC_MIDRAIL) << DECIM_IN_SHIFT);
+		int16_t* line = &d->line[2 * l * d->phase];
+		line[d->pos] = x;
+		line[d->pos + l] = x;
+
+		if (d->phase != 0) {
+			d->phase--;
+			continue;
+		}
+		d->phase = d->factor - 1;
+
+		// back to the raw block format (round, re-bias, clamp to 12 bits)
+		int32_t y = ((decim_output(d) + (1 << (DECIM_IN_SHIFT - 1))) >> DECIM_IN_SHIFT) + ADC_MIDRAIL;
+		if (y < 0) {
+			y = 0;
+		} else if (y > 4095) {
+			y = 4095;
+		}
+		out[n++] = (uint16_t)y;
+	}
+
+	d->outputs += n;
+	return n;
+}
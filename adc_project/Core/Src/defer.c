@@ -0,0 +1,100 @@
+/**
+ * defer.c
+ * --------
+ * Deferred-work ("bottom half") facility driven by PendSV.
+ *
+ * Top-half ISRs only acknowledge hardware and post a work item.
+ * Posting sets a bit in a lock-free pending mask and pends PendSV,
+ * which runs at the lowest priority and drains the mask, so
+ * high-priority sampling ISRs stay short and bounded.
+ *
+ * Work items are fixed at build time; lower index runs first.
+ **/
+
+#include "defer.h"
+#include "stm32f4xx.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+// initialize global DEFER_Handle_t instance
+DEFER_Handle_t defer;
+
+/**
+  * @brief  Initialize defer module
+  * @param  *defer Pointer to the DEFER_Handle_t instance
+  * @retval Void
+**/
+void defer_init(DEFER_Handle_t* defer) {
+
+	// clear pending mask and handler table
+	defer->pending = 0;
+	for (uint32_t i = 0; i < DEFER_COUNT; i++) {
+		defer->func[i] = NULL;
+		defer->ctx[i] = NULL;
+	}
+}
+
+/**
+  * @brief  Register the bottom-half handler for a work item
+  * @param  *defer Pointer to the DEFER_Handle_t instance
+  * @param  work Work item to bind
+  * @param  func Handler run from PendSV
+  * @param  *ctx Context pointer passed to the handler
+  * @retval Void
+**/
+void defer_register(DEFER_Handle_t* defer, DEFER_Work_t work, DEFER_Func_t func, void* ctx) {
+
+	defer->ctx[work] = ctx;
+	defer->func[work] = func;
+}
+
+/**
+  * @brief  Post a work item and pend PendSV
+  * @note   Lock-free, safe from any interrupt priority
+  * @param  *defer Pointer to the DEFER_Handle_t instance
+  * @param  work Work item to post
+  * @retval Void
+**/
+RAMFUNC void defer_post(DEFER_Handle_t* defer, DEFER_Work_t work) {
+
+	// atomic OR of the work bit (retry if pre-empted between LDREX/STREX)
+	uint32_t mask;
+	do {
+		mask = __LDREXW(&defer->pending);
+	} while (__STREXW(mask | (1UL << work), &defer->pending));
+
+	// pend PendSV
+	SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+}
+
+/**
+  * @brief  Drain all pending work items
+  * @note   Called from PendSV_Handler only
+  * @param  *defer Pointer to the DEFER_Handle_t instance
+  * @retval Void
+**/
+void defer_run(DEFER_Handle_t* defer) {
+
+	uint32_t mask;
+
+	// keep draining until nothing new was posted while handlers ran
+	for (;;) {
+
+		// atomically take and clear the pending mask
+		do {
+			mask = __LDREXW(&defer->pending);
+		} while (__STREXW(0, &defer->pending));
+
+		if (mask == 0) {
+			return;
+		}
+
+		// run handlers, lowest index first
+		for (uint32_t i = 0; i < DEFER_COUNT; i++) {
+			if ((mask & (1UL << i)) && defer->func[i] != NULL) {
+				defer->func[i](defer->ctx[i]);
+			}
+		}
+	}
+}
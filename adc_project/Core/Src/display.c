@@ -7,12 +7,32 @@
  * ASCII bar graph over UART.
  *
  * Includes envelope smoothing to improve visual responsiveness.
+ * The envelope follower has separate attack (rising) and release
+ * (falling) time constants, given in milliseconds and converted once
+ * to Q16 coefficients for the sample rate, so the per-sample update
+ * is a single multiply and shift.
+ *
+ * The bar can follow either the envelope filter or the sliding
+ * window RMS meter (rms module), selected by 'source'.
+ *
+ * The bar is computed, not looked up: either linear (0..750 counts)
+ * or dBFS over a configurable range (table-based log2, no libm on the
+ * update path), with a peak-hold marker that decays after a hold time.
+ *
+ * With view DISPLAY_VIEW_BANDS the line shows one small bar per band
+ * of the octave analyzer instead (octave module, same dB range).
  **/
 
 #include <display.h>
 #include "circbuf.h"
 #include "adc.h"
 #include "uart.h"
+#include "rms.h"
+#include "timer.h"
+#include "dbfs.h"
+#include "octave.h"
+#include <math.h>
+#include <stdio.h>
 
 // initialize global DISPLAY_Handle_t instance
 DISPLAY_Handle_t disp;
@@ -24,8 +44,55 @@ DISPLAY_Handle_t disp;
 **/
 void display_init(DISPLAY_Handle_t* disp) {
 
-	// set isf field
-	disp->isf = 16;
+	// clear envelope state, default time constants at the ADC rate
+	disp->env = 0;
+	display_set_time_constants(disp, DISPLAY_ATTACK_MS, DISPLAY_RELEASE_MS, TIM2_RATE_HZ);
+
+	// bar follows the envelope by default, on a dBFS scale
+	disp->view = DISPLAY_VIEW_LEVEL;
+	disp->source = DISPLAY_SOURCE_ENVELOPE;
+	disp->scale = DISPLAY_SCALE_DB;
+	display_set_db_range(disp, DISPLAY_DB_MIN, DISPLAY_DB_MAX);
+	disp->db = DBFS_FLOOR_DB10;
+
+	// clear peak-hold marker
+	disp->peak_step = 0;
+	disp->peak_hold = 0;
+	disp->peak_decay = 0;
+}
+
+/**
+  * @brief  Time constant -> Q16 one-pole coefficient, 1 - exp(-1 / (tau * fs))
+  * @param  ms Time constant in ms (0 = follow instantly)
+  * @param  sample_rate_hz Filter input rate
+  * @retval Q16 coefficient in 1..65536
+**/
+static uint32_t display_coef(uint16_t ms, uint32_t sample_rate_hz) {
+
+	if (ms == 0) {
+		return 1UL << DISPLAY_COEF_SHIFT;
+	}
+	float samples = (float)ms * (float)sample_rate_hz / 1000.0f;
+	float a = 1.0f - expf(-1.0f / samples);
+	uint32_t coef = (uint32_t)(a * (float)(1UL << DISPLAY_COEF_SHIFT) + 0.5f);
+	return (coef == 0) ? 1 : coef;
+}
+
+/**
+  * @brief  Set attack / release time constants
+  * @note   Converts to Q16 coefficients for the given sample rate
+  * @param  disp Pointer to the DISP_Handle_t instance
+  * @param  attack_ms Rise time constant in ms
+  * @param  release_ms Fall time constant in ms
+  * @param  sample_rate_hz Rate at which the filter is fed
+  * @retval Void
+**/
+void display_set_time_constants(DISPLAY_Handle_t* disp, uint16_t attack_ms, uint16_t release_ms, uint32_t sample_rate_hz) {
+
+	disp->attack_ms = attack_ms;
+	disp->release_ms = release_ms;
+	disp->attack_coef = display_coef(attack_ms, sample_rate_hz);
+	disp->release_coef = display_coef(release_ms, sample_rate_hz);
 }
 
 /**
@@ -34,158 +101,184 @@ void display_init(DISPLAY_Handle_t* disp) {
   * @param  raw sample value to process
   * @retval Void
 **/
-uint16_t display_envelope_filter(DISPLAY_Handle_t* disp, uint16_t raw) {
+RAMFUNC uint16_t display_envelope_filter(DISPLAY_Handle_t* disp, uint16_t raw) {
 
-	// initialize envelope value
-	 static int32_t env = 0;
-
-	 // remove DC bias, take absolute value
-	 int32_t x = raw - 2048;
+	 // remove mid-rail (block already re-centred by the DC tracker), rectify (Q16)
+	 int32_t x = raw - ADC_MIDRAIL;
 	 if (x < 0) x = -x;
+	 x <<= DISPLAY_COEF_SHIFT;
+
+	 // attack coefficient while rising, release while falling
+	 int32_t diff = x - disp->env;
+	 uint32_t coef = (diff > 0) ? disp->attack_coef : disp->release_coef;
 
-	 // apply low-pass filter formula, return processed value
-	 env = env + (x - env) / disp->isf;
-	 return (uint16_t)env;
+	 // env += diff * coef (Q16 x Q16 -> 64-bit product, no division)
+	 disp->env += (int32_t)(((int64_t)diff * coef) >> DISPLAY_COEF_SHIFT);
+	 return (uint16_t)(disp->env >> DISPLAY_COEF_SHIFT);
 }
 
 /**
-  * @brief  Process sample value using envelope filter
+  * @brief  Set the dB range covered by the bar (DISPLAY_SCALE_DB)
+  * @param  disp Pointer to the DISP_Handle_t instance
+  * @param  min_db10 Level at an empty bar, deci-dB (e.g. -600 = -60 dBFS)
+  * @param  max_db10 Level at a full bar, deci-dB
+  * @retval Void
+**/
+void display_set_db_range(DISPLAY_Handle_t* disp, int16_t min_db10, int16_t max_db10) {
+
+	// keep at least one step of range
+	if (max_db10 <= min_db10) {
+		max_db10 = min_db10 + 1;
+	}
+	disp->db_min = min_db10;
+	disp->db_max = max_db10;
+}
+
+/**
+  * @brief  Map the current level to a bar step (0..DISPLAY_BAR_STEPS)
+  * @param  disp Pointer to the DISP_Handle_t instance
+  * @param  level Level in ADC counts
+  * @retval Bar step, half-character resolution
+**/
+static int32_t display_level_to_step(DISPLAY_Handle_t* disp, uint16_t level) {
+
+	int32_t step;
+
+	// dB value is kept for telemetry in both scales
+	disp->db = dbfs_from_level(level);
+
+	if (disp->scale == DISPLAY_SCALE_DB) {
+		step = (disp->db - disp->db_min) * DISPLAY_BAR_STEPS / (disp->db_max - disp->db_min);
+	} else {
+		step = (int32_t)level * DISPLAY_BAR_STEPS / DISPLAY_LINEAR_FULL;
+	}
+
+	if (step < 0) {
+		step = 0;
+	} else if (step > DISPLAY_BAR_STEPS) {
+		step = DISPLAY_BAR_STEPS;
+	}
+	return step;
+}
+
+/**
+  * @brief  Update peak-hold marker: hold, then decay one step at a time
+  * @param  disp Pointer to the DISP_Handle_t instance
+  * @param  step Current bar step
+  * @retval Void
+**/
+static void display_update_peak(DISPLAY_Handle_t* disp, int32_t step) {
+
+	if (step >= disp->peak_step) {
+		// new peak: restart hold time
+		disp->peak_step = step;
+		disp->peak_hold = DISPLAY_PEAK_HOLD_TICKS;
+		disp->peak_decay = 0;
+	} else if (disp->peak_hold > 0) {
+		disp->peak_hold--;
+	} else if (++disp->peak_decay >= DISPLAY_PEAK_DECAY_TICKS) {
+		disp->peak_decay = 0;
+		disp->peak_step--;
+	}
+}
+
+/**
+  * @brief  Render one bar per octave analyzer band to the UART
+  * @note   Bars share DISPLAY_BANDS_CHARS; one-character bands use a
+  *         density ramp instead of a bar
+  * @param  disp Pointer to the DISP_Handle_t instance
+  * @retval Void
+**/
+static void display_update_bands(DISPLAY_Handle_t* disp) {
+
+	static const char ramp[] = " .:-=+*#%@";
+	uint32_t width = DISPLAY_BANDS_CHARS / octave.bands;
+	int32_t range = disp->db_max - disp->db_min;
+
+	// e.g. octave bank: <||: |.. ||| ...> ; 1/3-octave bank: <  .:=*#*=-. ...>
+	char line[2 * DISPLAY_BANDS_CHARS + 8];
+	uint32_t n = 0;
+	line[n++] = '\r';
+	line[n++] = '<';
+	for (uint32_t b = 0; b < octave.bands; b++) {
+		int32_t db = dbfs_from_level(octave.level[b]) - disp->db_min;
+		if (db < 0) {
+			db = 0;
+		} else if (db > range) {
+			db = range;
+		}
+
+		if (width < 2) {
+			line[n++] = ramp[db * (int32_t)(sizeof(ramp) - 2) / range];
+			continue;
+		}
+
+		int32_t step = db * (int32_t)(2 * width) / range;
+		for (int32_t c = 0; c < (int32_t)width; c++) {
+			int32_t filled = step - 2 * c;
+			line[n++] = (filled >= 2) ? '|' : (filled == 1) ? ':' : '.';
+		}
+		if (b + 1 < octave.bands) {
+			line[n++] = ' ';
+		}
+	}
+	line[n++] = '>';
+	line[n] = '\0';
+
+	uart_DMA_printf(&uart, line);
+}
+
+/**
+  * @brief  Render the level bar (and dB readout) to the UART
   * @param  adc Pointer to ADC_Handle_t instance
   * @param  circ_buf Pointer to CircBuf instance
   * @retval Void
 **/
 void display_update(ADC_Handle_t* adc, CircBuf* circ_buf) {
 
-	// set level variable to processed sample
-	uint16_t level = adc->sample;
+	if (disp.view == DISPLAY_VIEW_BANDS) {
+		display_update_bands(&disp);
+		return;
+	}
 
-	// determine bar length based on processed sample value
-	if (level < 19) {
-	    uart_DMA_printf(&uart, "\r[....................]");
-	} else if (level >= 19 && level < 38) {
-	    uart_DMA_printf(&uart, "\r[:...................]");
-	} else if (level >= 38 && level < 56) {
-	    uart_DMA_printf(&uart, "\r[|...................]");
-	} else if (level >= 56 && level < 75) {
-	    uart_DMA_printf(&uart, "\r[|:..................]");
-	} else if (level >= 75 && level < 94) {
-	    uart_DMA_printf(&uart, "\r[||..................]");
-	} else if (level >= 94 && level < 113) {
-	    uart_DMA_printf(&uart, "\r[||:.................]");
-	} else if (level >= 113 && level < 131) {
-	    uart_DMA_printf(&uart, "\r[|||.................]");
-	} else if (level >= 131 && level < 150) {
-	    uart_DMA_printf(&uart, "\r[|||:................]");
-	} else if (level >= 150 && level < 169) {
-	    uart_DMA_printf(&uart, "\r[||||................]");
-	} else if (level >= 169 && level < 188) {
-	    uart_DMA_printf(&uart, "\r[||||:...............]");
-	} else if (level >= 188 && level < 206) {
-	    uart_DMA_printf(&uart, "\r[|||||...............]");
-	} else if (level >= 206 && level < 225) {
-	    uart_DMA_printf(&uart, "\r[|||||:..............]");
-	} else if (level >= 225 && level < 244) {
-	    uart_DMA_printf(&uart, "\r[||||||..............]");
-	} else if (level >= 244 && level < 263) {
-	    uart_DMA_printf(&uart, "\r[||||||:.............]");
-	} else if (level >= 263 && level < 281) {
-	    uart_DMA_printf(&uart, "\r[|||||||.............]");
-	} else if (level >= 281 && level < 300) {
-	    uart_DMA_printf(&uart, "\r[|||||||:............]");
-	} else if (level >= 300 && level < 319) {
-	    uart_DMA_printf(&uart, "\r[||||||||............]");
-	} else if (level >= 319 && level < 338) {
-	    uart_DMA_printf(&uart, "\r[||||||||:...........]");
-	} else if (level >= 338 && level < 356) {
-	    uart_DMA_printf(&uart, "\r[|||||||||...........]");
-	} else if (level >= 356 && level < 375) {
-	    uart_DMA_printf(&uart, "\r[|||||||||:..........]");
-	} else if (level >= 375 && level < 394) {
-	    uart_DMA_printf(&uart, "\r[||||||||||..........]");
-	} else if (level >= 394 && level < 413) {
-	    uart_DMA_printf(&uart, "\r[||||||||||:.........]");
-	} else if (level >= 413 && level < 431) {
-	    uart_DMA_printf(&uart, "\r[|||||||||||.........]");
-	} else if (level >= 431 && level < 450) {
-	    uart_DMA_printf(&uart, "\r[|||||||||||:........]");
-	} else if (level >= 450 && level < 469) {
-	    uart_DMA_printf(&uart, "\r[||||||||||||........]");
-	} else if (level >= 469 && level < 488) {
-	    uart_DMA_printf(&uart, "\r[||||||||||||:.......]");
-	} else if (level >= 488 && level < 506) {
-	    uart_DMA_printf(&uart, "\r[|||||||||||||.......]");
-	} else if (level >= 506 && level < 525) {
-	    uart_DMA_printf(&uart, "\r[|||||||||||||:......]");
-	} else if (level >= 525 && level < 544) {
-	    uart_DMA_printf(&uart, "\r[||||||||||||||......]");
-	} else if (level >= 544 && level < 563) {
-	    uart_DMA_printf(&uart, "\r[||||||||||||||:.....]");
-	} else if (level >= 563 && level < 581) {
-	    uart_DMA_printf(&uart, "\r[|||||||||||||||.....]");
-	} else if (level >= 581 && level < 600) {
-	    uart_DMA_printf(&uart, "\r[|||||||||||||||:....]");
-	} else if (level >= 600 && level < 619) {
-	    uart_DMA_printf(&uart, "\r[||||||||||||||||....]");
-	} else if (level >= 619 && level < 638) {
-	    uart_DMA_printf(&uart, "\r[||||||||||||||||:...]");
-	} else if (level >= 638 && level < 656) {
-	    uart_DMA_printf(&uart, "\r[|||||||||||||||||...]");
-	} else if (level >= 656 && level < 675) {
-	    uart_DMA_printf(&uart, "\r[|||||||||||||||||:..]");
-	} else if (level >= 675 && level < 694) {
-	    uart_DMA_printf(&uart, "\r[||||||||||||||||||..]");
-	} else if (level >= 694 && level < 713) {
-	    uart_DMA_printf(&uart, "\r[||||||||||||||||||:.]");
-	} else if (level >= 713 && level < 731) {
-	    uart_DMA_printf(&uart, "\r[|||||||||||||||||||.]");
-	} else if (level >= 731 && level < 750) {
-	    uart_DMA_printf(&uart, "\r[|||||||||||||||||||:]");
-	} else {
-	    uart_DMA_printf(&uart, "\r[||||||||||||||||||||]");
+	// set level variable to processed sample (or RMS level)
+	uint16_t level = adc->sample;
+	if (disp.source == DISPLAY_SOURCE_RMS) {
+		level = rms.level;
 	}
 
+	int32_t step = display_level_to_step(&disp, level);
+	display_update_peak(&disp, step);
 
-	// Bar:         Level:
-	// [....................] 30
-	// [:...................] 62.5
-	// [|...................]
-	// [|:..................]
-	// [||..................]
-	// [||:.................]
-	// [|||.................]
-	// [|||:................]
-	// [||||................]
-	// [||||:...............]
-	// [|||||...............]
-	// [|||||:..............]
-	// [||||||..............]
-	// [||||||:.............]
-	// [|||||||.............]
-	// [|||||||:............]
-	// [||||||||............]
-	// [||||||||:...........]
-	// [|||||||||...........]
-	// [|||||||||:..........]
-	// [||||||||||..........]
-	// [||||||||||:.........]
-	// [|||||||||||.........]
-	// [|||||||||||:........]
-	// [||||||||||||........]
-	// [||||||||||||:.......]
-	// [|||||||||||||.......]
-	// [|||||||||||||:......]
-	// [||||||||||||||......]
-	// [||||||||||||||:.....]
-	// [|||||||||||||||.....]
-	// [|||||||||||||||:....]x
-	// [||||||||||||||||....]
-	// [||||||||||||||||:...]
-	// [|||||||||||||||||...]
-	// [|||||||||||||||||:..]
-	// [||||||||||||||||||..]
-	// [||||||||||||||||||:.]
-	// [|||||||||||||||||||.]
-	// [|||||||||||||||||||:]
-	// [||||||||||||||||||||]
+	// bar: '|' = two steps, ':' = one step, '.' = empty, '!' = peak marker
+	// e.g. step 5, peak 12: [||:...!............]
+	char line[48];
+	uint32_t n = 0;
+	line[n++] = '\r';
+	line[n++] = '[';
+	for (int32_t c = 0; c < DISPLAY_BAR_CHARS; c++) {
+		int32_t filled = step - 2 * c;
+		if (filled >= 2) {
+			line[n++] = '|';
+		} else if (filled == 1) {
+			line[n++] = ':';
+		} else if (disp.peak_step > step && (disp.peak_step - 1) / 2 == c) {
+			line[n++] = '!';
+		} else {
+			line[n++] = '.';
+		}
+	}
+	line[n++] = ']';
+
+	// numeric readout in dB mode
+	if (disp.scale == DISPLAY_SCALE_DB) {
+		int32_t db = disp.db;
+		char sign = (db < 0) ? '-' : ' ';
+		if (db < 0) db = -db;
+		snprintf(&line[n], sizeof(line) - n, " %c%2ld.%ld dBFS", sign, (long)(db / 10), (long)(db % 10));
+	} else {
+		line[n] = '\0';
+	}
 
+	uart_DMA_printf(&uart, line);
 }
@@ -0,0 +1,636 @@
+/**
+ * dsp_tables.c
+ * -------------
+ * Constant DSP tables.
+ *
+ * GENERATED by tools/gen_tables.py - do not edit by hand.
+ **/
+
+#include "dsp_tables.h"
+#include <stdint.h>
+
+// log2(1 + i / 256), Q16
+const uint16_t dsp_log2_frac[256] = {
+	0, 369, 736, 1102, 1466, 1829, 2190, 2551,
+	2909, 3267, 3623, 3978, 4331, 4683, 5034, 5384,
+	5732, 6079, 6425, 6769, 7112, 7454, 7795, 8134,
+	8473, 8810, 9146, 9480, 9814, 10146, 10477, 10807,
+	11136, 11464, 11791, 12116, 12440, 12764, 13086, 13407,
+	13727, 14046, 14363, 14680, 14996, 15310, 15624, 15937,
+	16248, 16559, 16868, 17177, 17484, 17791, 18096, 18401,
+	18704, 19007, 19308, 19609, 19909, 20207, 20505, 20802,
+	21098, 21393, 21687, 21980, 22272, 22564, 22854, 23144,
+	23433, 23720, 24007, 24293, 24579, 24863, 25146, 25429,
+	25711, 25992, 26272, 26551, 26830, 27108, 27384, 27660,
+	27936, 28210, 28484, 28757, 29029, 29300, 29571, 29840,
+	30109, 30378, 30645, 30912, 31178, 31443, 31707, 31971,
+	32234, 32496, 32758, 33019, 33279, 33538, 33797, 34055,
+	34312, 34569, 34825, 35080, 35334, 35588, 35841, 36094,
+	36346, 36597, 36847, 37097, 37346, 37595, 37842, 38090,
+	38336, 38582, 38827, 39072, 39316, 39559, 39802, 40044,
+	40286, 40527, 40767, 41006, 41246, 41484, 41722, 41959,
+	42196, 42432, 42667, 42902, 43137, 43370, 43603, 43836,
+	44068, 44300, 44530, 44761, 44990, 45220, 45448, 45676,
+	45904, 46131, 46357, 46583, 46809, 47034, 47258, 47482,
+	47705, 47928, 48150, 48372, 48593, 48813, 49034, 49253,
+	49472, 49691, 49909, 50127, 50344, 50560, 50776, 50992,
+	51207, 51422, 51636, 51850, 52063, 52276, 52488, 52700,
+	52911, 53122, 53332, 53542, 53751, 53960, 54169, 54377,
+	54584, 54791, 54998, 55204, 55410, 55615, 55820, 56025,
+	56229, 56432, 56635, 56838, 57040, 57242, 57443, 57644,
+	57845, 58045, 58245, 58444, 58643, 58841, 59039, 59237,
+	59434, 59631, 59827, 60023, 60219, 60414, 60609, 60803,
+	60997, 61190, 61384, 61576, 61769, 61961, 62152, 62343,
+	62534, 62725, 62915, 63104, 63294, 63483, 63671, 63859,
+	64047, 64234, 64421, 64608, 64794, 64980, 65166, 65351,
+};
+
+// periodic Hann window, 0.5 - 0.5 cos(2 pi i / 2048), Q15
+const int16_t dsp_fft_hann[2048] = {
+	0, 0, 0, 1, 1, 2, 3, 4,
+	5, 6, 8, 9, 11, 13, 15, 17,
+	20, 22, 25, 28, 31, 34, 37, 41,
+	44, 48, 52, 56, 60, 65, 69, 74,
+	79, 84, 89, 94, 100, 105, 111, 117,
+	123, 129, 136, 142, 149, 156, 163, 170,
+	177, 185, 192, 200, 208, 216, 224, 233,
+	241, 250, 259, 268, 277, 286, 296, 305,
+	315, 325, 335, 345, 355, 366, 376, 387,
+	398, 409, 420, 432, 443, 455, 467, 479,
+	491, 503, 516, 528, 541, 554, 567, 580,
+	593, 607, 621, 634, 648, 662, 677, 691,
+	705, 720, 735, 750, 765, 780, 796, 811,
+	827, 843, 859, 875, 891, 908, 924, 941,
+	958, 975, 992, 1009, 1027, 1044, 1062, 1080,
+	1098, 1116, 1134, 1153, 1171, 1190, 1209, 1228,
+	1247, 1266, 1286, 1306, 1325, 1345, 1365, 1385,
+	1406, 1426, 1447, 1467, 1488, 1509, 1530, 1552,
+	1573, 1595, 1616, 1638, 1660, 1682, 1704, 1727,
+	1749, 1772, 1795, 1818, 1841, 1864, 1887, 1911,
+	1935, 1958, 1982, 2006, 2030, 2055, 2079, 2104,
+	2128, 2153, 2178, 2203, 2229, 2254, 2280, 2305,
+	2331, 2357, 2383, 2409, 2435, 2462, 2488, 2515,
+	2542, 2569, 2596, 2623, 2651, 2678, 2706, 2733,
+	2761, 2789, 2817, 2846, 2874, 2902, 2931, 2960,
+	2989, 3018, 3047, 3076, 3105, 3135, 3165, 3194,
+	3224, 3254, 3284, 3315, 3345, 3376, 3406, 3437,
+	3468, 3499, 3530, 3561, 3592, 3624, 3655, 3687,
+	3719, 3751, 3783, 3815, 3847, 3880, 3912, 3945,
+	3978, 4011, 4044, 4077, 4110, 4144, 4177, 4211,
+	4244, 4278, 4312, 4346, 4380, 4414, 4449, 4483,
+	4518, 4553, 4587, 4622, 4657, 4693, 4728, 4763,
+	4799, 4834, 4870, 4906, 4942, 4978, 5014, 5050,
+	5087, 5123, 5160, 5196, 5233, 5270, 5307, 5344,
+	5381, 5418, 5456, 5493, 5531, 5569, 5606, 5644,
+	5682, 5721, 5759, 5797, 5835, 5874, 5913, 5951,
+	5990, 6029, 6068, 6107, 6146, 6186, 6225, 6264,
+	6304, 6344, 6383, 6423, 6463, 6503, 6543, 6584,
+	6624, 6664, 6705, 6746, 6786, 6827, 6868, 6909,
+	6950, 6991, 7032, 7074, 7115, 7157, 7198, 7240,
+	7282, 7323, 7365, 7407, 7449, 7492, 7534, 7576,
+	7619, 7661, 7704, 7746, 7789, 7832, 7875, 7918,
+	7961, 8004, 8047, 8091, 8134, 8177, 8221, 8265,
+	8308, 8352, 8396, 8440, 8484, 8528, 8572, 8616,
+	8661, 8705, 8749, 8794, 8839, 8883, 8928, 8973,
+	9018, 9063, 9108, 9153, 9198, 9243, 9288, 9334,
+	9379, 9424, 9470, 9516, 9561, 9607, 9653, 9699,
+	9745, 9791, 9837, 9883, 9929, 9975, 10021, 10068,
+	10114, 10161, 10207, 10254, 10300, 10347, 10394, 10441,
+	10487, 10534, 10581, 10628, 10676, 10723, 10770, 10817,
+	10864, 10912, 10959, 11007, 11054, 11102, 11149, 11197,
+	11245, 11292, 11340, 11388, 11436, 11484, 11532, 11580,
+	11628, 11676, 11724, 11772, 11821, 11869, 11917, 11966,
+	12014, 12063, 12111, 12160, 12208, 12257, 12306, 12354,
+	12403, 12452, 12501, 12549, 12598, 12647, 12696, 12745,
+	12794, 12843, 12892, 12942, 12991, 13040, 13089, 13138,
+	13188, 13237, 13286, 13336, 13385, 13435, 13484, 13533,
+	13583, 13632, 13682, 13732, 13781, 13831, 13881, 13930,
+	13980, 14030, 14079, 14129, 14179, 14229, 14279, 14329,
+	14378, 14428, 14478, 14528, 14578, 14628, 14678, 14728,
+	14778, 14828, 14878, 14928, 14978, 15028, 15078, 15129,
+	15179, 15229, 15279, 15329, 15379, 15429, 15480, 15530,
+	15580, 15630, 15680, 15731, 15781, 15831, 15881, 15932,
+	15982, 16032, 16082, 16133, 16183, 16233, 16283, 16334,
+	16384, 16434, 16485, 16535, 16585, 16635, 16686, 16736,
+	16786, 16836, 16887, 16937, 16987, 17037, 17088, 17138,
+	17188, 17238, 17288, 17339, 17389, 17439, 17489, 17539,
+	17589, 17639, 17690, 17740, 17790, 17840, 17890, 17940,
+	17990, 18040, 18090, 18140, 18190, 18240, 18290, 18340,
+	18390, 18439, 18489, 18539, 18589, 18639, 18689, 18738,
+	18788, 18838, 18887, 18937, 18987, 19036, 19086, 19136,
+	19185, 19235, 19284, 19333, 19383, 19432, 19482, 19531,
+	19580, 19630, 19679, 19728, 19777, 19826, 19876, 19925,
+	19974, 20023, 20072, 20121, 20170, 20219, 20267, 20316,
+	20365, 20414, 20462, 20511, 20560, 20608, 20657, 20705,
+	20754, 20802, 20851, 20899, 20947, 20996, 21044, 21092,
+	21140, 21188, 21236, 21284, 21332, 21380, 21428, 21476,
+	21523, 21571, 21619, 21666, 21714, 21761, 21809, 21856,
+	21904, 21951, 21998, 22045, 22092, 22140, 22187, 22234,
+	22281, 22327, 22374, 22421, 22468, 22514, 22561, 22607,
+	22654, 22700, 22747, 22793, 22839, 22885, 22931, 22977,
+	23023, 23069, 23115, 23161, 23207, 23252, 23298, 23344,
+	23389, 23434, 23480, 23525, 23570, 23615, 23660, 23705,
+	23750, 23795, 23840, 23885, 23929, 23974, 24019, 24063,
+	24107, 24152, 24196, 24240, 24284, 24328, 24372, 24416,
+	24460, 24503, 24547, 24591, 24634, 24677, 24721, 24764,
+	24807, 24850, 24893, 24936, 24979, 25022, 25064, 25107,
+	25149, 25192, 25234, 25276, 25319, 25361, 25403, 25445,
+	25486, 25528, 25570, 25611, 25653, 25694, 25736, 25777,
+	25818, 25859, 25900, 25941, 25982, 26022, 26063, 26104,
+	26144, 26184, 26225, 26265, 26305, 26345, 26385, 26424,
+	26464, 26504, 26543, 26582, 26622, 26661, 26700, 26739,
+	26778, 26817, 26855, 26894, 26933, 26971, 27009, 27047,
+	27086, 27124, 27162, 27199, 27237, 27275, 27312, 27350,
+	27387, 27424, 27461, 27498, 27535, 27572, 27608, 27645,
+	27681, 27718, 27754, 27790, 27826, 27862, 27898, 27934,
+	27969, 28005, 28040, 28075, 28111, 28146, 28181, 28215,
+	28250, 28285, 28319, 28354, 28388, 28422, 28456, 28490,
+	28524, 28557, 28591, 28624, 28658, 28691, 28724, 28757,
+	28790, 28823, 28856, 28888, 28921, 28953, 28985, 29017,
+	29049, 29081, 29113, 29144, 29176, 29207, 29238, 29269,
+	29300, 29331, 29362, 29392, 29423, 29453, 29484, 29514,
+	29544, 29574, 29603, 29633, 29663, 29692, 29721, 29750,
+	29779, 29808, 29837, 29866, 29894, 29922, 29951, 29979,
+	30007, 30035, 30062, 30090, 30117, 30145, 30172, 30199,
+	30226, 30253, 30280, 30306, 30333, 30359, 30385, 30411,
+	30437, 30463, 30488, 30514, 30539, 30565, 30590, 30615,
+	30640, 30664, 30689, 30713, 30738, 30762, 30786, 30810,
+	30833, 30857, 30881, 30904, 30927, 30950, 30973, 30996,
+	31019, 31041, 31064, 31086, 31108, 31130, 31152, 31173,
+	31195, 31216, 31238, 31259, 31280, 31301, 31321, 31342,
+	31362, 31383, 31403, 31423, 31443, 31462, 31482, 31502,
+	31521, 31540, 31559, 31578, 31597, 31615, 31634, 31652,
+	31670, 31688, 31706, 31724, 31741, 31759, 31776, 31793,
+	31810, 31827, 31844, 31860, 31877, 31893, 31909, 31925,
+	31941, 31957, 31972, 31988, 32003, 32018, 32033, 32048,
+	32063, 32077, 32091, 32106, 32120, 32134, 32147, 32161,
+	32175, 32188, 32201, 32214, 32227, 32240, 32252, 32265,
+	32277, 32289, 32301, 32313, 32325, 32336, 32348, 32359,
+	32370, 32381, 32392, 32402, 32413, 32423, 32433, 32443,
+	32453, 32463, 32472, 32482, 32491, 32500, 32509, 32518,
+	32527, 32535, 32544, 32552, 32560, 32568, 32576, 32583,
+	32591, 32598, 32605, 32612, 32619, 32626, 32632, 32639,
+	32645, 32651, 32657, 32663, 32668, 32674, 32679, 32684,
+	32689, 32694, 32699, 32703, 32708, 32712, 32716, 32720,
+	32724, 32727, 32731, 32734, 32737, 32740, 32743, 32746,
+	32748, 32751, 32753, 32755, 32757, 32759, 32760, 32762,
+	32763, 32764, 32765, 32766, 32767, 32767, 32767, 32767,
+	32767, 32767, 32767, 32767, 32767, 32766, 32765, 32764,
+	32763, 32762, 32760, 32759, 32757, 32755, 32753, 32751,
+	32748, 32746, 32743, 32740, 32737, 32734, 32731, 32727,
+	32724, 32720, 32716, 32712, 32708, 32703, 32699, 32694,
+	32689, 32684, 32679, 32674, 32668, 32663, 32657, 32651,
+	32645, 32639, 32632, 32626, 32619, 32612, 32605, 32598,
+	32591, 32583, 32576, 32568, 32560, 32552, 32544, 32535,
+	32527, 32518, 32509, 32500, 32491, 32482, 32472, 32463,
+	32453, 32443, 32433, 32423, 32413, 32402, 32392, 32381,
+	32370, 32359, 32348, 32336, 32325, 32313, 32301, 32289,
+	32277, 32265, 32252, 32240, 32227, 32214, 32201, 32188,
+	32175, 32161, 32147, 32134, 32120, 32106, 32091, 32077,
+	32063, 32048, 32033, 32018, 32003, 31988, 31972, 31957,
+	31941, 31925, 31909, 31893, 31877, 31860, 31844, 31827,
+	31810, 31793, 31776, 31759, 31741, 31724, 31706, 31688,
+	31670, 31652, 31634, 31615, 31597, 31578, 31559, 31540,
+	31521, 31502, 31482, 31462, 31443, 31423, 31403, 31383,
+	31362, 31342, 31321, 31301, 31280, 31259, 31238, 31216,
+	31195, 31173, 31152, 31130, 31108, 31086, 31064, 31041,
+	31019, 30996, 30973, 30950, 30927, 30904, 30881, 30857,
+	30833, 30810, 30786, 30762, 30738, 30713, 30689, 30664,
+	30640, 30615, 30590, 30565, 30539, 30514, 30488, 30463,
+	30437, 30411, 30385, 30359, 30333, 30306, 30280, 30253,
+	30226, 30199, 30172, 30145, 30117, 30090, 30062, 30035,
+	30007, 29979, 29951, 29922, 29894, 29866, 29837, 29808,
+	29779, 29750, 29721, 29692, 29663, 29633, 29603, 29574,
+	29544, 29514, 29484, 29453, 29423, 29392, 29362, 29331,
+	29300, 29269, 29238, 29207, 29176, 29144, 29113, 29081,
+	29049, 29017, 28985, 28953, 28921, 28888, 28856, 28823,
+	28790, 28757, 28724, 28691, 28658, 28624, 28591, 28557,
+	28524, 28490, 28456, 28422, 28388, 28354, 28319, 28285,
+	28250, 28215, 28181, 28146, 28111, 28075, 28040, 28005,
+	27969, 27934, 27898, 27862, 27826, 27790, 27754, 27718,
+	27681, 27645, 27608, 27572, 27535, 27498, 27461, 27424,
+	27387, 27350, 27312, 27275, 27237, 27199, 27162, 27124,
+	27086, 27047, 27009, 26971, 26933, 26894, 26855, 26817,
+	26778, 26739, 26700, 26661, 26622, 26582, 26543, 26504,
+	26464, 26424, 26385, 26345, 26305, 26265, 26225, 26184,
+	26144, 26104, 26063, 26022, 25982, 25941, 25900, 25859,
+	25818, 25777, 25736, 25694, 25653, 25611, 25570, 25528,
+	25486, 25445, 25403, 25361, 25319, 25276, 25234, 25192,
+	25149, 25107, 25064, 25022, 24979, 24936, 24893, 24850,
+	24807, 24764, 24721, 24677, 24634, 24591, 24547, 24503,
+	24460, 24416, 24372, 24328, 24284, 24240, 24196, 24152,
+	24107, 24063, 24019, 23974, 23929, 23885, 23840, 23795,
+	23750, 23705, 23660, 23615, 23570, 23525, 23480, 23434,
+	23389, 23344, 23298, 23252, 23207, 23161, 23115, 23069,
+	23023, 22977, 22931, 22885, 22839, 22793, 22747, 22700,
+	22654, 22607, 22561, 22514, 22468, 22421, 22374, 22327,
+	22281, 22234, 22187, 22140, 22092, 22045, 21998, 21951,
+	21904, 21856, 21809, 21761, 21714, 21666, 21619, 21571,
+	21523, 21476, 21428, 21380, 21332, 21284, 21236, 21188,
+	21140, 21092, 21044, 20996, 20947, 20899, 20851, 20802,
+	20754, 20705, 20657, 20608, 20560, 20511, 20462, 20414,
+	20365, 20316, 20267, 20219, 20170, 20121, 20072, 20023,
+	19974, 19925, 19876, 19826, 19777, 19728, 19679, 19630,
+	19580, 19531, 19482, 19432, 19383, 19333, 19284, 19235,
+	19185, 19136, 19086, 19036, 18987, 18937, 18887, 18838,
+	18788, 18738, 18689, 18639, 18589, 18539, 18489, 18439,
+	18390, 18340, 18290, 18240, 18190, 18140, 18090, 18040,
+	17990, 17940, 17890, 17840, 17790, 17740, 17690, 17639,
+	17589, 17539, 17489, 17439, 17389, 17339, 17288, 17238,
+	17188, 17138, 17088, 17037, 16987, 16937, 16887, 16836,
+	16786, 16736, 16686, 16635, 16585, 16535, 16485, 16434,
+	16384, 16334, 16283, 16233, 16183, 16133, 16082, 16032,
+	15982, 15932, 15881, 15831, 15781, 15731, 15680, 15630,
+	15580, 15530, 15480, 15429, 15379, 15329, 15279, 15229,
+	15179, 15129, 15078, 15028, 14978, 14928, 14878, 14828,
+	14778, 14728, 14678, 14628, 14578, 14528, 14478, 14428,
+	14378, 14329, 14279, 14229, 14179, 14129, 14079, 14030,
+	13980, 13930, 13881, 13831, 13781, 13732, 13682, 13632,
+	13583, 13533, 13484, 13435, 13385, 13336, 13286, 13237,
+	13188, 13138, 13089, 13040, 12991, 12942, 12892, 12843,
+	12794, 12745, 12696, 12647, 12598, 12549, 12501, 12452,
+	12403, 12354, 12306, 12257, 12208, 12160, 12111, 12063,
+	12014, 11966, 11917, 11869, 11821, 11772, 11724, 11676,
+	11628, 11580, 11532, 11484, 11436, 11388, 11340, 11292,
+	11245, 11197, 11149, 11102, 11054, 11007, 10959, 10912,
+	10864, 10817, 10770, 10723, 10676, 10628, 10581, 10534,
+	10487, 10441, 10394, 10347, 10300, 10254, 10207, 10161,
+	10114, 10068, 10021, 9975, 9929, 9883, 9837, 9791,
+	9745, 9699, 9653, 9607, 9561, 9516, 9470, 9424,
+	9379, 9334, 9288, 9243, 9198, 9153, 9108, 9063,
+	9018, 8973, 8928, 8883, 8839, 8794, 8749, 8705,
+	8661, 8616, 8572, 8528, 8484, 8440, 8396, 8352,
+	8308, 8265, 8221, 8177, 8134, 8091, 8047, 8004,
+	7961, 7918, 7875, 7832, 7789, 7746, 7704, 7661,
+	7619, 7576, 7534, 7492, 7449, 7407, 7365, 7323,
+	7282, 7240, 7198, 7157, 7115, 7074, 7032, 6991,
+	6950, 6909, 6868, 6827, 6786, 6746, 6705, 6664,
+	6624, 6584, 6543, 6503, 6463, 6423, 6383, 6344,
+	6304, 6264, 6225, 6186, 6146, 6107, 6068, 6029,
+	5990, 5951, 5913, 5874, 5835, 5797, 5759, 5721,
+	5682, 5644, 5606, 5569, 5531, 5493, 5456, 5418,
+	5381, 5344, 5307, 5270, 5233, 5196, 5160, 5123,
+	5087, 5050, 5014, 4978, 4942, 4906, 4870, 4834,
+	4799, 4763, 4728, 4693, 4657, 4622, 4587, 4553,
+	4518, 4483, 4449, 4414, 4380, 4346, 4312, 4278,
+	4244, 4211, 4177, 4144, 4110, 4077, 4044, 4011,
+	3978, 3945, 3912, 3880, 3847, 3815, 3783, 3751,
+	3719, 3687, 3655, 3624, 3592, 3561, 3530, 3499,
+	3468, 3437, 3406, 3376, 3345, 3315, 3284, 3254,
+	3224, 3194, 3165, 3135, 3105, 3076, 3047, 3018,
+	2989, 2960, 2931, 2902, 2874, 2846, 2817, 2789,
+	2761, 2733, 2706, 2678, 2651, 2623, 2596, 2569,
+	2542, 2515, 2488, 2462, 2435, 2409, 2383, 2357,
+	2331, 2305, 2280, 2254, 2229, 2203, 2178, 2153,
+	2128, 2104, 2079, 2055, 2030, 2006, 1982, 1958,
+	1935, 1911, 1887, 1864, 1841, 1818, 1795, 1772,
+	1749, 1727, 1704, 1682, 1660, 1638, 1616, 1595,
+	1573, 1552, 1530, 1509, 1488, 1467, 1447, 1426,
+	1406, 1385, 1365, 1345, 1325, 1306, 1286, 1266,
+	1247, 1228, 1209, 1190, 1171, 1153, 1134, 1116,
+	1098, 1080, 1062, 1044, 1027, 1009, 992, 975,
+	958, 941, 924, 908, 891, 875, 859, 843,
+	827, 811, 796, 780, 765, 750, 735, 720,
+	705, 691, 677, 662, 648, 634, 621, 607,
+	593, 580, 567, 554, 541, 528, 516, 503,
+	491, 479, 467, 455, 443, 432, 420, 409,
+	398, 387, 376, 366, 355, 345, 335, 325,
+	315, 305, 296, 286, 277, 268, 259, 250,
+	241, 233, 224, 216, 208, 200, 192, 185,
+	177, 170, 163, 156, 149, 142, 136, 129,
+	123, 117, 111, 105, 100, 94, 89, 84,
+	79, 74, 69, 65, 60, 56, 52, 48,
+	44, 41, 37, 34, 31, 28, 25, 22,
+	20, 17, 15, 13, 11, 9, 8, 6,
+	5, 4, 3, 2, 1, 1, 0, 0,
+};
+
+// W^k = cos(2 pi k / 2048) - j sin(2 pi k / 2048), interleaved {re, im}, Q15
+const int16_t dsp_fft_twiddle[2048] = {
+	32767, 0, 32767, -101, 32767, -201, 32767, -302,
+	32766, -402, 32764, -503, 32762, -603, 32760, -704,
+	32758, -804, 32756, -905, 32753, -1005, 32749, -1106,
+	32746, -1206, 32742, -1307, 32738, -1407, 32733, -1507,
+	32729, -1608, 32723, -1708, 32718, -1809, 32712, -1909,
+	32706, -2009, 32700, -2110, 32693, -2210, 32686, -2310,
+	32679, -2411, 32672, -2511, 32664, -2611, 32656, -2711,
+	32647, -2811, 32638, -2912, 32629, -3012, 32620, -3112,
+	32610, -3212, 32600, -3312, 32590, -3412, 32579, -3512,
+	32568, -3612, 32557, -3712, 32546, -3812, 32534, -3911,
+	32522, -4011, 32509, -4111, 32496, -4211, 32483, -4310,
+	32470, -4410, 32456, -4510, 32442, -4609, 32428, -4709,
+	32413, -4808, 32398, -4907, 32383, -5007, 32368, -5106,
+	32352, -5205, 32336, -5305, 32319, -5404, 32303, -5503,
+	32286, -5602, 32268, -5701, 32251, -5800, 32233, -5899,
+	32214, -5998, 32196, -6097, 32177, -6195, 32158, -6294,
+	32138, -6393, 32119, -6491, 32099, -6590, 32078, -6688,
+	32058, -6787, 32037, -6885, 32015, -6983, 31994, -7081,
+	31972, -7180, 31950, -7278, 31927, -7376, 31904, -7473,
+	31881, -7571, 31858, -7669, 31834, -7767, 31810, -7864,
+	31786, -7962, 31761, -8059, 31737, -8157, 31711, -8254,
+	31686, -8351, 31660, -8449, 31634, -8546, 31608, -8643,
+	31581, -8740, 31554, -8836, 31527, -8933, 31499, -9030,
+	31471, -9127, 31443, -9223, 31415, -9319, 31386, -9416,
+	31357, -9512, 31328, -9608, 31298, -9704, 31268, -9800,
+	31238, -9896, 31207, -9992, 31177, -10088, 31146, -10183,
+	31114, -10279, 31082, -10374, 31050, -10469, 31018, -10565,
+	30986, -10660, 30953, -10755, 30920, -10850, 30886, -10945,
+	30853, -11039, 30819, -11134, 30784, -11228, 30750, -11323,
+	30715, -11417, 30680, -11511, 30644, -11605, 30608, -11699,
+	30572, -11793, 30536, -11887, 30499, -11980, 30462, -12074,
+	30425, -12167, 30388, -12261, 30350, -12354, 30312, -12447,
+	30274, -12540, 30235, -12633, 30196, -12725, 30157, -12818,
+	30118, -12910, 30078, -13003, 30038, -13095, 29997, -13187,
+	29957, -13279, 29916, -13371, 29875, -13463, 29833, -13554,
+	29792, -13646, 29750, -13737, 29707, -13828, 29665, -13919,
+	29622, -14010, 29579, -14101, 29535, -14192, 29492, -14282,
+	29448, -14373, 29404, -14463, 29359, -14553, 29314, -14643,
+	29269, -14733, 29224, -14823, 29178, -14912, 29132, -15002,
+	29086, -15091, 29040, -15180, 28993, -15269, 28946, -15358,
+	28899, -15447, 28851, -15535, 28803, -15624, 28755, -15712,
+	28707, -15800, 28658, -15888, 28610, -15976, 28560, -16064,
+	28511, -16151, 28461, -16239, 28411, -16326, 28361, -16413,
+	28311, -16500, 28260, -16587, 28209, -16673, 28158, -16760,
+	28106, -16846, 28054, -16932, 28002, -17018, 27950, -17104,
+	27897, -17190, 27844, -17275, 27791, -17361, 27738, -17446,
+	27684, -17531, 27630, -17616, 27576, -17700, 27522, -17785,
+	27467, -17869, 27412, -17953, 27357, -18037, 27301, -18121,
+	27246, -18205, 27190, -18288, 27133, -18372, 27077, -18455,
+	27020, -18538, 26963, -18621, 26906, -18703, 26848, -18786,
+	26791, -18868, 26733, -18950, 26674, -19032, 26616, -19114,
+	26557, -19195, 26498, -19277, 26439, -19358, 26379, -19439,
+	26320, -19520, 26259, -19601, 26199, -19681, 26139, -19761,
+	26078, -19841, 26017, -19921, 25956, -20001, 25894, -20081,
+	25833, -20160, 25771, -20239, 25708, -20318, 25646, -20397,
+	25583, -20475, 25520, -20554, 25457, -20632, 25394, -20710,
+	25330, -20788, 25266, -20865, 25202, -20943, 25138, -21020,
+	25073, -21097, 25008, -21174, 24943, -21251, 24878, -21327,
+	24812, -21403, 24746, -21479, 24680, -21555, 24614, -21631,
+	24548, -21706, 24481, -21781, 24414, -21856, 24347, -21931,
+	24279, -22006, 24212, -22080, 24144, -22154, 24076, -22228,
+	24008, -22302, 23939, -22375, 23870, -22449, 23801, -22522,
+	23732, -22595, 23663, -22668, 23593, -22740, 23523, -22812,
+	23453, -22884, 23383, -22956, 23312, -23028, 23241, -23099,
+	23170, -23170, 23099, -23241, 23028, -23312, 22956, -23383,
+	22884, -23453, 22812, -23523, 22740, -23593, 22668, -23663,
+	22595, -23732, 22522, -23801, 22449, -23870, 22375, -23939,
+	22302, -24008, 22228, -24076, 22154, -24144, 22080, -24212,
+	22006, -24279, 21931, -24347, 21856, -24414, 21781, -24481,
+	21706, -24548, 21631, -24614, 21555, -24680, 21479, -24746,
+	21403, -24812, 21327, -24878, 21251, -24943, 21174, -25008,
+	21097, -25073, 21020, -25138, 20943, -25202, 20865, -25266,
+	20788, -25330, 20710, -25394, 20632, -25457, 20554, -25520,
+	20475, -25583, 20397, -25646, 20318, -25708, 20239, -25771,
+	20160, -25833, 20081, -25894, 20001, -25956, 19921, -26017,
+	19841, -26078, 19761, -26139, 19681, -26199, 19601, -26259,
+	19520, -26320, 19439, -26379, 19358, -26439, 19277, -26498,
+	19195, -26557, 19114, -26616, 19032, -26674, 18950, -26733,
+	18868, -26791, 18786, -26848, 18703, -26906, 18621, -26963,
+	18538, -27020, 18455, -27077, 18372, -27133, 18288, -27190,
+	18205, -27246, 18121, -27301, 18037, -27357, 17953, -27412,
+	17869, -27467, 17785, -27522, 17700, -27576, 17616, -27630,
+	17531, -27684, 17446, -27738, 17361, -27791, 17275, -27844,
+	17190, -27897, 17104, -27950, 17018, -28002, 16932, -28054,
+	16846, -28106, 16760, -28158, 16673, -28209, 16587, -28260,
+	16500, -28311, 16413, -28361, 16326, -28411, 16239, -28461,
+	16151, -28511, 16064, -28560, 15976, -28610, 15888, -28658,
+	15800, -28707, 15712, -28755, 15624, -28803, 15535, -28851,
+	15447, -28899, 15358, -28946, 15269, -28993, 15180, -29040,
+	15091, -29086, 15002, -29132, 14912, -29178, 14823, -29224,
+	14733, -29269, 14643, -29314, 14553, -29359, 14463, -29404,
+	14373, -29448, 14282, -29492, 14192, -29535, 14101, -29579,
+	14010, -29622, 13919, -29665, 13828, -29707, 13737, -29750,
+	13646, -29792, 13554, -29833, 13463, -29875, 13371, -29916,
+	13279, -29957, 13187, -29997, 13095, -30038, 13003, -30078,
+	12910, -30118, 12818, -30157, 12725, -30196, 12633, -30235,
+	12540, -30274, 12447, -30312, 12354, -30350, 12261, -30388,
+	12167, -30425, 12074, -30462, 11980, -30499, 11887, -30536,
+	11793, -30572, 11699, -30608, 11605, -30644, 11511, -30680,
+	11417, -30715, 11323, -30750, 11228, -30784, 11134, -30819,
+	11039, -30853, 10945, -30886, 10850, -30920, 10755, -30953,
+	10660, -30986, 10565, -31018, 10469, -31050, 10374, -31082,
+	10279, -31114, 10183, -31146, 10088, -31177, 9992, -31207,
+	9896, -31238, 9800, -31268, 9704, -31298, 9608, -31328,
+	9512, -31357, 9416, -31386, 9319, -31415, 9223, -31443,
+	9127, -31471, 9030, -31499, 8933, -31527, 8836, -31554,
+	8740, -31581, 8643, -31608, 8546, -31634, 8449, -31660,
+	8351, -31686, 8254, -31711, 8157, -31737, 8059, -31761,
+	7962, -31786, 7864, -31810, 7767, -31834, 7669, -31858,
+	7571, -31881, 7473, -31904, 7376, -31927, 7278, -31950,
+	7180, -31972, 7081, -31994, 6983, -32015, 6885, -32037,
+	6787, -32058, 6688, -32078, 6590, -32099, 6491, -32119,
+	6393, -32138, 6294, -32158, 6195, -32177, 6097, -32196,
+	5998, -32214, 5899, -32233, 5800, -32251, 5701, -32268,
+	5602, -32286, 5503, -32303, 5404, -32319, 5305, -32336,
+	5205, -32352, 5106, -32368, 5007, -32383, 4907, -32398,
+	4808, -32413, 4709, -32428, 4609, -32442, 4510, -32456,
+	4410, -32470, 4310, -32483, 4211, -32496, 4111, -32509,
+	4011, -32522, 3911, -32534, 3812, -32546, 3712, -32557,
+	3612, -32568, 3512, -32579, 3412, -32590, 3312, -32600,
+	3212, -32610, 3112, -32620, 3012, -32629, 2912, -32638,
+	2811, -32647, 2711, -32656, 2611, -32664, 2511, -32672,
+	2411, -32679, 2310, -32686, 2210, -32693, 2110, -32700,
+	2009, -32706, 1909, -32712, 1809, -32718, 1708, -32723,
+	1608, -32729, 1507, -32733, 1407, -32738, 1307, -32742,
+	1206, -32746, 1106, -32749, 1005, -32753, 905, -32756,
+	804, -32758, 704, -32760, 603, -32762, 503, -32764,
+	402, -32766, 302, -32767, 201, -32767, 101, -32768,
+	0, -32768, -101, -32768, -201, -32767, -302, -32767,
+	-402, -32766, -503, -32764, -603, -32762, -704, -32760,
+	-804, -32758, -905, -32756, -1005, -32753, -1106, -32749,
+	-1206, -32746, -1307, -32742, -1407, -32738, -1507, -32733,
+	-1608, -32729, -1708, -32723, -1809, -32718, -1909, -32712,
+	-2009, -32706, -2110, -32700, -2210, -32693, -2310, -32686,
+	-2411, -32679, -2511, -32672, -2611, -32664, -2711, -32656,
+	-2811, -32647, -2912, -32638, -3012, -32629, -3112, -32620,
+	-3212, -32610, -3312, -32600, -3412, -32590, -3512, -32579,
+	-3612, -32568, -3712, -32557, -3812, -32546, -3911, -32534,
+	-4011, -32522, -4111, -32509, -4211, -32496, -4310, -32483,
+	-4410, -32470, -4510, -32456, -4609, -32442, -4709, -32428,
+	-4808, -32413, -4907, -32398, -5007, -32383, -5106, -32368,
+	-5205, -32352, -5305, -32336, -5404, -32319, -5503, -32303,
+	-5602, -32286, -5701, -32268, -5800, -32251, -5899, -32233,
+	-5998, -32214, -6097, -32196, -6195, -32177, -6294, -32158,
+	-6393, -32138, -6491, -32119, -6590, -32099, -6688, -32078,
+	-6787, -32058, -6885, -32037, -6983, -32015, -7081, -31994,
+	-7180, -31972, -7278, -31950, -7376, -31927, -7473, -31904,
+	-7571, -31881, -7669, -31858, -7767, -31834, -7864, -31810,
+	-7962, -31786, -8059, -31761, -8157, -31737, -8254, -31711,
+	-8351, -31686, -8449, -31660, -8546, -31634, -8643, -31608,
+	-8740, -31581, -8836, -31554, -8933, -31527, -9030, -31499,
+	-9127, -31471, -9223, -31443, -9319, -31415, -9416, -31386,
+	-9512, -31357, -9608, -31328, -9704, -31298, -9800, -31268,
+	-9896, -31238, -9992, -31207, -10088, -31177, -10183, -31146,
+	-10279, -31114, -10374, -31082, -10469, -31050, -10565, -31018,
+	-10660, -30986, -10755, -30953, -10850, -30920, -10945, -30886,
+	-11039, -30853, -11134, -30819, -11228, -30784, -11323, -30750,
+	-11417, -30715, -11511, -30680, -11605, -30644, -11699, -30608,
+	-11793, -30572, -11887, -30536, -11980, -30499, -12074, -30462,
+	-12167, -30425, -12261, -30388, -12354, -30350, -12447, -30312,
+	-12540, -30274, -12633, -30235, -12725, -30196, -12818, -30157,
+	-12910, -30118, -13003, -30078, -13095, -30038, -13187, -29997,
+	-13279, -29957, -13371, -29916, -13463, -29875, -13554, -29833,
+	-13646, -29792, -13737, -29750, -13828, -29707, -13919, -29665,
+	-14010, -29622, -14101, -29579, -14192, -29535, -14282, -29492,
+	-14373, -29448, -14463, -29404, -14553, -29359, -14643, -29314,
+	-14733, -29269, -14823, -29224, -14912, -29178, -15002, -29132,
+	-15091, -29086, -15180, -29040, -15269, -28993, -15358, -28946,
+	-15447, -28899, -15535, -28851, -15624, -28803, -15712, -28755,
+	-15800, -28707, -15888, -28658, -15976, -28610, -16064, -28560,
+	-16151, -28511, -16239, -28461, -16326, -28411, -16413, -28361,
+	-16500, -28311, -16587, -28260, -16673, -28209, -16760, -28158,
+	-16846, -28106, -16932, -28054, -17018, -28002, -17104, -27950,
+	-17190, -27897, -17275, -27844, -17361, -27791, -17446, -27738,
+	-17531, -27684, -17616, -27630, -17700, -27576, -17785, -27522,
+	-17869, -27467, -17953, -27412, -18037, -27357, -18121, -27301,
+	-18205, -27246, -18288, -27190, -18372, -27133, -18455, -27077,
+	-18538, -27020, -18621, -26963, -18703, -26906, -18786, -26848,
+	-18868, -26791, -18950, -26733, -19032, -26674, -19114, -26616,
+	-19195, -26557, -19277, -26498, -19358, -26439, -19439, -26379,
+	-19520, -26320, -19601, -26259, -19681, -26199, -19761, -26139,
+	-19841, -26078, -19921, -26017, -20001, -25956, -20081, -25894,
+	-20160, -25833, -20239, -25771, -20318, -25708, -20397, -25646,
+	-20475, -25583, -20554, -25520, -20632, -25457, -20710, -25394,
+	-20788, -25330, -20865, -25266, -20943, -25202, -21020, -25138,
+	-21097, -25073, -21174, -25008, -21251, -24943, -21327, -24878,
+	-21403, -24812, -21479, -24746, -21555, -24680, -21631, -24614,
+	-21706, -24548, -21781, -24481, -21856, -24414, -21931, -24347,
+	-22006, -24279, -22080, -24212, -22154, -24144, -22228, -24076,
+	-22302, -24008, -22375, -23939, -22449, -23870, -22522, -23801,
+	-22595, -23732, -22668, -23663, -22740, -23593, -22812, -23523,
+	-22884, -23453, -22956, -23383, -23028, -23312, -23099, -23241,
+	-23170, -23170, -23241, -23099, -23312, -23028, -23383, -22956,
+	-23453, -22884, -23523, -22812, -23593, -22740, -23663, -22668,
+	-23732, -22595, -23801, -22522, -23870, -22449, -23939, -22375,
+	-24008, -22302, -24076, -22228, -24144, -22154, -24212, -22080,
+	-24279, -22006, -24347, -21931, -24414, -21856, -24481, -21781,
+	-24548, -21706, -24614, -21631, -24680, -21555, -24746, -21479,
+	-24812, -21403, -24878, -21327, -24943, -21251, -25008, -21174,
+	-25073, -21097, -25138, -21020, -25202, -20943, -25266, -20865,
+	-25330, -20788, -25394, -20710, -25457, -20632, -25520, -20554,
+	-25583, -20475, -25646, -20397, -25708, -20318, -25771, -20239,
+	-25833, -20160, -25894, -20081, -25956, -20001, -26017, -19921,
+	-26078, -19841, -26139, -19761, -26199, -19681, -26259, -19601,
+	-26320, -19520, -26379, -19439, -26439, -19358, -26498, -19277,
+	-26557, -19195, -26616, -19114, -26674, -19032, -26733, -18950,
+	-26791, -18868, -26848, -18786, -26906, -18703, -26963, -18621,
+	-27020, -18538, -27077, -18455, -27133, -18372, -27190, -18288,
+	-27246, -18205, -27301, -18121, -27357, -18037, -27412, -17953,
+	-27467, -17869, -27522, -17785, -27576, -17700, -27630, -17616,
+	-27684, -17531, -27738, -17446, -27791, -17361, -27844, -17275,
+	-27897, -17190, -27950, -17104, -28002, -17018, -28054, -16932,
+	-28106, -16846, -28158, -16760, -28209, -16673, -28260, -16587,
+	-28311, -16500, -28361, -16413, -28411, -16326, -28461, -16239,
+	-28511, -16151, -28560, -16064, -28610, -15976, -28658, -15888,
+	-28707, -15800, -28755, -15712, -28803, -15624, -28851, -15535,
+	-28899, -15447, -28946, -15358, -28993, -15269, -29040, -15180,
+	-29086, -15091, -29132, -15002, -29178, -14912, -29224, -14823,
+	-29269, -14733, -29314, -14643, -29359, -14553, -29404, -14463,
+	-29448, -14373, -29492, -14282, -29535, -14192, -29579, -14101,
+	-29622, -14010, -29665, -13919, -29707, -13828, -29750, -13737,
+	-29792, -13646, -29833, -13554, -29875, -13463, -29916, -13371,
+	-29957, -13279, -29997, -13187, -30038, -13095, -30078, -13003,
+	-30118, -12910, -30157, -12818, -30196, -12725, -30235, -12633,
+	-30274, -12540, -30312, -12447, -30350, -12354, -30388, -12261,
+	-30425, -12167, -30462, -12074, -30499, -11980, -30536, -11887,
+	-30572, -11793, -30608, -11699, -30644, -11605, -30680, -11511,
+	-30715, -11417, -30750, -11323, -30784, -11228, -30819, -11134,
+	-30853, -11039, -30886, -10945, -30920, -10850, -30953, -10755,
+	-30986, -10660, -31018, -10565, -31050, -10469, -31082, -10374,
+	-31114, -10279, -31146, -10183, -31177, -10088, -31207, -9992,
+	-31238, -9896, -31268, -9800, -31298, -9704, -31328, -9608,
+	-31357, -9512, -31386, -9416, -31415, -9319, -31443, -9223,
+	-31471, -9127, -31499, -9030, -31527, -8933, -31554, -8836,
+	-31581, -8740, -31608, -8643, -31634, -8546, -31660, -8449,
+	-31686, -8351, -31711, -8254, -31737, -8157, -31761, -8059,
+	-31786, -7962, -31810, -7864, -31834, -7767, -31858, -7669,
+	-31881, -7571, -31904, -7473, -31927, -7376, -31950, -7278,
+	-31972, -7180, -31994, -7081, -32015, -6983, -32037, -6885,
+	-32058, -6787, -32078, -6688, -32099, -6590, -32119, -6491,
+	-32138, -6393, -32158, -6294, -32177, -6195, -32196, -6097,
+	-32214, -5998, -32233, -5899, -32251, -5800, -32268, -5701,
+	-32286, -5602, -32303, -5503, -32319, -5404, -32336, -5305,
+	-32352, -5205, -32368, -5106, -32383, -5007, -32398, -4907,
+	-32413, -4808, -32428, -4709, -32442, -4609, -32456, -4510,
+	-32470, -4410, -32483, -4310, -32496, -4211, -32509, -4111,
+	-32522, -4011, -32534, -3911, -32546, -3812, -32557, -3712,
+	-32568, -3612, -32579, -3512, -32590, -3412, -32600, -3312,
+	-32610, -3212, -32620, -3112, -32629, -3012, -32638, -2912,
+	-32647, -2811, -32656, -2711, -32664, -2611, -32672, -2511,
+	-32679, -2411, -32686, -2310, -32693, -2210, -32700, -2110,
+	-32706, -2009, -32712, -1909, -32718, -1809, -32723, -1708,
+	-32729, -1608, -32733, -1507, -32738, -1407, -32742, -1307,
+	-32746, -1206, -32749, -1106, -32753, -1005, -32756, -905,
+	-32758, -804, -32760, -704, -32762, -603, -32764, -503,
+	-32766, -402, -32767, -302, -32767, -201, -32768, -101,
+};
+
+// 6th-order Butterworth low-pass at 0.18 fs
+const float dsp_oct_lp[15] = {
+	1.532075746e-01f, 3.064151493e-01f, 1.532075746e-01f, -4.544079420e-01f, 6.723824059e-02f,
+	1.750876437e-01f, 3.501752873e-01f, 1.750876437e-01f, -5.193034092e-01f, 2.196539839e-01f,
+	2.326312598e-01f, 4.652625196e-01f, 2.326312598e-01f, -6.899756247e-01f, 6.205006639e-01f,
+};
+
+// 6th-order Butterworth octave band-pass centred at fs / 5
+const float dsp_oct_band[15] = {
+	3.982097567e-01f, 0.000000000e+00f, -3.982097567e-01f, 2.565911978e-01f, 6.352957089e-01f,
+	3.225069418e-01f, 0.000000000e+00f, -3.225069418e-01f, -3.536987524e-01f, 3.549861163e-01f,
+	3.342220906e-01f, 0.000000000e+00f, -3.342220906e-01f, -1.015803389e+00f, 6.938994373e-01f,
+};
+
+// 6th-order Butterworth 1/3-octave band-passes at fs / 5 * 2^(-1/3, 0, 1/3)
+const float dsp_oct_third[45] = {
+	1.159914513e-01f, 0.000000000e+00f, -1.159914513e-01f, -8.492932836e-01f, 8.848303936e-01f,
+	1.039394119e-01f, 0.000000000e+00f, -1.039394119e-01f, -9.686133758e-01f, 7.921211763e-01f,
+	1.027051853e-01f, 0.000000000e+00f, -1.027051853e-01f, -1.175872197e+00f, 8.980225211e-01f,
+	1.407789251e-01f, 0.000000000e+00f, -1.407789251e-01f, -3.330651580e-01f, 8.604609390e-01f,
+	1.278037551e-01f, 0.000000000e+00f, -1.278037551e-01f, -5.307083257e-01f, 7.443924897e-01f,
+	1.305802412e-01f, 0.000000000e+00f, -1.305802412e-01f, -7.851751766e-01f, 8.705698014e-01f,
+	1.672907016e-01f, 0.000000000e+00f, -1.672907016e-01f, 3.338965382e-01f, 8.348434026e-01f,
+	1.563987658e-01f, 0.000000000e+00f, -1.563987658e-01f, 3.953886115e-02f, 6.872024685e-01f,
+	1.684395960e-01f, 0.000000000e+00f, -1.684395960e-01f, -2.499233781e-01f, 8.337091645e-01f,
+};
+
+// A-weighting at 20000 Hz, 0 dB at 1 kHz
+const float dsp_weight_a[15] = {
+	1.030666985e+00f, -2.061333970e+00f, 1.030666985e+00f, -1.987099012e+00f, 9.871406208e-01f,
+	8.812334431e-01f, -1.762466886e+00f, 8.812334431e-01f, -1.759012581e+00f, 7.659211915e-01f,
+	1.000000000e+00f, 2.015422390e-01f, 1.015481852e-02f, 0.000000000e+00f, 0.000000000e+00f,
+};
+
+// C-weighting at 20000 Hz, 0 dB at 1 kHz
+const float dsp_weight_c[10] = {
+	8.270489139e-01f, -1.654097828e+00f, 8.270489139e-01f, -1.987099012e+00f, 9.871406208e-01f,
+	1.000000000e+00f, 2.015422390e-01f, 1.015481852e-02f, 0.000000000e+00f, 0.000000000e+00f,
+};
+
+// Kaiser-windowed sinc, pass 0.10 / stop 0.15 fs, 70 dB, polyphase order [phase][tap]
+const int16_t dsp_decim_coef[96] = {
+	-1, 3, -7, 14, -27, 46, -75, 118,
+	-183, 288, -492, 1121, 7981, -863, 425, -256,
+	164, -106, 67, -41, 23, -12, 6, -2,
+	-2, 8, -20, 41, -75, 127, -204, 319,
+	-494, 787, -1398, 3822, 6405, -1680, 895, -552,
+	356, -229, 144, -86, 48, -25, 11, -3,
+	-3, 11, -25, 48, -86, 144, -229, 356,
+	-552, 895, -1680, 6405, 3822, -1398, 787, -494,
+	319, -204, 127, -75, 41, -20, 8, -2,
+	-2, 6, -12, 23, -41, 67, -106, 164,
+	-256, 425, -863, 7981, 1121, -492, 288, -183,
+	118, -75, 46, -27, 14, -7, 3, -1,
+};
+
+// inverse sinc^4 (R = 30) to 0.18 fs, stop from 0.28 fs, Kaiser 60 dB, unity DC gain
+const float dsp_ovs_fir[48] = {
+	-3.745721355e-06f, -1.071531562e-05f, 3.159151619e-05f, 8.739922199e-05f, -5.954189638e-05f,
+	-2.579957988e-04f, 7.327556829e-06f, 3.782589499e-04f, 1.118368591e-04f, -5.907707047e-06f,
+	2.032994296e-04f, -1.425967023e-03f, -2.427280179e-03f, 3.911722320e-03f, 9.200128843e-03f,
+	-5.708477899e-03f, -2.394658645e-02f, 1.901505609e-03f, 5.033358715e-02f, 1.838190645e-02f,
+	-9.352259515e-02f, -8.755024130e-02f, 1.678083129e-01f, 4.625621777e-01f, 4.625621777e-01f,
+	1.678083129e-01f, -8.755024130e-02f, -9.352259515e-02f, 1.838190645e-02f, 5.033358715e-02f,
+	1.901505609e-03f, -2.394658645e-02f, -5.708477899e-03f, 9.200128843e-03f, 3.911722320e-03f,
+	-2.427280179e-03f, -1.425967023e-03f, 2.032994296e-04f, -5.907707047e-06f, 1.118368591e-04f,
+	3.782589499e-04f, 7.327556829e-06f, -2.579957988e-04f, -5.954189638e-05f, 8.739922199e-05f,
+	3.159151619e-05f, -1.071531562e-05f, -3.745721355e-06f,
+};
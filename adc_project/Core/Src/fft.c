@@ -0,0 +1,351 @@
+/**
+ * fft.c
+ * ------
+ * Fixed-point spectrum analyzer on the ADC block stream.
+ *
+ * Every 'period' display ticks one frame of 'points' samples is
+ * collected from the ADC bottom half, then transformed in the main
+ * loop (never in an ISR):
+ *
+ *   - mid-rail removal, scale to Q15 with one bit of headroom,
+ *     periodic Hann window
+ *   - N-point real FFT computed as an N/2-point complex radix-2 FFT
+ *     (scaled by 1/2 per stage, no overflow) plus a split step
+ *   - magnitude squared per bin, bins 0 .. N/2-1
+ *
+ * Window and twiddle tables are generated by tools/gen_tables.py for
+ * the largest size and strided for smaller ones.
+ **/
+
+#include "fft.h"
+#include "uart.h"
+#include "adc.h"
+#include "perf.h"
+#include "dbfs.h"
+#include "dsp_tables.h"
+#include "timer.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// 100 * log10(2) deci-dB per octave of power, Q16
+#define FFT_DB10_PER_OCTAVE_Q16 1972830
+
+// initialize global FFT_Handle_t instance
+FFT_Handle_t fft;
+
+// ASCII spectrum levels, quietest first
+static const char fft_levels[] = " .:-=+*#%@";
+
+/**
+  * @brief  Initialize the spectrum analyzer
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  points Transform size (see fft_set_points)
+  * @param  period Display ticks between spectra, 0 disables it
+  * @retval Void
+**/
+void fft_init(FFT_Handle_t* fft, uint16_t points, uint16_t period) {
+
+	// initialize software state
+	fft->period = period;
+	fft->ticks = 0;
+	fft->output = FFT_OUTPUT_ASCII;
+	fft->seq = 0;
+	fft->frames = 0;
+	fft->cycles = 0;
+	fft_set_points(fft, points);
+}
+
+/**
+  * @brief  Change the transform size
+  * @note   Rounded down to a power of two and clamped to
+  *         FFT_POINTS_MIN..FFT_POINTS_MAX; restarts the frame
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  points Requested transform size
+  * @retval Void
+**/
+void fft_set_points(FFT_Handle_t* fft, uint16_t points) {
+
+	if (points < FFT_POINTS_MIN) {
+		points = FFT_POINTS_MIN;
+	} else if (points > FFT_POINTS_MAX) {
+		points = FFT_POINTS_MAX;
+	}
+
+	// keep the leading one only
+	fft->points = (uint16_t)(1UL << (31 - __builtin_clz(points)));
+
+	// drop any partial frame; the collector is idle until the next period
+	fft->state = FFT_IDLE;
+	fft->fill = 0;
+}
+
+/**
+  * @brief  Copy ADC samples into the frame being collected
+  * @note   Called from the ADC bottom half; no-op unless collecting
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void fft_collect(FFT_Handle_t* fft, const uint16_t* blk, uint32_t len) {
+
+	if (fft->state != FFT_COLLECTING) {
+		return;
+	}
+
+	uint32_t n = fft->points - fft->fill;
+	if (len < n) {
+		n = len;
+	}
+
+	// mid-rail removed, 12 -> 15 bits (+-16384, one bit of FFT headroom)
+	int16_t* dst = &fft->buf[fft->fill];
+	for (uint32_t i = 0; i < n; i++) {
+		dst[i] = (int16_t)(((int32_t)blk[i] - ADC_MIDRAIL) << 3);
+	}
+
+	fft->fill += n;
+	if (fft->fill >= fft->points) {
+		fft->stamp = adc.stamp - (len - n) * TIMER_STAMP_PER_SAMPLE;
+		fft->state = FFT_READY;
+	}
+}
+
+/**
+  * @brief  In-place complex radix-2 FFT, scaled by 1/2 per stage
+  * @param  *z Interleaved {re, im} Q15 data, bit-reversal applied here
+  * @param  m Number of complex points (power of two)
+  * @retval Void
+**/
+static void fft_cfft_q15(int16_t* z, uint32_t m) {
+
+	// bit-reversal permutation
+	uint32_t j = 0;
+	for (uint32_t i = 0; i < m; i++) {
+		if (i < j) {
+			int16_t tr = z[2 * i];
+			int16_t ti = z[2 * i + 1];
+			z[2 * i] = z[2 * j];
+			z[2 * i + 1] = z[2 * j + 1];
+			z[2 * j] = tr;
+			z[2 * j + 1] = ti;
+		}
+		uint32_t bit = m >> 1;
+		while (j & bit) {
+			j ^= bit;
+			bit >>= 1;
+		}
+		j |= bit;
+	}
+
+	// butterflies; W_len^k is entry k * (FFT_POINTS_MAX / len) of the table
+	for (uint32_t len = 2; len <= m; len <<= 1) {
+		uint32_t half = len >> 1;
+		uint32_t stride = FFT_POINTS_MAX / len;
+
+		for (uint32_t k = 0; k < half; k++) {
+			int32_t wr = dsp_fft_twiddle[2 * k * stride];
+			int32_t wi = dsp_fft_twiddle[2 * k * stride + 1];
+
+			for (uint32_t s = k; s < m; s += len) {
+				int16_t* a = &z[2 * s];
+				int16_t* b = &z[2 * (s + half)];
+
+				// t = b * W (Q15), rounded; halving each stage keeps the result in range
+				int32_t tr = ((int32_t)b[0] * wr - (int32_t)b[1] * wi + (1 << 14)) >> 15;
+				int32_t ti = ((int32_t)b[0] * wi + (int32_t)b[1] * wr + (1 << 14)) >> 15;
+
+				int32_t ar = a[0];
+				int32_t ai = a[1];
+				a[0] = (int16_t)((ar + tr + 1) >> 1);
+				a[1] = (int16_t)((ai + ti + 1) >> 1);
+				b[0] = (int16_t)((ar - tr + 1) >> 1);
+				b[1] = (int16_t)((ai - ti + 1) >> 1);
+			}
+		}
+	}
+}
+
+/**
+  * @brief  Window, transform and take magnitude squared of a frame in place
+  * @param  *buf N Q15 samples in, complex work area out
+  * @param  *mag N/2 magnitude squared bins out
+  * @param  points Transform size N (power of two, FFT_POINTS_MIN..FFT_POINTS_MAX)
+  * @retval Void
+**/
+void fft_real_q15(int16_t* buf, uint32_t* mag, uint16_t points) {
+
+	uint32_t stride = FFT_POINTS_MAX / points;
+	uint32_t m = points >> 1;
+
+	// Hann window (strided from the largest table)
+	for (uint32_t i = 0; i < points; i++) {
+		buf[i] = (int16_t)(((int32_t)buf[i] * dsp_fft_hann[i * stride]) >> 15);
+	}
+
+	// even / odd samples as re / im of an N/2-point complex sequence
+	fft_cfft_q15(buf, m);
+
+	// split: X[k] = E[k] + W_N^k O[k], E / O recovered from Z[k] and Z[N/2 - k]
+	for (uint32_t k = 0; k < m; k++) {
+		uint32_t c = (m - k) & (m - 1);
+		int32_t zr = buf[2 * k];
+		int32_t zi = buf[2 * k + 1];
+		int32_t cr = buf[2 * c];
+		int32_t ci = buf[2 * c + 1];
+
+		int32_t e_r = (zr + cr) >> 1;
+		int32_t e_i = (zi - ci) >> 1;
+		int32_t o_r = (zr - cr) >> 1;
+		int32_t o_i = (zi + ci) >> 1;
+
+		int32_t wr = dsp_fft_twiddle[2 * k * stride];
+		int32_t wi = dsp_fft_twiddle[2 * k * stride + 1];
+
+		// X = E - j (W O)
+		int32_t xr = e_r + ((wr * o_i + wi * o_r) >> 15);
+		int32_t xi = e_i - ((wr * o_r - wi * o_i) >> 15);
+
+		mag[k] = (uint32_t)(xr * xr) + (uint32_t)(xi * xi);
+	}
+}
+
+/**
+  * @brief  Convert a magnitude squared bin to deci-dB relative to full scale
+  * @param  mag2 Magnitude squared
+  * @retval Level in deci-dB, at least FFT_DB_MIN
+**/
+int32_t fft_bin_db(uint32_t mag2) {
+
+	if (mag2 == 0) {
+		return FFT_DB_MIN;
+	}
+
+	int32_t l2 = dbfs_log2_q16(mag2) - (FFT_FULL_SCALE_LOG2 << 16);
+	int32_t db = (int32_t)(((int64_t)l2 * FFT_DB10_PER_OCTAVE_Q16 + (1LL << 31)) >> 32);
+	return (db < FFT_DB_MIN) ? FFT_DB_MIN : db;
+}
+
+/**
+  * @brief  Level of one output band: peak bin of the group
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  band Band index (0..FFT_BANDS-1)
+  * @retval Level in deci-dB
+**/
+static int32_t fft_band_db(FFT_Handle_t* fft, uint32_t band) {
+
+	uint32_t per_band = (fft->points / 2) / FFT_BANDS;
+	const uint32_t* bin = &fft->mag[band * per_band];
+
+	uint32_t peak = 0;
+	for (uint32_t i = 0; i < per_band; i++) {
+		if (bin[i] > peak) {
+			peak = bin[i];
+		}
+	}
+	return fft_bin_db(peak);
+}
+
+/**
+  * @brief  Send the spectrum as one ASCII line
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+static void fft_send_ascii(FFT_Handle_t* fft, UART_Handle_t* uart) {
+
+	char line[FFT_BANDS + 16];
+	uint32_t n = 0;
+	line[n++] = '\r';
+	line[n++] = '\n';
+	line[n++] = 'f';
+	line[n++] = 'f';
+	line[n++] = 't';
+	line[n++] = ' ';
+
+	for (uint32_t b = 0; b < FFT_BANDS; b++) {
+		int32_t level = (fft_band_db(fft, b) - FFT_ASCII_DB_MIN) * (int32_t)(sizeof(fft_levels) - 1) / -FFT_ASCII_DB_MIN;
+		if (level < 0) {
+			level = 0;
+		} else if (level > (int32_t)sizeof(fft_levels) - 2) {
+			level = sizeof(fft_levels) - 2;
+		}
+		line[n++] = fft_levels[level];
+	}
+
+	line[n++] = '\r';
+	line[n++] = '\n';
+	line[n] = '\0';
+	uart_DMA_printf(uart, line);
+}
+
+/**
+  * @brief  Send the spectrum as one binary frame
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+static void fft_send_binary(FFT_Handle_t* fft, UART_Handle_t* uart) {
+
+	uint8_t frame[FFT_BANDS + 10];
+	uint32_t n = 0;
+	frame[n++] = FFT_FRAME_SYNC0;
+	frame[n++] = FFT_FRAME_SYNC1;
+	frame[n++] = (uint8_t)(31 - __builtin_clz(fft->points));
+	frame[n++] = FFT_BANDS;
+	frame[n++] = fft->seq++;
+	frame[n++] = (uint8_t)fft->stamp;
+	frame[n++] = (uint8_t)(fft->stamp >> 8);
+	frame[n++] = (uint8_t)(fft->stamp >> 16);
+	frame[n++] = (uint8_t)(fft->stamp >> 24);
+
+	// 0.5 dB per LSB above FFT_DB_MIN
+	for (uint32_t b = 0; b < FFT_BANDS; b++) {
+		int32_t level = (fft_band_db(fft, b) - FFT_DB_MIN) / 5;
+		frame[n++] = (uint8_t)((level > 255) ? 255 : level);
+	}
+
+	uint8_t x = 0;
+	for (uint32_t i = 2; i < n; i++) {
+		x ^= frame[i];
+	}
+	frame[n++] = x;
+
+	uart_DMA_write(uart, frame, (uint16_t)n);
+}
+
+/**
+  * @brief  Count a display tick, start / finish / send a spectrum
+  * @note   Call on every display tick from the main loop
+  * @param  *fft Pointer to the FFT_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void fft_poll(FFT_Handle_t* fft, UART_Handle_t* uart) {
+
+	if (fft->period == 0) {
+		return;
+	}
+
+	// frame complete: transform in the main loop, then wait for the next period
+	if (fft->state == FFT_READY) {
+		uint32_t start = PERF_CYCLES();
+		fft_real_q15(fft->buf, fft->mag, fft->points);
+		fft->cycles = PERF_CYCLES() - start;
+		fft->frames++;
+
+		if (fft->output == FFT_OUTPUT_ASCII) {
+			fft_send_ascii(fft, uart);
+		} else if (fft->output == FFT_OUTPUT_BINARY) {
+			fft_send_binary(fft, uart);
+		}
+		fft->state = FFT_IDLE;
+	}
+
+	// period elapsed: arm the collector
+	if (++fft->ticks >= fft->period && fft->state == FFT_IDLE) {
+		fft->ticks = 0;
+		fft->fill = 0;
+		fft->state = FFT_COLLECTING;
+	}
+}
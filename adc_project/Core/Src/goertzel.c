@@ -0,0 +1,197 @@
+/**
+ * goertzel.c
+ * -----------
+ * Goertzel tone-detector bank.
+ *
+ * Every detector runs the second-order Goertzel recurrence over a
+ * common window; at the window end each magnitude is computed once
+ * and the states are cleared. State is a struct of arrays so one
+ * pass over an ADC block updates the whole bank.
+ *
+ * Threshold crossings (1/8 hysteresis) set event bits in the bottom
+ * half; 'goertzel_poll' reports them from the main loop.
+ **/
+
+#include "goertzel.h"
+#include "uart.h"
+#include "adc.h"
+#include "stm32f4xx.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <math.h>
+
+// initialize global GOERTZEL_Handle_t instance
+GOERTZEL_Handle_t goertzel;
+
+// default bank: mains hum (two grids, 5 harmonics each) and a pilot tone
+static const uint16_t goertzel_default_hz[] = {
+	50, 100, 150, 200, 250,
+	60, 120, 180, 240, 300,
+	1000
+};
+
+/**
+  * @brief  Initialize the bank with the default detectors
+  * @note   Mains 50 / 60 Hz with harmonics up to the 5th, 1 kHz pilot
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @param  sample_rate_hz Rate of the samples fed to the bank
+  * @param  window Samples per measurement window
+  * @retval Void
+**/
+void goertzel_init(GOERTZEL_Handle_t* g, uint32_t sample_rate_hz, uint16_t window) {
+
+	// initialize software state
+	g->sample_rate_hz = sample_rate_hz;
+	g->window = (window == 0) ? 1 : window;
+	g->windows = 0;
+	goertzel_clear(g);
+
+	for (uint32_t i = 0; i < sizeof(goertzel_default_hz) / sizeof(goertzel_default_hz[0]); i++) {
+		goertzel_add(g, goertzel_default_hz[i], GOERTZEL_THRESHOLD_DEFAULT);
+	}
+}
+
+/**
+  * @brief  Remove all detectors
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @retval Void
+**/
+void goertzel_clear(GOERTZEL_Handle_t* g) {
+
+	g->count = 0;
+	g->index = 0;
+	g->active = 0;
+	g->events = 0;
+}
+
+/**
+  * @brief  Add a detector to the bank
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @param  freq_hz Frequency to watch (below sample_rate_hz / 2)
+  * @param  threshold Event threshold, counts of sine amplitude
+  * @retval Detector index, or -1 if the bank is full or freq_hz is invalid
+**/
+int32_t goertzel_add(GOERTZEL_Handle_t* g, uint16_t freq_hz, uint16_t threshold) {
+
+	if (g->count >= GOERTZEL_MAX || freq_hz == 0 || 2U * freq_hz >= g->sample_rate_hz) {
+		return -1;
+	}
+
+	uint32_t d = g->count;
+	g->coef[d] = 2.0f * cosf(2.0f * (float)M_PI * (float)freq_hz / (float)g->sample_rate_hz);
+	g->s1[d] = 0.0f;
+	g->s2[d] = 0.0f;
+	g->freq_hz[d] = freq_hz;
+	g->threshold[d] = threshold;
+	g->mag[d] = 0;
+
+	// restart the window so every detector sees the same samples
+	g->index = 0;
+	for (uint32_t i = 0; i < d; i++) {
+		g->s1[i] = 0.0f;
+		g->s2[i] = 0.0f;
+	}
+
+	g->count = d + 1;
+	return (int32_t)d;
+}
+
+/**
+  * @brief  Window end: magnitudes, threshold events, state reset
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @retval Void
+**/
+static void goertzel_finish(GOERTZEL_Handle_t* g) {
+
+	// amplitude of a sine = 2 * |X| / N
+	float scale = 2.0f / (float)g->window;
+	uint32_t changed = 0;
+
+	for (uint32_t d = 0; d < g->count; d++) {
+		float s1 = g->s1[d];
+		float s2 = g->s2[d];
+		float power = s1 * s1 + s2 * s2 - g->coef[d] * s1 * s2;
+		if (power < 0.0f) {
+			power = 0.0f;
+		}
+		uint16_t mag = (uint16_t)(sqrtf(power) * scale);
+		g->mag[d] = mag;
+
+		// on at threshold, off below 7/8 of it
+		uint32_t bit = 1UL << d;
+		if (!(g->active & bit) && mag >= g->threshold[d]) {
+			g->active |= bit;
+			changed |= bit;
+		} else if ((g->active & bit) && mag < g->threshold[d] - (g->threshold[d] >> 3)) {
+			g->active &= ~bit;
+			changed |= bit;
+		}
+
+		g->s1[d] = 0.0f;
+		g->s2[d] = 0.0f;
+	}
+
+	// publish events (atomic OR, the main loop takes and clears them)
+	if (changed) {
+		uint32_t mask;
+		do {
+			mask = __LDREXW(&g->events);
+		} while (__STREXW(mask | changed, &g->events));
+	}
+
+	g->stamp = adc.stamp;
+	g->windows++;
+}
+
+/**
+  * @brief  Feed a block of raw ADC samples, finish windows as they fill
+  * @note   Called from the ADC bottom half
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void goertzel_process_block(GOERTZEL_Handle_t* g, const uint16_t* blk, uint32_t len) {
+
+	if (g->count == 0) {
+		return;
+	}
+
+	for (uint32_t i = 0; i < len; i++) {
+		goertzel_push(g, (float)((int32_t)blk[i] - ADC_MIDRAIL));
+		if (++g->index >= g->window) {
+			g->index = 0;
+			goertzel_finish(g);
+		}
+	}
+}
+
+/**
+  * @brief  Report threshold crossings over UART
+  * @note   Call from the main loop
+  * @param  *g Pointer to the GOERTZEL_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void goertzel_poll(GOERTZEL_Handle_t* g, UART_Handle_t* uart) {
+
+	// atomically take and clear the event mask
+	uint32_t events;
+	do {
+		events = __LDREXW(&g->events);
+	} while (__STREXW(0, &g->events));
+
+	for (uint32_t d = 0; events != 0; d++, events >>= 1) {
+		if (!(events & 1)) {
+			continue;
+		}
+		char line[64];
+		snprintf(line, sizeof(line), "\r\ntone f=%u %s mag=%u t=%lu\r\n",
+				(unsigned)g->freq_hz[d],
+				(g->active & (1UL << d)) ? "on" : "off",
+				(unsigned)g->mag[d],
+				(unsigned long)g->stamp);
+		uart_DMA_printf(uart, line);
+	}
+}
@@ -0,0 +1,178 @@
+/**
+ * housekeeping.c
+ * ---------------
+ * Supply and temperature housekeeping on ADC1 injected channels.
+ *
+ * One channel per conversion, in turn: Vrefint, temperature, VBAT.
+ * The sensor path (TSVREFE) stays on; VBATE is only set around the
+ * VBAT conversion, both because it takes over IN18 from the
+ * temperature sensor and because the bridge drains the battery.
+ **/
+
+#include "housekeeping.h"
+#include "adc.h"
+#include "timer.h"
+#include "stm32f4xx_ll_adc.h"
+#include "stm32f4xx.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// initialize global HK_Handle_t instance
+HK_Handle_t hk;
+
+/**
+  * @brief  Configure the injected group and internal channels
+  * @note   Call after 'adc_init' and 'timer_init'
+  * @param  *hk Pointer to the HK_Handle_t instance
+  * @param  period Display ticks between conversions, 0 disables housekeeping
+  * @retval Void
+**/
+void housekeeping_init(HK_Handle_t* hk, uint16_t period) {
+
+	// initialize software state
+	hk->period = period;
+	hk->ticks = 0;
+	hk->wait = 0;
+	hk->channel = HK_VBAT; // first conversion armed is Vrefint
+	hk->state = HK_IDLE;
+	hk->raw = 0;
+	for (uint32_t c = 0; c < HK_CHANNELS; c++) {
+		hk->raw_ch[c] = 0;
+	}
+	hk->vdda_mv = 0;
+	hk->temp_c10 = 0;
+	hk->vbat_mv = 0;
+	hk->conversions = 0;
+	hk->timeouts = 0;
+
+	// Vrefint + temperature sensor on (VBAT only around its conversion)
+	LL_ADC_SetCommonPathInternalCh(__LL_ADC_COMMON_INSTANCE(adc.Instance), LL_ADC_PATH_INTERNAL_TEMPSENSOR);
+	LL_ADC_SetChannelSamplingTime(adc.Instance, LL_ADC_CHANNEL_VREFINT, HK_SAMPLINGTIME);
+	LL_ADC_SetChannelSamplingTime(adc.Instance, LL_ADC_CHANNEL_TEMPSENSOR, HK_SAMPLINGTIME);
+
+	// single injected conversion on the TIM2 CC1 edge, edge left disabled
+	LL_ADC_INJ_StopConversionExtTrig(adc.Instance);
+	LL_ADC_INJ_SetTrigAuto(adc.Instance, LL_ADC_INJ_TRIG_INDEPENDENT);
+	LL_ADC_INJ_SetSequencerDiscont(adc.Instance, LL_ADC_INJ_SEQ_DISCONT_DISABLE);
+	LL_ADC_INJ_SetSequencerLength(adc.Instance, LL_ADC_INJ_SEQ_SCAN_DISABLE);
+	LL_ADC_INJ_SetTriggerSource(adc.Instance, LL_ADC_INJ_TRIG_EXT_TIM2_CH1);
+	LL_ADC_ClearFlag_JEOS(adc.Instance);
+	LL_ADC_EnableIT_JEOS(adc.Instance);
+}
+
+/**
+  * @brief  Convert the stored result into physical units
+  * @param  *hk Pointer to the HK_Handle_t instance
+  * @retval Void
+**/
+static void housekeeping_convert(HK_Handle_t* hk) {
+
+	uint32_t raw = hk->raw;
+	hk->raw_ch[hk->channel] = (uint16_t)raw;
+	hk->conversions++;
+
+	switch (hk->channel) {
+
+	case HK_VREFINT:
+		if (raw != 0) {
+			hk->vdda_mv = (uint16_t)__LL_ADC_CALC_VREFANALOG_VOLTAGE(raw, LL_ADC_RESOLUTION_12B);
+		}
+		break;
+
+	case HK_TEMP:
+		if (hk->vdda_mv != 0) {
+			// rescale to the 3.3 V calibration reference, then interpolate TS_CAL1 .. TS_CAL2
+			int32_t ts = (int32_t)((raw * hk->vdda_mv) / TEMPSENSOR_CAL_VREFANALOG);
+			int32_t cal1 = *TEMPSENSOR_CAL1_ADDR;
+			int32_t cal2 = *TEMPSENSOR_CAL2_ADDR;
+			hk->temp_c10 = (int16_t)((ts - cal1) * (TEMPSENSOR_CAL2_TEMP - TEMPSENSOR_CAL1_TEMP) * 10 / (cal2 - cal1)
+					+ TEMPSENSOR_CAL1_TEMP * 10);
+		}
+		break;
+
+	case HK_VBAT:
+		// bridge off again, IN18 back to the temperature sensor
+		LL_ADC_SetCommonPathInternalCh(__LL_ADC_COMMON_INSTANCE(adc.Instance), LL_ADC_PATH_INTERNAL_TEMPSENSOR);
+		if (hk->vdda_mv != 0) {
+			hk->vbat_mv = (uint16_t)(__LL_ADC_CALC_DATA_TO_VOLTAGE(hk->vdda_mv, raw, LL_ADC_RESOLUTION_12B) * HK_VBAT_DIVIDER);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+/**
+  * @brief  Arm one injected conversion of the next channel
+  * @param  *hk Pointer to the HK_Handle_t instance
+  * @retval Void
+**/
+static void housekeeping_arm(HK_Handle_t* hk) {
+
+	static const uint32_t channel[HK_CHANNELS] = {
+		LL_ADC_CHANNEL_VREFINT, LL_ADC_CHANNEL_TEMPSENSOR, LL_ADC_CHANNEL_VBAT
+	};
+
+	hk->channel = (HK_Channel_t)((hk->channel + 1) % HK_CHANNELS);
+	if (hk->channel == HK_VBAT) {
+		LL_ADC_SetCommonPathInternalCh(__LL_ADC_COMMON_INSTANCE(adc.Instance),
+				LL_ADC_PATH_INTERNAL_TEMPSENSOR | LL_ADC_PATH_INTERNAL_VBAT);
+	}
+	LL_ADC_INJ_SetSequencerRanks(adc.Instance, LL_ADC_INJ_RANK_1, channel[hk->channel]);
+
+	hk->wait = 0;
+	hk->state = HK_ARMED;
+	LL_ADC_INJ_StartConversionExtTrig(adc.Instance, LL_ADC_INJ_TRIG_EXT_RISING);
+}
+
+/**
+  * @brief  Check that the injected slot fits the active acquisition profile
+  * @note   The regular conversion must be over at the trigger, the injected one before the next sample
+  * @param  Void
+  * @retval true if a conversion can be armed
+**/
+static bool housekeeping_fits(void) {
+
+	uint32_t trigger_ns = TIMER_HK_TRIGGER_US * 1000U;
+	uint32_t period_ns = 1000000000U / TIM2_RATE_HZ;
+
+	return adc_cycles_ns(&adc, adc.conv_cycles) < trigger_ns
+			&& trigger_ns + adc_cycles_ns(&adc, HK_CONVERSION_CYCLES) < period_ns;
+}
+
+/**
+  * @brief  Convert a finished result, arm the next channel when due
+  * @note   Call on every display tick from the main loop
+  * @param  *hk Pointer to the HK_Handle_t instance
+  * @retval Void
+**/
+void housekeeping_poll(HK_Handle_t* hk) {
+
+	if (hk->period == 0) {
+		return;
+	}
+
+	HK_State_t state = hk->state;
+
+	if (state == HK_DONE) {
+		housekeeping_convert(hk);
+		hk->state = HK_IDLE;
+	} else if (state == HK_ARMED) {
+		// lost to a mode switch or ADC restart: disarm and move on
+		if (++hk->wait < HK_TIMEOUT_TICKS) {
+			return;
+		}
+		LL_ADC_INJ_StopConversionExtTrig(adc.Instance);
+		LL_ADC_SetCommonPathInternalCh(__LL_ADC_COMMON_INSTANCE(adc.Instance), LL_ADC_PATH_INTERNAL_TEMPSENSOR);
+		hk->timeouts++;
+		hk->state = HK_IDLE;
+	}
+
+	// the gap after each regular sample only exists in interrupt mode, with a short enough profile
+	if (++hk->ticks < hk->period || adc.mode != ADC_MODE_NORMAL || !housekeeping_fits()) {
+		return;
+	}
+	hk->ticks = 0;
+	housekeeping_arm(hk);
+}
@@ -0,0 +1,44 @@
+/**
+ * irq_prio.c
+ * -----------
+ * Central NVIC priority plan for the sampling engine.
+ *
+ * Applies the priority table defined in irq_prio.h.
+ **/
+
+#include "irq_prio.h"
+#include "uart.h"
+#include "stm32f4xx.h"
+
+/**
+  * @brief  Apply priority grouping and per-IRQ priorities from the table
+  * @note   Call after the CubeMX peripheral init, before timers are started
+  * @param  Void
+  * @retval Void
+**/
+void irq_prio_init(void) {
+
+	uint32_t group;
+
+	// set pre-emption / subpriority split
+	NVIC_SetPriorityGrouping(IRQ_PRIO_GROUPING);
+	group = NVIC_GetPriorityGrouping();
+
+	// sampling path
+	NVIC_SetPriority(TIM2_IRQn, NVIC_EncodePriority(group, IRQ_PRIO_SAMPLING, 0));
+	NVIC_SetPriority(ADC_IRQn, NVIC_EncodePriority(group, IRQ_PRIO_SAMPLING, 0));
+	NVIC_SetPriority(DMA2_Stream0_IRQn, NVIC_EncodePriority(group, IRQ_PRIO_SAMPLING, 0));
+
+	// transport path
+	NVIC_SetPriority(DMA1_Stream6_IRQn, NVIC_EncodePriority(group, IRQ_PRIO_TRANSPORT, 0));
+	NVIC_SetPriority(USART2_IRQn, NVIC_EncodePriority(group, IRQ_PRIO_TRANSPORT, 0));
+#ifdef UART_AUX_ENABLE
+	NVIC_SetPriority(uart_port_irq(UART_AUX_PORT), NVIC_EncodePriority(group, IRQ_PRIO_TRANSPORT, 0));
+#endif
+
+	// display path
+	NVIC_SetPriority(TIM3_IRQn, NVIC_EncodePriority(group, IRQ_PRIO_DISPLAY, 0));
+
+	// deferred work
+	NVIC_SetPriority(PendSV_IRQn, NVIC_EncodePriority(group, IRQ_PRIO_DEFERRED, 0));
+}
@@ -26,6 +26,23 @@
 #include "timer.h"
 #include "uart.h"
 #include "display.h"
+#include "irq_prio.h"
+#include "perf.h"
+#include "defer.h"
+#include "bench.h"
+#include "clock.h"
+#include "rms.h"
+#include "telemetry.h"
+#include "fft.h"
+#include "goertzel.h"
+#include "octave.h"
+#include "weighting.h"
+#include "decim.h"
+#include "oversample.h"
+#include "dc_track.h"
+#include "capture.h"
+#include "housekeeping.h"
+#include "selftest.h"
 
 /* USER CODE END Includes */
 
@@ -86,7 +103,7 @@ int main(void)
   LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_PWR);
 
   /* System interrupt init*/
-  NVIC_SetPriorityGrouping(NVIC_PRIORITYGROUP_0);
+  /* grouping and priorities are applied by irq_prio_init */
 
   /* USER CODE BEGIN Init */
 
@@ -96,6 +113,7 @@ int main(void)
   SystemClock_Config();
 
   /* USER CODE BEGIN SysInit */
+  clock_init(&sysclk, CLOCK_PROFILE_DEFAULT);
 
   /* USER CODE END SysInit */
 
@@ -107,11 +125,33 @@ int main(void)
   MX_TIM2_Init();
   MX_TIM3_Init();
   /* USER CODE BEGIN 2 */
+  irq_prio_init();
+  perf_init(&perf);
+  defer_init(&defer);
   circbuf_init(&txbuf);
-  uart_init(&uart, &txbuf);
+  uart_init(&uart, UART_PORT_USART2, UART_BAUDRATE, &txbuf);
+#ifdef UART_AUX_ENABLE
+  circbuf_init(&auxbuf);
+  uart_init(&uart_aux, UART_AUX_PORT, UART_AUX_BAUDRATE, &auxbuf);
+#endif
+  dc_init(&dc, DC_SHIFT_DEFAULT);
+  weighting_init(&weight, WEIGHT_DEFAULT);
+  rms_init(&rms, RMS_WINDOW_DEFAULT);
+  decim_init(&decim, DSP_DECIM_FACTOR, DSP_DECIM_TAPS, dsp_decim_coef);
+  goertzel_init(&goertzel, TIM2_RATE_HZ / decim.factor, GOERTZEL_WINDOW_DEFAULT);
+  octave_init(&octave, OCTAVE_MODE_OCTAVE, OCTAVE_WINDOW_DEFAULT);
+  oversample_init(&ovs, OVS_WINDOW_DEFAULT);
+  capture_init(&capture, CAPTURE_PRE_DEFAULT, CAPTURE_POST_DEFAULT, CAPTURE_HOLDOFF_MS_DEFAULT);
   adc_init(&adc, &txbuf);
-  timer_init(&timer);
+  selftest_run(&selftest, &uart);
+#ifdef BENCH_ENABLE
+  bench_run(&uart);
+#endif
   display_init(&disp);
+  timer_init(&timer);
+  housekeeping_init(&hk, HK_PERIOD_TICKS);
+  telemetry_init(&telem, TELEMETRY_PERIOD_TICKS);
+  fft_init(&fft, FFT_POINTS_DEFAULT, FFT_PERIOD_TICKS);
 
   uart_DMA_printf(&uart, "\nUART initialized!\r\n");
   uart_DMA_printf(&uart, "Circular Buffer initialized!\r\n");
@@ -126,14 +166,48 @@ int main(void)
 
   while (1)
   {
-	  if (adc_tick == 1) {
-	          adc_tick = 0;
-	          adc_start_conversion(&adc);
-	  }
-
 	  if (display_tick == 1) {
 	          display_tick = 0;
 	          display_update(&adc, &txbuf);
+	          telemetry_poll(&telem, &uart);
+	          fft_poll(&fft, &uart);
+	          goertzel_poll(&goertzel, &uart);
+	          octave_poll(&octave, &uart);
+	          oversample_poll(&ovs, &uart);
+	          housekeeping_poll(&hk);
+#ifdef BENCH_ENABLE
+	          bench_poll(&uart);
+#endif
+	  }
+
+	  // event snapshot streaming, trigger changes (set capture.requested); own port if there is one
+#ifdef UART_AUX_ENABLE
+	  capture_poll(&capture, &uart_aux);
+#else
+	  capture_poll(&capture, &uart);
+#endif
+
+	  // runtime clock profile change (set sysclk.requested)
+	  if (sysclk.requested != sysclk.profile) {
+	          clock_set_profile(&sysclk, sysclk.requested);
+	  }
+
+	  // runtime acquisition mode change (set adc.requested)
+	  if (adc.requested != adc.mode) {
+	          adc_set_mode(&adc, adc.requested);
+	  }
+
+	  // runtime acquisition profile change (set adc.requested_profile)
+	  if (adc.requested_profile != adc.profile) {
+	          adc_set_profile(&adc, adc.requested_profile);
+	  }
+
+	  // profile self-test on request (set selftest.requested)
+	  selftest_poll(&selftest, &uart);
+
+	  // runtime resolution change (set adc.requested_resolution)
+	  if (adc.requested_resolution != adc.resolution) {
+	          adc_set_resolution(&adc, adc.requested_resolution);
 	  }
 
 
@@ -221,7 +295,6 @@ static void MX_ADC1_Init(void)
   LL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 
   /* ADC1 interrupt Init */
-  NVIC_SetPriority(ADC_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),0, 0));
   NVIC_EnableIRQ(ADC_IRQn);
 
   /* USER CODE BEGIN ADC1_Init 1 */
@@ -273,7 +346,6 @@ static void MX_TIM2_Init(void)
   LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_TIM2);
 
   /* TIM2 interrupt Init */
-  NVIC_SetPriority(TIM2_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),0, 0));
   NVIC_EnableIRQ(TIM2_IRQn);
 
   /* USER CODE BEGIN TIM2_Init 1 */
@@ -312,7 +384,6 @@ static void MX_TIM3_Init(void)
   LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_TIM3);
 
   /* TIM3 interrupt Init */
-  NVIC_SetPriority(TIM3_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),0, 0));
   NVIC_EnableIRQ(TIM3_IRQn);
 
   /* USER CODE BEGIN TIM3_Init 1 */
@@ -384,10 +455,15 @@ static void MX_USART2_UART_Init(void)
 
   LL_DMA_SetMemorySize(DMA1, LL_DMA_STREAM_6, LL_DMA_MDATAALIGN_BYTE);
 
-  LL_DMA_DisableFifoMode(DMA1, LL_DMA_STREAM_6);
+  LL_DMA_EnableFifoMode(DMA1, LL_DMA_STREAM_6);
+
+  LL_DMA_SetFIFOThreshold(DMA1, LL_DMA_STREAM_6, LL_DMA_FIFOTHRESHOLD_FULL);
+
+  LL_DMA_SetMemoryBurstxfer(DMA1, LL_DMA_STREAM_6, LL_DMA_MBURST_SINGLE);
+
+  LL_DMA_SetPeriphBurstxfer(DMA1, LL_DMA_STREAM_6, LL_DMA_PBURST_SINGLE);
 
   /* USART2 interrupt Init */
-  NVIC_SetPriority(USART2_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),0, 0));
   NVIC_EnableIRQ(USART2_IRQn);
 
   /* USER CODE BEGIN USART2_Init 1 */
@@ -421,7 +497,6 @@ static void MX_DMA_Init(void)
 
   /* DMA interrupt init */
   /* DMA1_Stream6_IRQn interrupt configuration */
-  NVIC_SetPriority(DMA1_Stream6_IRQn, NVIC_EncodePriority(NVIC_GetPriorityGrouping(),0, 0));
   NVIC_EnableIRQ(DMA1_Stream6_IRQn);
 
 }
@@ -0,0 +1,241 @@
+/**
+ * octave.c
+ * ---------
+ * Octave / 1/3-octave band analyzer.
+ *
+ * Multirate filter bank: every stage band-passes its input with the
+ * same normalized design(s), then low-passes and keeps every other
+ * sample for the next stage, so each stage runs at half the rate of
+ * the one above it. Filters are cascaded float DF2T biquads with
+ * coefficients from tools/gen_tables.py.
+ *
+ * Per-band RMS is integrated over 'window' input samples and
+ * published in 'level', lowest band first.
+ **/
+
+#include "octave.h"
+#include "uart.h"
+#include "adc.h"
+#include "dbfs.h"
+#include "dsp_tables.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#define OCTAVE_COEFS 5 // {b0, b1, b2, a1, a2} per section
+
+// initialize global OCTAVE_Handle_t instance
+OCTAVE_Handle_t octave;
+
+// 1/3-octave centre offsets within a stage, lowest first: 2^(-1/3), 1, 2^(1/3)
+static const float octave_third_ratio[3] = { 0.793700526f, 1.0f, 1.259921050f };
+
+/**
+  * @brief  Initialize the band analyzer
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  mode Octave or 1/3-octave bank
+  * @param  window Input samples per level
+  * @retval Void
+**/
+void octave_init(OCTAVE_Handle_t* oct, OCTAVE_Mode_t mode, uint16_t window) {
+
+	// initialize software state
+	oct->output = OCTAVE_OUTPUT_OFF;
+	oct->seq = 0;
+	oct->window = (window == 0) ? 1 : window;
+	oct->sent = 0;
+	octave_set_mode(oct, mode);
+}
+
+/**
+  * @brief  Clear filter states and the running window
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @retval Void
+**/
+static void octave_restart(OCTAVE_Handle_t* oct) {
+
+	oct->index = 0;
+	memset(oct->phase, 0, sizeof(oct->phase));
+	memset(oct->count, 0, sizeof(oct->count));
+	memset(oct->lp, 0, sizeof(oct->lp));
+	memset(oct->band, 0, sizeof(oct->band));
+	memset(oct->sumsq, 0, sizeof(oct->sumsq));
+	oct->active = true;
+}
+
+/**
+  * @brief  Switch between octave and 1/3-octave bank, clears all state
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  mode Octave or 1/3-octave bank
+  * @retval Void
+**/
+void octave_set_mode(OCTAVE_Handle_t* oct, OCTAVE_Mode_t mode) {
+
+	oct->mode = mode;
+	oct->per_stage = (mode == OCTAVE_MODE_THIRD) ? 3 : 1;
+	oct->bands = oct->per_stage * OCTAVE_STAGES;
+	oct->windows = 0;
+
+	octave_restart(oct);
+	memset((void*)oct->level, 0, sizeof(oct->level));
+}
+
+/**
+  * @brief  Centre frequency of a band
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  band Band index, lowest first
+  * @param  sample_rate_hz Input rate
+  * @retval Centre frequency in Hz
+**/
+float octave_band_hz(OCTAVE_Handle_t* oct, uint32_t band, uint32_t sample_rate_hz) {
+
+	uint32_t stage = OCTAVE_STAGES - 1 - band / oct->per_stage;
+	float fc = (float)(sample_rate_hz >> stage) / (float)DSP_OCT_CENTER_DIV;
+
+	if (oct->mode == OCTAVE_MODE_THIRD) {
+		fc *= octave_third_ratio[band % 3];
+	}
+	return fc;
+}
+
+/**
+  * @brief  Run one sample through a cascade of DF2T biquads
+  * @param  *coef OCTAVE_SECTIONS x {b0, b1, b2, a1, a2}
+  * @param  *st OCTAVE_SECTIONS states
+  * @param  x Input sample
+  * @retval Output sample
+**/
+static inline float octave_cascade(const float* coef, OCTAVE_State_t* st, float x) {
+
+	for (uint32_t s = 0; s < OCTAVE_SECTIONS; s++, coef += OCTAVE_COEFS) {
+		float y = coef[0] * x + st[s].s1;
+		st[s].s1 = coef[1] * x - coef[3] * y + st[s].s2;
+		st[s].s2 = coef[2] * x - coef[4] * y;
+		x = y;
+	}
+	return x;
+}
+
+/**
+  * @brief  Window end: publish band RMS levels, restart integration
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @retval Void
+**/
+static void octave_finish(OCTAVE_Handle_t* oct) {
+
+	for (uint32_t b = 0; b < oct->bands; b++) {
+		uint32_t stage = OCTAVE_STAGES - 1 - b / oct->per_stage;
+		uint32_t n = oct->count[stage];
+		oct->level[b] = (n == 0) ? 0 : (uint16_t)sqrtf(oct->sumsq[b] / (float)n);
+		oct->sumsq[b] = 0.0f;
+	}
+	memset(oct->count, 0, sizeof(oct->count));
+	oct->stamp = adc.stamp;
+	oct->windows++;
+}
+
+/**
+  * @brief  Feed one sample through the bank
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  x Sample with mid-rail removed
+  * @retval Void
+**/
+RAMFUNC void octave_push(OCTAVE_Handle_t* oct, float x) {
+
+	const float* band_coef = (oct->mode == OCTAVE_MODE_THIRD) ? dsp_oct_third : dsp_oct_band;
+
+	for (uint32_t k = 0; k < OCTAVE_STAGES; k++) {
+
+		// band-passes of this stage (bands are stored lowest first)
+		uint32_t base = (OCTAVE_STAGES - 1 - k) * oct->per_stage;
+		for (uint32_t j = 0; j < oct->per_stage; j++) {
+			float y = octave_cascade(&band_coef[j * OCTAVE_SECTIONS * OCTAVE_COEFS], oct->band[base + j], x);
+			oct->sumsq[base + j] += y * y;
+		}
+		oct->count[k]++;
+
+		if (k == OCTAVE_STAGES - 1) {
+			break;
+		}
+
+		// anti-alias low-pass, then keep every second sample for the next stage
+		x = octave_cascade(dsp_oct_lp, oct->lp[k], x);
+		oct->phase[k] ^= 1;
+		if (oct->phase[k]) {
+			break;
+		}
+	}
+
+	if (++oct->index >= oct->window) {
+		oct->index = 0;
+		octave_finish(oct);
+	}
+}
+
+/**
+  * @brief  Feed a block of raw ADC samples
+  * @note   Called from the ADC bottom half
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void octave_process_block(OCTAVE_Handle_t* oct, const uint16_t* blk, uint32_t len) {
+
+	// resumed after a pause: states and partial sums are stale
+	if (!oct->active) {
+		octave_restart(oct);
+	}
+
+	for (uint32_t i = 0; i < len; i++) {
+		octave_push(oct, (float)((int32_t)blk[i] - ADC_MIDRAIL));
+	}
+}
+
+/**
+  * @brief  Send a binary frame when a new window has completed
+  * @note   Call on every display tick from the main loop
+  * @param  *oct Pointer to the OCTAVE_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void octave_poll(OCTAVE_Handle_t* oct, UART_Handle_t* uart) {
+
+	uint32_t windows = oct->windows;
+	if (oct->output != OCTAVE_OUTPUT_BINARY || windows == oct->sent) {
+		return;
+	}
+	oct->sent = windows;
+
+	uint8_t frame[OCTAVE_BANDS_MAX + 9];
+	uint32_t n = 0;
+	frame[n++] = OCTAVE_FRAME_SYNC0;
+	frame[n++] = OCTAVE_FRAME_SYNC1;
+	frame[n++] = oct->bands;
+	frame[n++] = oct->seq++;
+	uint32_t stamp = oct->stamp;
+	frame[n++] = (uint8_t)stamp;
+	frame[n++] = (uint8_t)(stamp >> 8);
+	frame[n++] = (uint8_t)(stamp >> 16);
+	frame[n++] = (uint8_t)(stamp >> 24);
+
+	// 0.5 dB per LSB above OCTAVE_DB_MIN
+	for (uint32_t b = 0; b < oct->bands; b++) {
+		int32_t level = (dbfs_from_level(oct->level[b]) - OCTAVE_DB_MIN) / 5;
+		if (level < 0) {
+			level = 0;
+		} else if (level > 255) {
+			level = 255;
+		}
+		frame[n++] = (uint8_t)level;
+	}
+
+	uint8_t x = 0;
+	for (uint32_t i = 2; i < n; i++) {
+		x ^= frame[i];
+	}
+	frame[n++] = x;
+
+	uart_DMA_write(uart, frame, (uint16_t)n);
+}
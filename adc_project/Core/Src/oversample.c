@@ -0,0 +1,249 @@
+/**
+ * oversample.c
+ * -------------
+ * Oversampling acquisition: CIC decimator + compensation FIR.
+ *
+ * The CIC integrators run at the ADC rate on wrapping 32-bit
+ * integers; every R samples the comb section produces one output,
+ * which is scaled by 1 / R^N and pushed into the float compensation
+ * FIR. The FIR only computes every OVS_FIR_DECIM-th output.
+ *
+ * Mean and variance are accumulated as deviations from the previous
+ * window mean, so the float sums keep their precision when the noise
+ * is a small fraction of an LSB.
+ **/
+
+#include "oversample.h"
+#include "uart.h"
+#include "adc.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define OVS_NOISE_MIN 1.0e-4f // noise floor clamp for the log, counts
+
+// initialize global OVS_Handle_t instance
+OVS_Handle_t ovs;
+
+/**
+  * @brief  Initialize the oversampling chain
+  * @param  *ovs Pointer to the OVS_Handle_t instance
+  * @param  window Outputs per statistics window
+  * @retval Void
+**/
+void oversample_init(OVS_Handle_t* ovs, uint32_t window) {
+
+	// initialize software state
+	ovs->window = (window == 0) ? 1 : window;
+	ovs->cic_scale = 1.0f;
+	for (uint32_t s = 0; s < OVS_CIC_ORDER; s++) {
+		ovs->cic_scale /= (float)OVS_CIC_RATIO;
+	}
+	ovs->windows = 0;
+	ovs->reported = 0;
+	oversample_reset(ovs);
+}
+
+/**
+  * @brief  Clear filter and statistics state
+  * @note   Called by 'adc_set_mode' before the DMA is started
+  * @param  *ovs Pointer to the OVS_Handle_t instance
+  * @retval Void
+**/
+void oversample_reset(OVS_Handle_t* ovs) {
+
+	memset(ovs->integ, 0, sizeof(ovs->integ));
+	memset(ovs->comb, 0, sizeof(ovs->comb));
+	memset(ovs->line, 0, sizeof(ovs->line));
+	ovs->cic_phase = 0;
+	ovs->pos = 0;
+	ovs->fir_phase = 0;
+	ovs->sample = ADC_MIDRAIL;
+	ovs->code = ADC_MIDRAIL << 4;
+	ovs->outputs = 0;
+
+	ovs->count = 0;
+	ovs->ref = 0.0f;
+	ovs->sum = 0.0f;
+	ovs->sumsq = 0.0f;
+	ovs->raw_ref = ADC_MIDRAIL;
+	ovs->raw_sum = 0;
+	ovs->raw_sumsq = 0;
+	ovs->raw_count = 0;
+	ovs->primed = false;
+}
+
+/**
+  * @brief  Push one CIC output into the compensation FIR
+  * @param  *ovs Pointer to the OVS_Handle_t instance
+  * @param  x CIC output, counts with mid-rail removed
+  * @retval Void
+**/
+static inline void oversample_fir(OVS_Handle_t* ovs, float x) {
+
+	// newest sample at 'pos', mirrored at 'pos + taps'
+	ovs->pos = (ovs->pos == 0) ? OVS_FIR_TAPS - 1 : ovs->pos - 1;
+	ovs->line[ovs->pos] = x;
+	ovs->line[ovs->pos + OVS_FIR_TAPS] = x;
+
+	if (++ovs->fir_phase < OVS_FIR_DECIM) {
+		return;
+	}
+	ovs->fir_phase = 0;
+
+	// symmetric taps, so the delay line order does not matter
+	const float* line = &ovs->line[ovs->pos];
+	float y = 0.0f;
+	for (uint32_t k = 0; k < OVS_FIR_TAPS; k++) {
+		y += dsp_ovs_fir[k] * line[k];
+	}
+
+	// publish (12-bit counts with fraction, 16-bit code)
+	float counts = y + (float)ADC_MIDRAIL;
+	int32_t code = (int32_t)(counts * 16.0f + 0.5f);
+	if (code < 0) {
+		code = 0;
+	} else if (code > 65535) {
+		code = 65535;
+	}
+	ovs->sample = counts;
+	ovs->code = (uint16_t)code;
+	ovs->outputs++;
+
+	// window statistics
+	float d = y - ovs->ref;
+	ovs->sum += d;
+	ovs->sumsq += d * d;
+	ovs->count++;
+}
+
+/**
+  * @brief  Window end: publish mean and noise, move the references
+  * @param  *ovs Pointer to the OVS_Handle_t instance
+  * @retval Void
+**/
+static void oversample_finish(OVS_Handle_t* ovs) {
+
+	float n = (float)ovs->count;
+	float m = ovs->sum / n;
+	float var = ovs->sumsq / n - m * m;
+
+	float rn = (float)ovs->raw_count;
+	float rm = (float)ovs->raw_sum / rn;
+	float raw_var = (float)ovs->raw_sumsq / rn - rm * rm;
+
+	// first window after a reset only settles the filters and references
+	if (ovs->primed) {
+		ovs->mean = ovs->ref + m + (float)ADC_MIDRAIL;
+		ovs->noise = sqrtf((var > 0.0f) ? var : 0.0f);
+		ovs->raw_noise = sqrtf((raw_var > 0.0f) ? raw_var : 0.0f);
+		ovs->stamp = adc.stamp;
+		ovs->windows++;
+	}
+	ovs->primed = true;
+
+	ovs->ref += m;
+	ovs->raw_ref += (int32_t)lroundf(rm);
+	ovs->count = 0;
+	ovs->sum = 0.0f;
+	ovs->sumsq = 0.0f;
+	ovs->raw_sum = 0;
+	ovs->raw_sumsq = 0;
+	ovs->raw_count = 0;
+}
+
+/**
+  * @brief  Run one DMA half through the CIC and compensation FIR
+  * @note   Called from the ADC bottom half
+  * @param  *ovs Pointer to the OVS_Handle_t instance
+  * @param  *in Raw 12-bit samples at OVS_ADC_RATE_HZ
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void oversample_process_block(OVS_Handle_t* ovs, const uint16_t* in, uint32_t len) {
+
+	uint32_t integ[OVS_CIC_ORDER];
+	memcpy(integ, ovs->integ, sizeof(integ));
+	uint32_t phase = ovs->cic_phase;
+	int32_t raw_ref = ovs->raw_ref;
+	int32_t raw_sum = 0;
+	int64_t raw_sumsq = 0;
+
+	for (uint32_t i = 0; i < len; i++) {
+
+		// raw statistics
+		int32_t d = (int32_t)in[i] - raw_ref;
+		raw_sum += d;
+		raw_sumsq += (int64_t)d * d;
+
+		// integrators (mod 2^32; the comb differences are exact)
+		uint32_t x = (uint32_t)((int32_t)in[i] - ADC_MIDRAIL);
+		for (uint32_t s = 0; s < OVS_CIC_ORDER; s++) {
+			integ[s] += x;
+			x = integ[s];
+		}
+
+		if (++phase < OVS_CIC_RATIO) {
+			continue;
+		}
+		phase = 0;
+
+		// combs at the decimated rate
+		for (uint32_t s = 0; s < OVS_CIC_ORDER; s++) {
+			uint32_t y = x - ovs->comb[s];
+			ovs->comb[s] = x;
+			x = y;
+		}
+		oversample_fir(ovs, (float)(int32_t)x * ovs->cic_scale);
+	}
+
+	memcpy(ovs->integ, integ, sizeof(integ));
+	ovs->cic_phase = phase;
+	ovs->raw_sum += raw_sum;
+	ovs->raw_sumsq += raw_sumsq;
+	ovs->raw_count += len;
+
+	// windows close on block boundaries, so raw and output sums line up
+	if (ovs->count >= ovs->window) {
+		oversample_finish(ovs);
+	}
+}
+
+/**
+  * @brief  Report mean, noise and resolution when a window has completed
+  * @note   Call on every display tick from the main loop
+  * @param  *ovs Pointer to the OVS_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void oversample_poll(OVS_Handle_t* ovs, UART_Handle_t* uart) {
+
+	uint32_t windows = ovs->windows;
+	if (windows == ovs->reported) {
+		return;
+	}
+	ovs->reported = windows;
+
+	float noise = (ovs->noise > OVS_NOISE_MIN) ? ovs->noise : OVS_NOISE_MIN;
+	float raw_noise = (ovs->raw_noise > OVS_NOISE_MIN) ? ovs->raw_noise : OVS_NOISE_MIN;
+
+	// noise-limited resolution over the 12-bit range, noise vs a full-scale sine
+	float enob = log2f(4096.0f / (noise * 3.4641016f));
+	float raw_enob = log2f(4096.0f / (raw_noise * 3.4641016f));
+	float floor_db = 20.0f * log10f((2048.0f * 0.70710678f) / noise);
+
+	char mean_s[24], noise_s[24], enob_s[24], floor_s[24], raw_noise_s[24], raw_enob_s[24];
+	uart_format_fixed(mean_s, sizeof(mean_s), ovs->mean, 100, 2);
+	uart_format_fixed(noise_s, sizeof(noise_s), noise, 1000, 3);
+	uart_format_fixed(enob_s, sizeof(enob_s), (enob > 0.0f) ? enob : 0.0f, 10, 1);
+	uart_format_fixed(floor_s, sizeof(floor_s), floor_db, 10, 1);
+	uart_format_fixed(raw_noise_s, sizeof(raw_noise_s), raw_noise, 1000, 3);
+	uart_format_fixed(raw_enob_s, sizeof(raw_enob_s), (raw_enob > 0.0f) ? raw_enob : 0.0f, 10, 1);
+
+	char line[192];
+	snprintf(line, sizeof(line), "\r\novs n=%lu mean=%s noise=%s enob=%s floor=-%s raw_noise=%s raw_enob=%s t=%lu\r\n",
+			(unsigned long)windows, mean_s, noise_s, enob_s, floor_s, raw_noise_s, raw_enob_s, (unsigned long)ovs->stamp);
+	uart_DMA_printf(uart, line);
+}
@@ -0,0 +1,63 @@
+/**
+ * perf.c
+ * -------
+ * Cycle-level performance instrumentation using the DWT cycle counter.
+ *
+ * Provides count / last / worst-case statistics for timing-critical
+ * paths. Results live in the global 'perf' instance so they can be
+ * watched live from the debugger (Live Expressions).
+ **/
+
+#include "perf.h"
+#include "stm32f4xx.h"
+
+// initialize global PERF_Handle_t instance
+PERF_Handle_t perf;
+
+/**
+  * @brief  Initialize perf module, enable DWT cycle counter
+  * @note   Call again after changing the core clock
+  * @param  *perf Pointer to the PERF_Handle_t instance
+  * @retval Void
+**/
+void perf_init(PERF_Handle_t* perf) {
+
+	// enable trace block and start cycle counter
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	// cache conversion factor for timer-tick based estimates
+	perf->cycles_per_us = SystemCoreClock / 1000000U;
+
+	perf_reset(&perf->sample_latency);
+	perf_reset(&perf->adc_isr);
+	perf_reset(&perf->adc_block);
+}
+
+/**
+  * @brief  Record a single measurement
+  * @param  *stat Pointer to the PERF_Stat_t to update
+  * @param  cycles Measured duration in core cycles
+  * @retval Void
+**/
+RAMFUNC void perf_record(PERF_Stat_t* stat, uint32_t cycles) {
+
+	stat->count++;
+	stat->last = cycles;
+	if (cycles > stat->max) {
+		stat->max = cycles;
+	}
+}
+
+/**
+  * @brief  Clear a statistic
+  * @param  *stat Pointer to the PERF_Stat_t to clear
+  * @retval Void
+**/
+void perf_reset(PERF_Stat_t* stat) {
+
+	stat->count = 0;
+	stat->last = 0;
+	stat->max = 0;
+}
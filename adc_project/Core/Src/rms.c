@@ -0,0 +1,179 @@
+/**
+ * rms.c
+ * ------
+ * Sliding-window RMS level meter.
+ *
+ * Keeps a ring of squared (mid-rail removed) samples and a running
+ * sum, so each new sample costs O(1): add the new square, subtract
+ * the one leaving the window. The square root is taken once per
+ * block, not per sample.
+ *
+ * Two engines are provided:
+ *   RMS_Fixed_t : uint32 squares, uint64 sum, exact (no drift)
+ *   RMS_Float_t : float squares / sum on the FPU; the running sum
+ *                 is rebuilt from the ring once per window, so
+ *                 add/subtract rounding (1 ulp = 512 near a
+ *                 full-scale sum of 4e9) cannot accumulate
+ * The live meter uses the fixed engine unless RMS_USE_FPU is
+ * defined; the bench module times both.
+ **/
+
+#include "rms.h"
+#include "adc.h"
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+// initialize global RMS_Handle_t instance
+RMS_Handle_t rms;
+
+/**
+  * @brief  Integer square root (bit-by-bit)
+  * @param  v Radicand
+  * @retval floor(sqrt(v))
+**/
+static uint32_t rms_isqrt(uint32_t v) {
+
+	uint32_t root = 0;
+	uint32_t bit = 1UL << 30;
+
+	while (bit > v) {
+		bit >>= 2;
+	}
+	while (bit != 0) {
+		if (v >= root + bit) {
+			v -= root + bit;
+			root = (root >> 1) + bit;
+		} else {
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+/**
+  * @brief  Clamp a requested window to the ring capacity
+  * @param  window Requested window length
+  * @retval Window length in 1..RMS_WINDOW_MAX
+**/
+static uint16_t rms_clamp_window(uint16_t window) {
+
+	if (window == 0) {
+		return 1;
+	}
+	if (window > RMS_WINDOW_MAX) {
+		return RMS_WINDOW_MAX;
+	}
+	return window;
+}
+
+/**
+  * @brief  Reset the fixed-point engine with a new window length
+  * @param  *eng Pointer to the RMS_Fixed_t engine
+  * @param  window Window length in samples (clamped to 1..RMS_WINDOW_MAX)
+  * @retval Void
+**/
+void rms_fixed_init(RMS_Fixed_t* eng, uint16_t window) {
+
+	eng->window = rms_clamp_window(window);
+	eng->index = 0;
+	eng->sum = 0;
+	memset(eng->sq, 0, sizeof(eng->sq));
+}
+
+/**
+  * @brief  Current RMS of the fixed-point window
+  * @param  *eng Pointer to the RMS_Fixed_t engine
+  * @retval RMS in ADC counts
+**/
+uint16_t rms_fixed_value(RMS_Fixed_t* eng) {
+
+	// mean square of 12-bit samples fits 32 bits
+	return (uint16_t)rms_isqrt((uint32_t)(eng->sum / eng->window));
+}
+
+/**
+  * @brief  Reset the FPU engine with a new window length
+  * @param  *eng Pointer to the RMS_Float_t engine
+  * @param  window Window length in samples (clamped to 1..RMS_WINDOW_MAX)
+  * @retval Void
+**/
+void rms_float_init(RMS_Float_t* eng, uint16_t window) {
+
+	eng->window = rms_clamp_window(window);
+	eng->index = 0;
+	eng->sum = 0.0f;
+	memset(eng->sq, 0, sizeof(eng->sq));
+}
+
+/**
+  * @brief  Rebuild the FPU running sum from the ring
+  * @note   Called once per window from 'rms_float_push' (O(1) per sample on average)
+  * @param  *eng Pointer to the RMS_Float_t engine
+  * @retval Void
+**/
+RAMFUNC void rms_float_resum(RMS_Float_t* eng) {
+
+	// squares of 12-bit samples are exact in float: only this sum rounds, once
+	float sum = 0.0f;
+	for (uint32_t i = 0; i < eng->window; i++) {
+		sum += eng->sq[i];
+	}
+	eng->sum = sum;
+}
+
+/**
+  * @brief  Current RMS of the FPU window
+  * @param  *eng Pointer to the RMS_Float_t engine
+  * @retval RMS in ADC counts
+**/
+uint16_t rms_float_value(RMS_Float_t* eng) {
+
+	// within a window add/subtract rounding can still leave a negative residue on silence
+	if (eng->sum < 0.0f) {
+		eng->sum = 0.0f;
+	}
+	return (uint16_t)sqrtf(eng->sum / (float)eng->window);
+}
+
+/**
+  * @brief  Initialize the live meter
+  * @param  *rms Pointer to the RMS_Handle_t instance
+  * @param  window Window length in samples
+  * @retval Void
+**/
+void rms_init(RMS_Handle_t* rms, uint16_t window) {
+
+#ifdef RMS_USE_FPU
+	rms_float_init(&rms->eng, window);
+#else
+	rms_fixed_init(&rms->eng, window);
+#endif
+	rms->level = 0;
+}
+
+/**
+  * @brief  Feed a block of raw ADC samples, publish the new level
+  * @note   Called from the ADC bottom half
+  * @param  *rms Pointer to the RMS_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  len Number of samples
+  * @retval Void
+**/
+RAMFUNC void rms_process_block(RMS_Handle_t* rms, const uint16_t* blk, uint32_t len) {
+
+	for (uint32_t i = 0; i < len; i++) {
+#ifdef RMS_USE_FPU
+		rms_float_push(&rms->eng, (int32_t)blk[i] - ADC_MIDRAIL);
+#else
+		rms_fixed_push(&rms->eng, (int32_t)blk[i] - ADC_MIDRAIL);
+#endif
+	}
+
+#ifdef RMS_USE_FPU
+	rms->level = rms_float_value(&rms->eng);
+#else
+	rms->level = rms_fixed_value(&rms->eng);
+#endif
+}
@@ -0,0 +1,264 @@
+/**
+ * selftest.c
+ * -----------
+ * ADC acquisition profile self-test.
+ *
+ * The measurement runs with the ADC interrupts off and TIM2 stopped:
+ * continuous conversions are moved by DMA2 Stream0 (direct mode, one
+ * half-word per request, no stream interrupts) and the transfer count
+ * is polled against the core cycle counter, so nothing else touches
+ * the ADC while a profile is timed.
+ **/
+
+#include "selftest.h"
+#include "adc.h"
+#include "clock.h"
+#include "perf.h"
+#include "uart.h"
+#include "circbuf.h"
+#include "stm32f4xx_ll_adc.h"
+#include "stm32f4xx_ll_dma.h"
+#include "stm32f4xx_ll_tim.h"
+#include "stm32f4xx.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <math.h>
+
+// initialize global SELFTEST_Handle_t instance
+SELFTEST_Handle_t selftest;
+
+// conversions of the profile under test
+static uint16_t selftest_buf[SELFTEST_SAMPLES];
+
+/**
+  * @brief  Arm DMA2 Stream0: ADC1 DR -> selftest_buf, one pass, polled
+  * @param  Void
+  * @retval Void
+**/
+static void selftest_dma_start(void) {
+
+	LL_DMA_DisableStream(DMA2, ADC_DMA_STREAM);
+	while (LL_DMA_IsEnabledStream(DMA2, ADC_DMA_STREAM)) {
+	}
+	LL_DMA_ClearFlag_HT0(DMA2);
+	LL_DMA_ClearFlag_TC0(DMA2);
+	LL_DMA_ClearFlag_TE0(DMA2);
+	LL_DMA_ClearFlag_FE0(DMA2);
+	LL_DMA_ClearFlag_DME0(DMA2);
+
+	LL_DMA_SetChannelSelection(DMA2, ADC_DMA_STREAM, ADC_DMA_CHANNEL);
+	LL_DMA_SetDataTransferDirection(DMA2, ADC_DMA_STREAM, LL_DMA_DIRECTION_PERIPH_TO_MEMORY);
+	LL_DMA_SetStreamPriorityLevel(DMA2, ADC_DMA_STREAM, LL_DMA_PRIORITY_HIGH);
+	LL_DMA_SetMode(DMA2, ADC_DMA_STREAM, LL_DMA_MODE_NORMAL);
+	LL_DMA_SetPeriphIncMode(DMA2, ADC_DMA_STREAM, LL_DMA_PERIPH_NOINCREMENT);
+	LL_DMA_SetMemoryIncMode(DMA2, ADC_DMA_STREAM, LL_DMA_MEMORY_INCREMENT);
+	LL_DMA_SetPeriphSize(DMA2, ADC_DMA_STREAM, LL_DMA_PDATAALIGN_HALFWORD);
+
+	// direct mode: NDTR counts every conversion as it lands
+	LL_DMA_DisableFifoMode(DMA2, ADC_DMA_STREAM);
+	LL_DMA_SetMemorySize(DMA2, ADC_DMA_STREAM, LL_DMA_MDATAALIGN_HALFWORD);
+	LL_DMA_SetMemoryBurstxfer(DMA2, ADC_DMA_STREAM, LL_DMA_MBURST_SINGLE);
+
+	LL_DMA_SetPeriphAddress(DMA2, ADC_DMA_STREAM, LL_ADC_DMA_GetRegAddr(adc.Instance, LL_ADC_DMA_REG_REGULAR_DATA));
+	LL_DMA_SetMemoryAddress(DMA2, ADC_DMA_STREAM, (uint32_t)selftest_buf);
+	LL_DMA_SetDataLength(DMA2, ADC_DMA_STREAM, SELFTEST_SAMPLES);
+
+	// polled: the stream interrupt stays with adc_handle_dma_irq
+	LL_DMA_DisableIT_HT(DMA2, ADC_DMA_STREAM);
+	LL_DMA_DisableIT_TC(DMA2, ADC_DMA_STREAM);
+	LL_DMA_DisableIT_TE(DMA2, ADC_DMA_STREAM);
+	LL_DMA_EnableStream(DMA2, ADC_DMA_STREAM);
+}
+
+/**
+  * @brief  Stop continuous conversions and the stream, back to single software starts
+  * @param  Void
+  * @retval Void
+**/
+static void selftest_stop(void) {
+
+	LL_ADC_Disable(adc.Instance);
+	LL_ADC_REG_SetContinuousMode(adc.Instance, LL_ADC_REG_CONV_SINGLE);
+	LL_ADC_REG_SetDMATransfer(adc.Instance, LL_ADC_REG_DMA_TRANSFER_NONE);
+
+	LL_DMA_DisableStream(DMA2, ADC_DMA_STREAM);
+	while (LL_DMA_IsEnabledStream(DMA2, ADC_DMA_STREAM)) {
+	}
+	LL_DMA_ClearFlag_HT0(DMA2);
+	LL_DMA_ClearFlag_TC0(DMA2);
+	LL_DMA_ClearFlag_TE0(DMA2);
+	LL_DMA_ClearFlag_FE0(DMA2);
+	LL_DMA_ClearFlag_DME0(DMA2);
+
+	LL_ADC_ClearFlag_EOCS(adc.Instance);
+	LL_ADC_ClearFlag_OVR(adc.Instance);
+	LL_ADC_Enable(adc.Instance);
+}
+
+/**
+  * @brief  Time SELFTEST_SAMPLES back-to-back conversions of one profile
+  * @param  *res Pointer to the result to fill
+  * @param  profile Profile under test
+  * @retval Void
+**/
+static void selftest_profile(SELFTEST_Result_t* res, ADC_Profile_t profile) {
+
+	adc_set_profile(&adc, profile);
+	res->adcclk_hz = adc.adcclk_hz;
+	res->rate_max = adc_profile_rate(profile, sysclk.pclk2_hz);
+	res->rate = 0;
+	res->mean = 0.0f;
+	res->noise = 0.0f;
+	if (res->rate_max == 0) {
+		return;
+	}
+
+	// continuous conversions, DMA requests stop after the last transfer
+	LL_ADC_Disable(adc.Instance);
+	LL_ADC_REG_SetContinuousMode(adc.Instance, LL_ADC_REG_CONV_CONTINUOUS);
+	LL_ADC_REG_SetDMATransfer(adc.Instance, LL_ADC_REG_DMA_TRANSFER_LIMITED);
+	selftest_dma_start();
+	LL_ADC_ClearFlag_EOCS(adc.Instance);
+	LL_ADC_ClearFlag_OVR(adc.Instance);
+	LL_ADC_Enable(adc.Instance);
+
+	// ADC power-up (tSTAB, 3 us max): wait 10 us
+	uint32_t t = PERF_CYCLES();
+	while (PERF_CYCLES() - t < sysclk.hclk_hz / 100000U) {
+	}
+
+	// twice the expected duration plus 1 ms
+	uint32_t timeout = (uint32_t)(((uint64_t)2U * SELFTEST_SAMPLES * sysclk.hclk_hz) / res->rate_max) + sysclk.hclk_hz / 1000U;
+	bool ok = true;
+
+	uint32_t start = PERF_CYCLES();
+	LL_ADC_REG_StartConversionSWStart(adc.Instance);
+
+	// the first transfer starts the clock, transfer complete stops it
+	uint32_t left;
+	while ((left = LL_DMA_GetDataLength(DMA2, ADC_DMA_STREAM)) == SELFTEST_SAMPLES) {
+		if (PERF_CYCLES() - start > timeout) {
+			ok = false;
+			break;
+		}
+	}
+	uint32_t t0 = PERF_CYCLES();
+	while (ok && !LL_DMA_IsActiveFlag_TC0(DMA2)) {
+		if (PERF_CYCLES() - start > timeout) {
+			ok = false;
+		}
+	}
+	uint32_t t1 = PERF_CYCLES();
+
+	selftest_stop();
+
+	if (!ok || t1 == t0) {
+		return;
+	}
+
+	// 'left' conversions landed between t0 and t1
+	res->rate = (uint32_t)(((uint64_t)left * sysclk.hclk_hz) / (t1 - t0));
+
+	// mean and RMS noise of the settled samples on the 12-bit scale (exact integer sums)
+	uint64_t sum = 0, sum2 = 0;
+	uint32_t n = SELFTEST_SAMPLES - SELFTEST_SETTLE;
+	for (uint32_t i = SELFTEST_SETTLE; i < SELFTEST_SAMPLES; i++) {
+		uint32_t x = (uint32_t)selftest_buf[i] << adc.res_shift;
+		sum += x;
+		sum2 += (uint64_t)x * x;
+	}
+	uint64_t var_n2 = (uint64_t)n * sum2 - sum * sum;
+	res->mean = (float)sum / (float)n;
+	res->noise = sqrtf((float)var_n2) / (float)n;
+}
+
+/**
+  * @brief  Print one profile result once the TX backlog allows it
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  profile Profile
+  * @param  *res Pointer to the result
+  * @retval Void
+**/
+static void selftest_print(UART_Handle_t* uart, ADC_Profile_t profile, const SELFTEST_Result_t* res) {
+
+	// the circular buffer overwrites when full: let it drain first
+	while (circbuf_count(uart->circ_buffer) > SELFTEST_TX_LEVEL) {
+	}
+
+	char mean_s[16], noise_s[16];
+	uart_format_fixed(mean_s, sizeof(mean_s), res->mean, 100, 2);
+	uart_format_fixed(noise_s, sizeof(noise_s), res->noise, 1000, 3);
+
+	char line[128];
+	snprintf(line, sizeof(line), "selftest prof=%s clk=%lu max=%lu meas=%lu mean=%s noise=%s%s\r\n",
+			adc_profile_name(profile), (unsigned long)res->adcclk_hz, (unsigned long)res->rate_max,
+			(unsigned long)res->rate, mean_s, noise_s, (res->rate == 0) ? " timeout" : "");
+	uart_DMA_printf(uart, line);
+}
+
+/**
+  * @brief  Measure conversion rate and noise of every acquisition profile
+  * @note   Blocking, thread mode only; call after 'adc_init'
+  * @param  *st Pointer to the SELFTEST_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for the report
+  * @retval Void
+**/
+void selftest_run(SELFTEST_Handle_t* st, UART_Handle_t* uart) {
+
+	st->requested = 0;
+
+	// the oversampling mode owns the DMA stream
+	if (adc.mode != ADC_MODE_NORMAL) {
+		uart_DMA_printf(uart, "\r\nselftest skipped (oversampling mode)\r\n");
+		return;
+	}
+
+	// no software starts (TIM2 ISR) and no ADC interrupts while measuring
+	bool ticking = LL_TIM_IsEnabledCounter(TIM2);
+	LL_TIM_DisableCounter(TIM2);
+	LL_ADC_DisableIT_EOCS(adc.Instance);
+	LL_ADC_DisableIT_OVR(adc.Instance);
+
+	ADC_Profile_t profile = adc.profile;
+	uint8_t resolution = adc.resolution;
+
+	uart_DMA_printf(uart, "\r\n");
+	for (uint32_t p = 0; p < ADC_PROFILE_COUNT; p++) {
+		selftest_profile(&st->result[p], (ADC_Profile_t)p);
+		selftest_print(uart, (ADC_Profile_t)p, &st->result[p]);
+	}
+
+	// back to the running profile (and resolution override)
+	adc_set_profile(&adc, profile);
+	if (adc.resolution != resolution) {
+		adc_set_resolution(&adc, resolution);
+	}
+	(void)LL_ADC_REG_ReadConversionData12(adc.Instance);
+	LL_ADC_ClearFlag_EOCS(adc.Instance);
+	LL_ADC_ClearFlag_OVR(adc.Instance);
+	LL_ADC_EnableIT_EOCS(adc.Instance);
+	LL_ADC_EnableIT_OVR(adc.Instance);
+
+	// the partly filled block spans the gap: drop it
+	adc.fill_index = 0;
+	st->runs++;
+
+	if (ticking) {
+		LL_TIM_EnableCounter(TIM2);
+	}
+}
+
+/**
+  * @brief  Run the self-test when requested
+  * @note   Call from the main loop
+  * @param  *st Pointer to the SELFTEST_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for the report
+  * @retval Void
+**/
+void selftest_poll(SELFTEST_Handle_t* st, UART_Handle_t* uart) {
+
+	if (st->requested) {
+		selftest_run(st, uart);
+	}
+}
@@ -25,6 +25,7 @@
 #include "uart.h"
 #include "adc.h"
 #include "timer.h"
+#include "defer.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -173,7 +174,7 @@ void DebugMon_Handler(void)
 void PendSV_Handler(void)
 {
   /* USER CODE BEGIN PendSV_IRQn 0 */
-
+	defer_run(&defer);
   /* USER CODE END PendSV_IRQn 0 */
   /* USER CODE BEGIN PendSV_IRQn 1 */
 
@@ -268,4 +269,50 @@ void USART2_IRQHandler(void)
 
 /* USER CODE BEGIN 1 */
 
+/**
+  * @brief This function handles DMA2 stream0 global interrupt (ADC1, oversampling mode).
+  */
+void DMA2_Stream0_IRQHandler(void)
+{
+	adc_handle_dma_irq(&adc);
+}
+
+#ifdef UART_AUX_ENABLE
+/*
+ * Second UART port: one handler per TX stream it can use (uart.c port
+ * table). Only the stream of UART_AUX_PORT is enabled in the NVIC; the
+ * constant test drops the others' bodies.
+ */
+
+/**
+  * @brief This function handles DMA2 stream7 global interrupt (second UART port, USART1 TX).
+  */
+void DMA2_Stream7_IRQHandler(void)
+{
+	if (UART_AUX_PORT == UART_PORT_USART1) {
+		uart_handle_dma_irq(&uart_aux);
+	}
+}
+
+/**
+  * @brief This function handles DMA1 stream3 global interrupt (second UART port, USART3 TX).
+  */
+void DMA1_Stream3_IRQHandler(void)
+{
+	if (UART_AUX_PORT == UART_PORT_USART3) {
+		uart_handle_dma_irq(&uart_aux);
+	}
+}
+
+/**
+  * @brief This function handles DMA1 stream4 global interrupt (second UART port, UART4 TX).
+  */
+void DMA1_Stream4_IRQHandler(void)
+{
+	if (UART_AUX_PORT == UART_PORT_UART4) {
+		uart_handle_dma_irq(&uart_aux);
+	}
+}
+#endif
+
 /* USER CODE END 1 */
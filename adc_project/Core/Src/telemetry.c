@@ -0,0 +1,92 @@
+/**
+ * telemetry.c
+ * ------------
+ * Periodic telemetry line over UART.
+ *
+ * Every 'period' display ticks a single line of key=value pairs is
+ * queued to the TX circular buffer, on its own line so host tools
+ * can grep it out of the bar-graph stream:
+ *
+ *   tlm n=12 src=rms wt=A dc=2031.4 env=143 rms=161 db=-22.1 blk=7500 drop=0 smp=240000 ovr=0 prof=fast res=12 t=12001544 vdda=3298 temp=31.5 vbat=3012
+ *
+ * A period of 0 disables telemetry.
+ **/
+
+#include "telemetry.h"
+#include "uart.h"
+#include "adc.h"
+#include "rms.h"
+#include "display.h"
+#include "weighting.h"
+#include "dc_track.h"
+#include "housekeeping.h"
+#include <stdint.h>
+#include <stdio.h>
+
+// initialize global TELEM_Handle_t instance
+TELEM_Handle_t telem;
+
+/**
+  * @brief  Initialize telemetry module
+  * @param  *telem Pointer to the TELEM_Handle_t instance
+  * @param  period Display ticks between lines, 0 disables output
+  * @retval Void
+**/
+void telemetry_init(TELEM_Handle_t* telem, uint16_t period) {
+
+	// initialize software state
+	telem->period = period;
+	telem->ticks = 0;
+	telem->frames = 0;
+}
+
+/**
+  * @brief  Count a display tick, send a line when the period elapses
+  * @note   Call on every display tick from the main loop
+  * @param  *telem Pointer to the TELEM_Handle_t instance
+  * @param  *uart Pointer to the UART_Handle_t used for output
+  * @retval Void
+**/
+void telemetry_poll(TELEM_Handle_t* telem, UART_Handle_t* uart) {
+
+	if (telem->period == 0 || ++telem->ticks < telem->period) {
+		return;
+	}
+	telem->ticks = 0;
+
+	// displayed level in dBFS, printed as -dd.d
+	int32_t db = disp.db;
+	const char* sign = (db < 0) ? "-" : "";
+	if (db < 0) db = -db;
+
+	// tracked amplifier bias in counts, printed as dddd.d
+	uint32_t dc10 = (uint32_t)(((uint64_t)(uint32_t)dc.offset_q16 * 10U + 0x8000U) >> 16);
+
+	// die temperature, printed as -dd.d
+	int32_t temp = hk.temp_c10;
+	const char* temp_sign = (temp < 0) ? "-" : "";
+	if (temp < 0) temp = -temp;
+
+	char line[224];
+	snprintf(line, sizeof(line), "\r\ntlm n=%lu src=%s wt=%c dc=%lu.%lu env=%u rms=%u db=%s%ld.%ld blk=%lu drop=%lu smp=%lu ovr=%lu prof=%s res=%u t=%lu vdda=%u temp=%s%ld.%ld vbat=%u\r\n",
+			(unsigned long)telem->frames,
+			(disp.source == DISPLAY_SOURCE_RMS) ? "rms" : "env",
+			weighting_letter(&weight),
+			(unsigned long)(dc10 / 10), (unsigned long)(dc10 % 10),
+			(unsigned)adc.sample,
+			(unsigned)rms.level,
+			sign, (long)(db / 10), (long)(db % 10),
+			(unsigned long)adc.blocks_consumed,
+			(unsigned long)adc.blocks_dropped,
+			(unsigned long)adc.samples,
+			(unsigned long)adc.overruns,
+			(adc.mode == ADC_MODE_NORMAL) ? adc_profile_name(adc.profile) : "ovs",
+			(unsigned)((adc.mode == ADC_MODE_NORMAL) ? adc.resolution : 12U),
+			(unsigned long)adc.stamp,
+			(unsigned)hk.vdda_mv,
+			temp_sign, (long)(temp / 10), (long)(temp % 10),
+			(unsigned)hk.vbat_mv);
+	uart_DMA_printf(uart, line);
+
+	telem->frames++;
+}
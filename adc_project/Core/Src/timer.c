@@ -6,15 +6,29 @@
  * Uses hardware timers to generate fixed-rate software ticks
  * for ADC sampling and display updates.
  *
- * Timer ISRs set software flags that are serviced in the main loop
- * to avoid blocking or heavy processing in interrupt context.
+ * The TIM2 ISR starts each ADC conversion directly so sample timing
+ * never depends on the main loop. The TIM3 ISR sets a software flag
+ * that is serviced in the main loop to avoid heavy processing in
+ * interrupt context.
+ *
+ * Prescalers are derived from the APB1 timer clock so both timers
+ * always count at TIMER_TICK_HZ, whatever the active clock profile.
+ *
+ * For the oversampling acquisition mode TIM2 is switched to a hardware
+ * ADC trigger instead ('timer_set_adc_trigger'): no interrupt, TRGO on
+ * update, counting at the full timer clock.
+ *
+ * TIM5 is the free-running 32-bit timestamp base ('TIMER_STAMP').
  **/
 
 #include "timer.h"
 #include "stm32f4xx_ll_tim.h"
+#include "stm32f4xx_ll_bus.h"
+#include "adc.h"
+#include "perf.h"
+#include "clock.h"
 
-// initialize global adc_tick and display_tick software flags
-volatile uint8_t adc_tick = 0;
+// initialize global display_tick software flag
 volatile uint8_t display_tick = 0;
 
 // initialize global TIM_Handle_t instance
@@ -27,38 +41,115 @@ TIM_Handle_t timer;
 **/
 void timer_init(TIM_Handle_t* timer) {
 
+	// TIM5: free-running up-counter over the full 32 bits
+	LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_TIM5);
+	LL_TIM_SetCounterMode(TIM5, LL_TIM_COUNTERMODE_UP);
+	LL_TIM_SetAutoReload(TIM5, 0xFFFFFFFFU);
+	LL_TIM_SetCounter(TIM5, 0);
+
+	// TIM2 CC1: rising OC1REF edge after each regular conversion (injected trigger, no pin)
+	LL_TIM_OC_SetMode(TIM2, LL_TIM_CHANNEL_CH1, LL_TIM_OCMODE_PWM2);
+	LL_TIM_OC_SetCompareCH1(TIM2, TIMER_HK_TRIGGER_US); // 1 us per tick in interrupt mode
+	LL_TIM_CC_EnableChannel(TIM2, LL_TIM_CHANNEL_CH1);
+
+	// prescaler and autoreload values for the active clock profile
+	timer->adc_trigger_hz = 0;
+	timer_set_clock(timer, sysclk.tim_apb1_hz);
+
+	// enable timer 2 and 3 flags
+	LL_TIM_EnableIT_UPDATE(TIM2);
+	LL_TIM_EnableCounter(TIM2);
+	LL_TIM_EnableIT_UPDATE(TIM3);
+	LL_TIM_EnableCounter(TIM3);
+	LL_TIM_EnableCounter(TIM5);
+}
+
+/**
+  * @brief  Recompute prescalers for a new timer clock
+  * @note   Counters should be stopped by the caller
+  * @param  *timer Pointer to the TIM_Handle_t instance
+  * @param  tim_clk_hz APB1 timer clock in Hz
+  * @retval Void
+**/
+void timer_set_clock(TIM_Handle_t* timer, uint32_t tim_clk_hz) {
+
 	// initialize software state (prescaler and autoreload values)
-	timer->prescaler2 = TIM2_PRESCALER;
-	timer->autoreload2 = TIM2_AUTORELOAD;
-	timer->prescaler3 = TIM3_PRESCALER;
-	timer->autoreload3 = TIM3_AUTORELOAD;
+	if (timer->adc_trigger_hz == 0) {
+		timer->prescaler2 = tim_clk_hz / TIMER_TICK_HZ - 1U;
+		timer->autoreload2 = TIMER_TICK_HZ / TIM2_RATE_HZ - 1U;
+	} else {
+		// hardware trigger: full timer clock for an exact high rate
+		timer->prescaler2 = 0;
+		timer->autoreload2 = tim_clk_hz / timer->adc_trigger_hz - 1U;
+	}
+	timer->prescaler3 = tim_clk_hz / TIMER_TICK_HZ - 1U;
+	timer->autoreload3 = TIMER_TICK_HZ / TIM3_RATE_HZ - 1U;
+	timer->prescaler5 = tim_clk_hz / TIMER_STAMP_HZ - 1U;
 
 	// set timer 2 prescaler and autoreload values with LL functions
 	LL_TIM_SetPrescaler(TIM2, timer->prescaler2);
 	LL_TIM_SetAutoReload(TIM2, timer->autoreload2);
 
-	// set timer 2 prescaler and autoreload values with LL functions
+	// set timer 3 prescaler and autoreload values with LL functions
 	LL_TIM_SetPrescaler(TIM3, timer->prescaler3);
 	LL_TIM_SetAutoReload(TIM3, timer->autoreload3);
 
-	// enable timer 2 and 3 flags
-	LL_TIM_EnableIT_UPDATE(TIM2);
+	// load the (preloaded) prescalers now, drop the resulting update flags
+	LL_TIM_GenerateEvent_UPDATE(TIM2);
+	LL_TIM_GenerateEvent_UPDATE(TIM3);
+	LL_TIM_ClearFlag_UPDATE(TIM2);
+	LL_TIM_ClearFlag_UPDATE(TIM3);
+
+	// timer 5 keeps running: the update event zeroes the counter, so put it back
+	if (LL_TIM_GetPrescaler(TIM5) != timer->prescaler5) {
+		uint32_t stamp = LL_TIM_GetCounter(TIM5);
+		LL_TIM_SetPrescaler(TIM5, timer->prescaler5);
+		LL_TIM_GenerateEvent_UPDATE(TIM5);
+		LL_TIM_SetCounter(TIM5, stamp);
+		LL_TIM_ClearFlag_UPDATE(TIM5);
+	}
+}
+
+/**
+  * @brief  Switch TIM2 between ISR trigger and hardware (TRGO) ADC trigger
+  * @note   Stops and restarts TIM2; rate_hz must divide the timer clock
+  * @param  *timer Pointer to the TIM_Handle_t instance
+  * @param  rate_hz TRGO rate, or 0 for the TIM2_RATE_HZ interrupt trigger
+  * @retval Void
+**/
+void timer_set_adc_trigger(TIM_Handle_t* timer, uint32_t rate_hz) {
+
+	LL_TIM_DisableCounter(TIM2);
+	timer->adc_trigger_hz = rate_hz;
+	timer_set_clock(timer, sysclk.tim_apb1_hz);
+
+	if (rate_hz == 0) {
+		// ISR starts each conversion
+		LL_TIM_SetTriggerOutput(TIM2, LL_TIM_TRGO_RESET);
+		LL_TIM_ClearFlag_UPDATE(TIM2);
+		LL_TIM_EnableIT_UPDATE(TIM2);
+	} else {
+		// update event triggers the ADC directly
+		LL_TIM_DisableIT_UPDATE(TIM2);
+		LL_TIM_SetTriggerOutput(TIM2, LL_TIM_TRGO_UPDATE);
+	}
 	LL_TIM_EnableCounter(TIM2);
-	LL_TIM_EnableIT_UPDATE(TIM3);
-	LL_TIM_EnableCounter(TIM3);
 }
 
 /**
-  * @brief  Update adc_tick software flag
+  * @brief  Start ADC conversion, stamp trigger time
   * @param  Void
   * @retval Void
 **/
-void timer_handle_irq2(void) {
+RAMFUNC void timer_handle_irq2(void) {
 	if (LL_TIM_IsActiveFlag_UPDATE(TIM2)) {
 			LL_TIM_ClearFlag_UPDATE(TIM2);
 
-			// update adc_tick
-			adc_tick = 1;
+			// back-date stamp to the update event (counter runs at 1 MHz)
+			adc.trigger_cycles = PERF_CYCLES() - LL_TIM_GetCounter(TIM2) * perf.cycles_per_us;
+
+			// start conversion
+			adc_start_conversion(&adc);
 	}
 }
 
@@ -3,70 +3,491 @@
  * -------
  * UART transmission driver using DMA and a circular buffer.
  *
- * Provides non-blocking output over USART2 by
+ * Provides non-blocking output over a USART by
  * buffering characters (with circbuf module) and
  * transmitting the largest contiguous chunk via DMA.
  *
+ * Nothing below names a specific USART or DMA stream: the port table
+ * supplies them at 'uart_init', and the stream flags are read and
+ * cleared through the handle's flag register pointers and shift, since
+ * the LL flag accessors exist per stream number only.
+ *
  * Designed for low CPU burden.
+ *
+ * The DMA interrupt only acknowledges hardware; advancing the buffer
+ * and re-arming DMA run later as a deferred (PendSV) bottom half.
+ *
+ * TX is an explicit state machine (IDLE -> ACTIVE -> COMPLETE -> IDLE).
+ * In normal mode the hardware clears the stream EN bit before raising
+ * TC, so the stream is only reconfigured once it is known disabled
+ * and nothing ever spins on LL_DMA_IsEnabledStream. A stream stopped
+ * by software raises TC once EN reads 0; that interrupt, not a re-post
+ * from the bottom half itself, drives UART_TX_WAIT_DISABLE on.
+ *
+ * Continuous mode: when the backlog holds at least two chunks, the
+ * stream switches to double-buffer (DBM) mode and alternates between
+ * two linear buffers (M0AR / M1AR). The bottom half refills the idle
+ * buffer while the other one drains, so the line never goes idle
+ * between chunks. The stop decision is taken before the hardware can
+ * switch: at the half-transfer point of each buffer, if the idle one
+ * has not been refilled (producer ran dry), the stream is disabled
+ * right there and the unsent rest of the current buffer, then the
+ * backlog, go out in normal mode. Half a buffer (32 bytes) is more
+ * than the 16-byte FIFO, so the idle buffer is never prefetched.
+ *
+ * With UART_DMA_FIFO set, the stream runs through the DMA FIFO and
+ * reads memory in words (and 4-word bursts) whenever the chunk
+ * address and length allow it, cutting AHB transactions per byte
+ * from 1 to 1/4 (or 1/16 per burst arbitration).
  **/
 
 #include "uart.h"
 #include "stm32f4xx_ll_usart.h"
 #include "stm32f4xx_ll_dma.h"
+#include "stm32f4xx_ll_bus.h"
+#include "stm32f4xx_ll_gpio.h"
 #include "circbuf.h"
+#include "defer.h"
+#include "irq_prio.h"
+#include "clock.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdio.h>
+
+// DMA stream flag bits, relative to the stream's group in LISR / HISR
+#define UART_DMA_FLAG_FE 0x01U // FIFO error
+#define UART_DMA_FLAG_DME 0x04U // direct mode error
+#define UART_DMA_FLAG_TE 0x08U // transfer error
+#define UART_DMA_FLAG_HT 0x10U // half transfer
+#define UART_DMA_FLAG_TC 0x20U // transfer complete
+#define UART_DMA_FLAG_ALL (UART_DMA_FLAG_FE | UART_DMA_FLAG_DME | UART_DMA_FLAG_TE | UART_DMA_FLAG_HT | UART_DMA_FLAG_TC)
+
+typedef struct {
+
+	USART_TypeDef* Instance; // USART
+	bool apb2; // bus the USART is clocked from
+	uint32_t usart_clock; // LL_APBx_GRP1_PERIPH_ mask
+	GPIO_TypeDef* tx_port; // TX pin
+	uint32_t tx_pin;
+	uint32_t tx_af; // alternate function of the TX pin
+	uint32_t gpio_clock; // LL_AHB1_GRP1_PERIPH_GPIOx
+	DMA_TypeDef* DMA; // DMA controller with the TX request
+	uint32_t dma_clock; // LL_AHB1_GRP1_PERIPH_DMAx
+	uint32_t stream; // LL_DMA_STREAM_x
+	uint32_t channel; // LL_DMA_CHANNEL_x
+	IRQn_Type irq; // stream interrupt
+	DEFER_Work_t work; // TX bottom-half work item
+
+} UART_PortConfig_t;
+
+// port table, indexed by UART_Port_t (RM0390 table 28 / 29, DS10693 table 11)
+static const UART_PortConfig_t uart_port[UART_PORT_COUNT] = {
+
+	[UART_PORT_USART1] = { USART1, true, LL_APB2_GRP1_PERIPH_USART1, GPIOA, LL_GPIO_PIN_9, LL_GPIO_AF_7,
+			LL_AHB1_GRP1_PERIPH_GPIOA, DMA2, LL_AHB1_GRP1_PERIPH_DMA2, LL_DMA_STREAM_7, LL_DMA_CHANNEL_4, DMA2_Stream7_IRQn, DEFER_UART1_TX },
+
+	[UART_PORT_USART2] = { USART2, false, LL_APB1_GRP1_PERIPH_USART2, GPIOA, LL_GPIO_PIN_2, LL_GPIO_AF_7,
+			LL_AHB1_GRP1_PERIPH_GPIOA, DMA1, LL_AHB1_GRP1_PERIPH_DMA1, LL_DMA_STREAM_6, LL_DMA_CHANNEL_4, DMA1_Stream6_IRQn, DEFER_UART2_TX },
+
+	[UART_PORT_USART3] = { USART3, false, LL_APB1_GRP1_PERIPH_USART3, GPIOB, LL_GPIO_PIN_10, LL_GPIO_AF_7,
+			LL_AHB1_GRP1_PERIPH_GPIOB, DMA1, LL_AHB1_GRP1_PERIPH_DMA1, LL_DMA_STREAM_3, LL_DMA_CHANNEL_4, DMA1_Stream3_IRQn, DEFER_UART3_TX },
+
+	[UART_PORT_UART4] = { UART4, false, LL_APB1_GRP1_PERIPH_UART4, GPIOA, LL_GPIO_PIN_0, LL_GPIO_AF_8,
+			LL_AHB1_GRP1_PERIPH_GPIOA, DMA1, LL_AHB1_GRP1_PERIPH_DMA1, LL_DMA_STREAM_4, LL_DMA_CHANNEL_4, DMA1_Stream4_IRQn, DEFER_UART4_TX },
+};
 
 // initialize // global UART_Handle_t instance
 UART_Handle_t uart;
 
+#ifdef UART_AUX_ENABLE
+_Static_assert(UART_AUX_PORT != UART_PORT_USART2 && UART_AUX_PORT < UART_PORT_COUNT,
+		"UART_AUX_PORT must be USART1, USART3 or UART4 (USART2 is 'uart')");
+
+// initialize second port instance and its buffer
+UART_Handle_t uart_aux;
+CircBuf auxbuf;
+#endif
+
+/**
+  * @brief  Test DMA stream flags of the port
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  flags UART_DMA_FLAG_ bits
+  * @retval true if any of them is set
+**/
+static inline bool uart_dma_flag(const UART_Handle_t* uart, uint32_t flags) {
+	return ((*uart->dma_isr >> uart->dma_shift) & flags) != 0;
+}
+
+/**
+  * @brief  Clear DMA stream flags of the port
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  flags UART_DMA_FLAG_ bits
+  * @retval Void
+**/
+static inline void uart_dma_clear(const UART_Handle_t* uart, uint32_t flags) {
+	*uart->dma_ifcr = flags << uart->dma_shift;
+}
+
+// defer module adapter for the TX bottom half
+static void uart_tx_bottom_half(void* ctx) {
+	uart_service_tx((UART_Handle_t*)ctx);
+}
+
+/**
+  * @brief  Select memory access width / burst for the next transfer
+  * @note   Stream must be disabled. NDTR counts bytes (PSIZE = byte), so word
+  *         reads need a word-aligned address and a length that is a multiple
+  *         of 4. A 4-beat burst (16 bytes) must not cross a 1 KB boundary, so
+  *         it also needs a 16-byte aligned address and a multiple of 16 bytes.
+  *         The generated init leaves the stream at SINGLE; only this picks the burst.
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  addr Memory start address
+  * @param  len Transfer length in bytes
+  * @retval Void
+**/
+static void uart_dma_set_access(UART_Handle_t* uart, uint32_t addr, uint32_t len) {
+
+#if UART_DMA_FIFO
+	if (((addr | len) & 3U) == 0) {
+		LL_DMA_SetMemorySize(uart->DMA, uart->DMA_Stream, LL_DMA_MDATAALIGN_WORD);
+		if (UART_DMA_BURST_BEATS == 4 && ((addr | len) & 15U) == 0) {
+			LL_DMA_SetMemoryBurstxfer(uart->DMA, uart->DMA_Stream, LL_DMA_MBURST_INC4);
+		} else {
+			LL_DMA_SetMemoryBurstxfer(uart->DMA, uart->DMA_Stream, LL_DMA_MBURST_SINGLE);
+		}
+		uart->tx_word_xfers++;
+		return;
+	}
+#endif
+
+	// unaligned chunk (or direct mode): one byte per memory access
+	LL_DMA_SetMemorySize(uart->DMA, uart->DMA_Stream, LL_DMA_MDATAALIGN_BYTE);
+	LL_DMA_SetMemoryBurstxfer(uart->DMA, uart->DMA_Stream, LL_DMA_MBURST_SINGLE);
+	uart->tx_byte_xfers++;
+}
+
+/**
+  * @brief  Start a single-buffer (normal mode) transfer
+  * @note   Stream must be disabled; 'uart->tx_length' is set by the caller
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  *buf First byte to send
+  * @param  len Number of bytes
+  * @retval Void
+**/
+static void uart_start_normal(UART_Handle_t* uart, uint8_t* buf, uint32_t len) {
+
+	uart->tx_buffer = buf;
+
+	// set tx state to active
+	uart->tx_state = UART_TX_ACTIVE;
+
+	// single-buffer normal mode (may follow a DBM stop)
+	LL_DMA_DisableIT_HT(uart->DMA, uart->DMA_Stream);
+	LL_DMA_DisableDoubleBufferMode(uart->DMA, uart->DMA_Stream);
+	LL_DMA_SetMode(uart->DMA, uart->DMA_Stream, LL_DMA_MODE_NORMAL);
+	LL_USART_EnableDMAReq_TX(uart->Instance);
+
+	// set DMA memory address and transfer length
+	LL_DMA_SetMemoryAddress(uart->DMA, uart->DMA_Stream, (uint32_t)buf);
+	LL_DMA_SetDataLength(uart->DMA, uart->DMA_Stream, len);
+	uart_dma_set_access(uart, (uint32_t)buf, len);
+
+	// enable stream (start transfer)
+	LL_DMA_EnableStream(uart->DMA, uart->DMA_Stream);
+}
+
+/**
+  * @brief  Fill both buffers from the backlog and start DBM streaming
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @retval Void
+**/
+static void uart_start_dbm(UART_Handle_t* uart) {
+
+	// preload both halves
+	circbuf_read(uart->circ_buffer, uart->dbm_buf[0], UART_DBM_CHUNK);
+	circbuf_read(uart->circ_buffer, uart->dbm_buf[1], UART_DBM_CHUNK);
+	uart->dbm_fresh[0] = 1;
+	uart->dbm_fresh[1] = 1;
+	uart->dbm_idle = 1; // M1AR waits while M0AR goes out
+	uart->dbm_stopping = 0;
+	uart->tx_length = 0; // data already taken out of circbuf
+
+	// configure double-buffer circular transfer, starting on M0AR
+	LL_DMA_SetMode(uart->DMA, uart->DMA_Stream, LL_DMA_MODE_CIRCULAR);
+	LL_DMA_SetMemoryAddress(uart->DMA, uart->DMA_Stream, (uint32_t)uart->dbm_buf[0]);
+	LL_DMA_SetMemory1Address(uart->DMA, uart->DMA_Stream, (uint32_t)uart->dbm_buf[1]);
+	LL_DMA_SetCurrentTargetMem(uart->DMA, uart->DMA_Stream, LL_DMA_CURRENTTARGETMEM0);
+	LL_DMA_EnableDoubleBufferMode(uart->DMA, uart->DMA_Stream);
+	LL_DMA_SetDataLength(uart->DMA, uart->DMA_Stream, UART_DBM_CHUNK);
+	uart_dma_set_access(uart, (uint32_t)uart->dbm_buf[0], UART_DBM_CHUNK);
+
+	// half transfer is the stop decision point (flags must be clear before EN)
+	uart_dma_clear(uart, UART_DMA_FLAG_HT | UART_DMA_FLAG_TC);
+	LL_DMA_EnableIT_HT(uart->DMA, uart->DMA_Stream);
+
+	// enable stream (start streaming)
+	uart->tx_state = UART_TX_STREAMING;
+	LL_USART_EnableDMAReq_TX(uart->Instance);
+	LL_DMA_EnableStream(uart->DMA, uart->DMA_Stream);
+}
+
+/**
+  * @brief  Top half of a DBM half transfer: keep streaming or stop here
+  * @note   Runs before the hardware can reach the idle buffer, so a buffer
+  *         that was not refilled is never sent twice
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @retval Void
+**/
+RAMFUNC static void uart_dbm_half(UART_Handle_t* uart) {
+
+	if (uart->dbm_fresh[uart->dbm_idle]) {
+		return;
+	}
+
+	// producer ran dry: stop inside the current buffer, the bottom half sends its rest
+	LL_DMA_DisableStream(uart->DMA, uart->DMA_Stream);
+	uart->dbm_stopping = 1;
+	uart->dbm_stops++;
+	uart->tx_state = UART_TX_WAIT_DISABLE;
+	uart->tx_wait_start = PERF_CYCLES();
+}
+
+/**
+  * @brief  Top half of a DBM buffer switch
+  * @note   The buffer now being sent was refilled, or the stream was stopped at its predecessor's HT
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @retval Void
+**/
+RAMFUNC static void uart_dbm_switch(UART_Handle_t* uart) {
+
+	// hardware has already moved on; the buffer it left is now idle
+	uint8_t next = (LL_DMA_GetCurrentTargetMem(uart->DMA, uart->DMA_Stream) == LL_DMA_CURRENTTARGETMEM1) ? 1 : 0;
+	uart->dbm_fresh[next ^ 1] = 0;
+	uart->dbm_idle = next ^ 1;
+	uart->tx_tc_cycles = PERF_CYCLES();
+}
+
+/**
+  * @brief  Bottom half of a DBM buffer switch: refill the idle buffer
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @retval Void
+**/
+static void uart_dbm_refill(UART_Handle_t* uart) {
+
+	// decide and copy with transport IRQs masked, so no switch or stop can
+	// land in between: circbuf is only consumed for a refill that is kept
+	uint32_t basepri = __get_BASEPRI();
+	__set_BASEPRI(IRQ_PRIO_TRANSPORT << (8U - __NVIC_PRIO_BITS));
+
+	uint8_t idle = uart->dbm_idle;
+	if (uart->tx_state != UART_TX_STREAMING || uart->dbm_fresh[idle]
+			|| circbuf_count(uart->circ_buffer) < UART_DBM_CHUNK) {
+		__set_BASEPRI(basepri);
+		return;
+	}
+	circbuf_read(uart->circ_buffer, uart->dbm_buf[idle], UART_DBM_CHUNK);
+	uart->dbm_fresh[idle] = 1;
+
+	__set_BASEPRI(basepri);
+
+	perf_record(&uart->dbm_refill, PERF_CYCLES() - uart->tx_tc_cycles);
+}
+
+/**
+  * @brief  After a DBM stop, send the rest of the buffer that was interrupted
+  * @note   Stream disabled; NDTR holds the bytes not yet written to DR and
+  *         CT still points to the interrupted buffer
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @retval true if a transfer was started
+**/
+static bool uart_dbm_resume(UART_Handle_t* uart) {
+
+	uint32_t rest = LL_DMA_GetDataLength(uart->DMA, uart->DMA_Stream);
+	uint8_t cur = (LL_DMA_GetCurrentTargetMem(uart->DMA, uart->DMA_Stream) == LL_DMA_CURRENTTARGETMEM1) ? 1 : 0;
+
+	uart->dbm_stopping = 0;
+	if (rest == 0 || rest > UART_DBM_CHUNK) {
+		return false;
+	}
+
+	// these bytes already left circbuf: nothing to advance on completion
+	uart->tx_length = 0;
+	uart_start_normal(uart, &uart->dbm_buf[cur][UART_DBM_CHUNK - rest], rest);
+	return true;
+}
+
 /**
   * @brief  Initialize uart module
+  * @note   Sets up the TX pin, USART (8N1) and DMA stream of the port
   * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  port USART to drive
+  * @param  baudrate Line rate
   * @param  *circ_buf Pointer to CircBuf instance
   * @retval Void
 **/
-void uart_init(UART_Handle_t* uart, CircBuf* circ_buf) {
+void uart_init(UART_Handle_t* uart, UART_Port_t port, uint32_t baudrate, CircBuf* circ_buf) {
+
+	// flag group offsets of streams 0..3 (LISR) and 4..7 (HISR)
+	static const uint8_t flag_shift[4] = { 0, 6, 16, 22 };
+
+	const UART_PortConfig_t* cfg = &uart_port[((uint32_t)port < UART_PORT_COUNT) ? port : UART_PORT_USART2];
 
 	// initialize software state
-	uart->Instance = USART2;
-	uart->DMA_Stream = LL_DMA_STREAM_6;
+	uart->Instance = cfg->Instance;
+	uart->DMA = cfg->DMA;
+	uart->DMA_Stream = cfg->stream;
+	uart->dma_isr = (cfg->stream < 4) ? &cfg->DMA->LISR : &cfg->DMA->HISR;
+	uart->dma_ifcr = (cfg->stream < 4) ? &cfg->DMA->LIFCR : &cfg->DMA->HIFCR;
+	uart->dma_shift = flag_shift[cfg->stream & 3U];
+	uart->defer_work = cfg->work;
+	uart->apb2 = cfg->apb2;
+	uart->baudrate = baudrate;
 	uart->circ_buffer = circ_buf;
 	uart->tx_buffer = NULL;
 	uart->tx_length = 0;
-	uart->tx_busy = false;
+	uart->tx_state = UART_TX_IDLE;
+	uart->tx_errors = 0;
+	uart->tx_wait_start = 0;
+	perf_reset(&uart->tx_wait);
+	uart->tx_tc_cycles = 0;
+	perf_reset(&uart->tx_gap);
+	uart->continuous = true;
+	uart->dbm_fresh[0] = 0;
+	uart->dbm_fresh[1] = 0;
+	uart->dbm_idle = 0;
+	uart->dbm_stopping = 0;
+	uart->dbm_stops = 0;
+	perf_reset(&uart->dbm_refill);
+	uart->tx_word_xfers = 0;
+	uart->tx_byte_xfers = 0;
+
+	// peripheral clocks
+	LL_AHB1_GRP1_EnableClock(cfg->gpio_clock);
+	LL_AHB1_GRP1_EnableClock(cfg->dma_clock);
+	if (cfg->apb2) {
+		LL_APB2_GRP1_EnableClock(cfg->usart_clock);
+	} else {
+		LL_APB1_GRP1_EnableClock(cfg->usart_clock);
+	}
+
+	// TX pin to the USART (RX, if any, stays as configured by CubeMX)
+	LL_GPIO_SetPinMode(cfg->tx_port, cfg->tx_pin, LL_GPIO_MODE_ALTERNATE);
+	LL_GPIO_SetPinSpeed(cfg->tx_port, cfg->tx_pin, LL_GPIO_SPEED_FREQ_VERY_HIGH);
+	LL_GPIO_SetPinOutputType(cfg->tx_port, cfg->tx_pin, LL_GPIO_OUTPUT_PUSHPULL);
+	LL_GPIO_SetPinPull(cfg->tx_port, cfg->tx_pin, LL_GPIO_PULL_NO);
+	if (cfg->tx_pin <= LL_GPIO_PIN_7) {
+		LL_GPIO_SetAFPin_0_7(cfg->tx_port, cfg->tx_pin, cfg->tx_af);
+	} else {
+		LL_GPIO_SetAFPin_8_15(cfg->tx_port, cfg->tx_pin, cfg->tx_af);
+	}
 
-	// ensure DMA stream 6 is disabled
-	LL_DMA_DisableStream(DMA1, uart->DMA_Stream);
+	// 8N1, transmitter on (the receiver bit is left alone)
+	LL_USART_Disable(uart->Instance);
+	LL_USART_SetDataWidth(uart->Instance, LL_USART_DATAWIDTH_8B);
+	LL_USART_SetParity(uart->Instance, LL_USART_PARITY_NONE);
+	LL_USART_SetStopBitsLength(uart->Instance, LL_USART_STOPBITS_1);
+	LL_USART_SetHWFlowCtrl(uart->Instance, LL_USART_HWCONTROL_NONE);
+	LL_USART_ConfigAsyncMode(uart->Instance);
+	LL_USART_EnableDirectionTx(uart->Instance);
+
+	// ensure the DMA stream is disabled
+	LL_DMA_DisableStream(uart->DMA, uart->DMA_Stream);
 
 	// clear all DMA flags
-	LL_DMA_ClearFlag_TC6(DMA1);
-	LL_DMA_ClearFlag_TE6(DMA1);
-	LL_DMA_ClearFlag_FE6(DMA1);
-	LL_DMA_ClearFlag_DME6(DMA1);
-	LL_DMA_ClearFlag_HT6(DMA1);
+	uart_dma_clear(uart, UART_DMA_FLAG_ALL);
+
+	// baud rate for the active clock profile
+	uart_set_clock(uart, uart->apb2 ? sysclk.pclk2_hz : sysclk.pclk1_hz);
+
+	// memory -> USART DR, one byte per request
+	LL_DMA_SetChannelSelection(uart->DMA, uart->DMA_Stream, cfg->channel);
+	LL_DMA_SetDataTransferDirection(uart->DMA, uart->DMA_Stream, LL_DMA_DIRECTION_MEMORY_TO_PERIPH);
+	LL_DMA_SetStreamPriorityLevel(uart->DMA, uart->DMA_Stream, LL_DMA_PRIORITY_LOW);
+	LL_DMA_SetPeriphIncMode(uart->DMA, uart->DMA_Stream, LL_DMA_PERIPH_NOINCREMENT);
+	LL_DMA_SetMemoryIncMode(uart->DMA, uart->DMA_Stream, LL_DMA_MEMORY_INCREMENT);
+	LL_DMA_SetPeriphSize(uart->DMA, uart->DMA_Stream, LL_DMA_PDATAALIGN_BYTE);
 
 	// set DMA peripheral address
-	LL_DMA_SetPeriphAddress(DMA1, uart->DMA_Stream, (uint32_t)&USART2->DR);
+	LL_DMA_SetPeriphAddress(uart->DMA, uart->DMA_Stream, (uint32_t)&uart->Instance->DR);
+
+	// FIFO / burst configuration (peripheral side stays single byte writes)
+#if UART_DMA_FIFO
+	LL_DMA_EnableFifoMode(uart->DMA, uart->DMA_Stream);
+	LL_DMA_SetFIFOThreshold(uart->DMA, uart->DMA_Stream, UART_DMA_FIFO_THRESHOLD);
+#else
+	LL_DMA_DisableFifoMode(uart->DMA, uart->DMA_Stream);
+#endif
+	LL_DMA_SetPeriphBurstxfer(uart->DMA, uart->DMA_Stream, LL_DMA_PBURST_SINGLE);
 
 	// enable USART DMA TX request
 	LL_USART_EnableDMAReq_TX(uart->Instance);
 
-	// enable DMA transfer complete interrupt
-	LL_DMA_EnableIT_TC(DMA1, uart->DMA_Stream);
+	// enable DMA transfer complete + transfer error interrupts
+	LL_DMA_EnableIT_TC(uart->DMA, uart->DMA_Stream);
+	LL_DMA_EnableIT_TE(uart->DMA, uart->DMA_Stream);
+
+	// stream interrupt (priority from 'irq_prio_init')
+	NVIC_EnableIRQ(cfg->irq);
+
+	// register TX bottom half
+	defer_register(&defer, uart->defer_work, uart_tx_bottom_half, uart);
 
 }
 
+/**
+  * @brief  DMA stream interrupt of a port
+  * @param  port USART
+  * @retval IRQ number from the port table
+**/
+IRQn_Type uart_port_irq(UART_Port_t port) {
+	return uart_port[((uint32_t)port < UART_PORT_COUNT) ? port : UART_PORT_USART2].irq;
+}
+
+/**
+  * @brief  Recompute BRR for a new bus clock
+  * @note   TX must be idle (no frame on the line)
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  pclk_hz APB2 clock if 'uart->apb2', APB1 clock otherwise, in Hz
+  * @retval Void
+**/
+void uart_set_clock(UART_Handle_t* uart, uint32_t pclk_hz) {
+
+	// BRR may only change while the USART is disabled
+	LL_USART_Disable(uart->Instance);
+	LL_USART_SetBaudRate(uart->Instance, pclk_hz, LL_USART_OVERSAMPLING_16, uart->baudrate);
+	LL_USART_Enable(uart->Instance);
+}
+
 /**
   * @brief  Send largest contiguous chunk of data from circular buffer over DMA
+  * @note   Only starts a transfer from UART_TX_IDLE; never waits
   * @param  *uart Pointer to the UART_Handle_t instance
   * @retval Void
 **/
 void uart_send_dma(UART_Handle_t* uart) {
 
-	// check if tx busy; return
-	if (uart->tx_busy) {
+	// only an idle engine may be reconfigured
+	if (uart->tx_state != UART_TX_IDLE) {
+		return;
+	}
+
+	uint16_t count = circbuf_count(uart->circ_buffer);
+	if (count == 0) {
+		return;
+	}
+
+	// stream should be disabled in IDLE; if not, stop it and resume on its TC
+	if (LL_DMA_IsEnabledStream(uart->DMA, uart->DMA_Stream)) {
+		uart->tx_state = UART_TX_WAIT_DISABLE;
+		uart->tx_wait_start = PERF_CYCLES();
+		LL_DMA_DisableStream(uart->DMA, uart->DMA_Stream);
+		return;
+	}
+
+	// enough backlog for gapless output: stream in double-buffer mode
+	if (uart->continuous && count >= 2 * UART_DBM_CHUNK) {
+		uart_start_dbm(uart);
 		return;
 	}
 
@@ -75,63 +496,121 @@ void uart_send_dma(UART_Handle_t* uart) {
 	uint16_t chunk_len;
 	circbuf_peek_contiguous(uart->circ_buffer, &chunk_ptr, &chunk_len);
 
-	// set tx_buffer and tx_length fields
-	uart->tx_buffer = chunk_ptr;
+	// retire chunk_len bytes from circbuf once the transfer completes
 	uart->tx_length = chunk_len;
-	if (uart->tx_length == 0) {
-		return;
-	}
+	uart_start_normal(uart, chunk_ptr, chunk_len);
 
-	// set tx state to busy
-	uart->tx_busy = true;
+	return;
 
-	// wait until DMA stream is fully idle
-	LL_DMA_DisableStream(DMA1, uart->DMA_Stream);
-	while (LL_DMA_IsEnabledStream(DMA1, uart->DMA_Stream));
+}
 
-	// set DMA memory address and transfer length
-	LL_DMA_SetMemoryAddress(DMA1, uart->DMA_Stream, (uint32_t)uart->tx_buffer);
-	LL_DMA_SetDataLength(DMA1, uart->DMA_Stream, uart->tx_length);
+/**
+  * @brief  Enable / disable continuous (double-buffer) streaming
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  enable true to allow DBM streaming
+  * @retval Void
+**/
+void uart_set_continuous(UART_Handle_t* uart, bool enable) {
 
-	// enable stream (start transfer)
-	LL_DMA_EnableStream(DMA1, uart->DMA_Stream);
+	// takes effect at the next transfer start
+	uart->continuous = enable;
+}
 
-	return;
+/**
+  * @brief  Acknowledge DMA flags, defer buffer advance / re-arm to PendSV
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @retval Void
+**/
+RAMFUNC void uart_handle_dma_irq(UART_Handle_t* uart) {
+
+	// DBM half transfer: last point to stop before the idle buffer (before TC if both are pending)
+	if (uart->tx_state == UART_TX_STREAMING && uart_dma_flag(uart, UART_DMA_FLAG_HT)) {
+		uart_dma_clear(uart, UART_DMA_FLAG_HT);
+		uart_dbm_half(uart);
+	}
+
+	// transfer complete
+	if (uart_dma_flag(uart, UART_DMA_FLAG_TC)) {
+		uart_dma_clear(uart, UART_DMA_FLAG_TC);
+
+		if (uart->tx_state == UART_TX_STREAMING) {
+			// DBM: one half drained, hardware already on the other
+			uart_dbm_switch(uart);
+		} else if (uart->tx_state == UART_TX_ACTIVE) {
+			// normal mode: hardware has already cleared EN
+			uart->tx_state = UART_TX_COMPLETE;
+			uart->tx_tc_cycles = PERF_CYCLES();
+		}
+		defer_post(&defer, uart->defer_work);
+	}
+
+	// transfer error: hardware disables the stream, drop the chunk
+	if (uart_dma_flag(uart, UART_DMA_FLAG_TE)) {
+		uart_dma_clear(uart, UART_DMA_FLAG_TE);
+		uart->tx_errors++;
+		uart->dbm_stopping = 0;
+		uart->tx_state = UART_TX_COMPLETE;
+		defer_post(&defer, uart->defer_work);
+	}
 
+	// clear all other potential flags
+	if (uart_dma_flag(uart, UART_DMA_FLAG_DME | UART_DMA_FLAG_FE)) {
+		uart_dma_clear(uart, UART_DMA_FLAG_DME | UART_DMA_FLAG_FE);
+	}
+	return;
 }
 
 /**
-  * @brief  Reset flags after DMA tranfer complete, recur if more data in buffer
+  * @brief  Bottom half: retire completed chunk, start next chunk if any
+  * @note   Called from PendSV via the defer module
   * @param  *uart Pointer to the UART_Handle_t instance
   * @retval Void
 **/
-void uart_handle_dma_irq(UART_Handle_t* uart) {
+void uart_service_tx(UART_Handle_t* uart) {
+
+	switch (uart->tx_state) {
 
-	// if transfer complete flag enabled, clear flag, set tx_busy to false
-	if (LL_DMA_IsActiveFlag_TC6(DMA1)) {
-		LL_DMA_ClearFlag_TC6(DMA1);
-		uart->tx_busy = false;
+	case UART_TX_STREAMING:
+		// refill idle half while the other drains; never start a normal transfer
+		uart_dbm_refill(uart);
+		return;
 
-		// advance circbuf by tx_length
+	case UART_TX_COMPLETE:
+		// retire chunk that just finished: advance circbuf by tx_length
 		circbuf_advance(uart->circ_buffer, uart->tx_length);
+		uart->tx_state = UART_TX_IDLE;
 
-		// if more data, send again
+		// back-to-back data: line idles from TC until the next enable
 		if (circbuf_count(uart->circ_buffer) > 0) {
 			uart_send_dma(uart);
+			if (uart->tx_state != UART_TX_IDLE) {
+				perf_record(&uart->tx_gap, PERF_CYCLES() - uart->tx_tc_cycles);
+			}
 		}
-	}
+		return;
 
-	// clear all other potential flags
-	if (LL_DMA_IsActiveFlag_TE6(DMA1)) {
-		LL_DMA_ClearFlag_TE6(DMA1);
-	}
-	if (LL_DMA_IsActiveFlag_DME6(DMA1)) {
-		LL_DMA_ClearFlag_DME6(DMA1);
+	case UART_TX_WAIT_DISABLE:
+		// still enabled: the TC raised once the stream stops posts this again
+		if (LL_DMA_IsEnabledStream(uart->DMA, uart->DMA_Stream)) {
+			return;
+		}
+		perf_record(&uart->tx_wait, PERF_CYCLES() - uart->tx_wait_start);
+		uart->tx_state = UART_TX_IDLE;
+
+		// DBM stop: the rest of the interrupted buffer goes before the backlog
+		if (uart->dbm_stopping && uart_dbm_resume(uart)) {
+			return;
+		}
+		break;
+
+	default:
+		break;
 	}
-	if (LL_DMA_IsActiveFlag_FE6(DMA1)) {
-		LL_DMA_ClearFlag_FE6(DMA1);
+
+	// if more data, send again
+	if (circbuf_count(uart->circ_buffer) > 0) {
+		uart_send_dma(uart);
 	}
-	return;
 }
 
 /**
@@ -143,7 +622,7 @@ void uart_handle_dma_irq(UART_Handle_t* uart) {
 **/
 void uart_printf(UART_Handle_t* uart, char* str) {
 
-	while (uart->tx_busy) {
+	while (uart->tx_state != UART_TX_IDLE) {
 	}
 
     while (*str != '\0') {
@@ -163,7 +642,7 @@ void uart_printf(UART_Handle_t* uart, char* str) {
 
 /**
   * @brief  Print string to console using circular buffer and DMA
-  * @note   This function uses the 'uart_send_dma' function
+  * @note   DMA is (re)started from PendSV via 'uart_service_tx'
   * @param  *uart Pointer to the UART_Handle_t instance
   * @param  *str  Pointer to first char in string
   * @retval Void
@@ -176,9 +655,41 @@ void uart_DMA_printf(UART_Handle_t* uart, char* str)
         str++;
     }
 
-    // send DMA if not already active
-    if (!uart->tx_busy) {
-            uart_send_dma(uart);
+    // kick the bottom half; it starts DMA if not already active
+    defer_post(&defer, uart->defer_work);
+}
+
+/**
+  * @brief  Queue raw bytes (binary frames) using circular buffer and DMA
+  * @note   Same path as 'uart_DMA_printf', but NUL bytes are sent too
+  * @param  *uart Pointer to the UART_Handle_t instance
+  * @param  *data Pointer to first byte
+  * @param  len Number of bytes
+  * @retval Void
+**/
+void uart_DMA_write(UART_Handle_t* uart, const uint8_t* data, uint16_t len)
+{
+    // write all bytes to circular buffer
+    for (uint16_t i = 0; i < len; i++) {
+        circbuf_write_byte(uart->circ_buffer, data[i]);
     }
+
+    // kick the bottom half; it starts DMA if not already active
+    defer_post(&defer, uart->defer_work);
 }
 
+/**
+  * @brief  Format a non-negative value with a fixed number of decimals
+  * @note   Report lines without the float printf support of newlib-nano
+  * @param  *buf Output buffer
+  * @param  size Buffer size
+  * @param  v Value
+  * @param  scale 10^decimals
+  * @param  decimals Number of decimals
+  * @retval Void
+**/
+void uart_format_fixed(char* buf, size_t size, float v, uint32_t scale, uint32_t decimals) {
+
+	uint32_t x = (uint32_t)(v * (float)scale + 0.5f);
+	snprintf(buf, size, "%lu.%0*lu", (unsigned long)(x / scale), (int)decimals, (unsigned long)(x % scale));
+}
@@ -0,0 +1,109 @@
+/**
+ * weighting.c
+ * ------------
+ * A / C frequency weighting (IEC 61672-1) ahead of the level detectors.
+ *
+ * Float DF2T biquad cascades with coefficients generated by
+ * tools/gen_tables.py for the ADC sample rate, 0 dB at 1 kHz.
+ * Output is re-biased to mid-rail and clamped to 12 bits so the
+ * envelope filter and RMS meter take it like a raw block.
+ **/
+
+#include "weighting.h"
+#include "adc.h"
+#include "timer.h"
+#include "dsp_tables.h"
+#include <stdint.h>
+#include <string.h>
+
+#if (TIM2_RATE_HZ) != DSP_WEIGHT_FS_HZ
+#error "weighting tables were generated for another sample rate; update WEIGHT_FS in tools/gen_tables.py"
+#endif
+
+#define WEIGHT_COEFS 5 // {b0, b1, b2, a1, a2} per section
+
+// initialize global WEIGHT_Handle_t instance
+WEIGHT_Handle_t weight;
+
+/**
+  * @brief  Initialize the weighting filter
+  * @param  *w Pointer to the WEIGHT_Handle_t instance
+  * @param  mode Z (flat), A or C
+  * @retval Void
+**/
+void weighting_init(WEIGHT_Handle_t* w, WEIGHT_Mode_t mode) {
+
+	weighting_set_mode(w, mode);
+}
+
+/**
+  * @brief  Select the weighting, clears the filter state
+  * @param  *w Pointer to the WEIGHT_Handle_t instance
+  * @param  mode Z (flat), A or C
+  * @retval Void
+**/
+void weighting_set_mode(WEIGHT_Handle_t* w, WEIGHT_Mode_t mode) {
+
+	w->mode = mode;
+	if (mode == WEIGHT_A) {
+		w->coef = dsp_weight_a;
+		w->sections = DSP_WEIGHT_A_SECTIONS;
+	} else if (mode == WEIGHT_C) {
+		w->coef = dsp_weight_c;
+		w->sections = DSP_WEIGHT_C_SECTIONS;
+	} else {
+		w->coef = NULL;
+		w->sections = 0;
+	}
+	memset(w->state, 0, sizeof(w->state));
+}
+
+/**
+  * @brief  Weight a block of raw ADC samples
+  * @note   Called from the ADC bottom half. Output keeps the raw format
+  *         (12-bit, mid-rail biased, clamped) so the detectors are unchanged
+  * @param  *w Pointer to the WEIGHT_Handle_t instance
+  * @param  *blk Raw 12-bit samples
+  * @param  *out Output buffer, 'len' samples
+  * @param  len Number of samples
+  * @retval 'blk' when flat, otherwise 'out'
+**/
+RAMFUNC const uint16_t* weighting_process_block(WEIGHT_Handle_t* w, const uint16_t* blk, uint16_t* out, uint32_t len) {
+
+	if (w->sections == 0) {
+		return blk;
+	}
+
+	for (uint32_t i = 0; i < len; i++) {
+		float x = (float)((int32_t)blk[i] - ADC_MIDRAIL);
+
+		// DF2T cascade
+		const float* c = w->coef;
+		for (uint32_t s = 0; s < w->sections; s++, c += WEIGHT_COEFS) {
+			float y = c[0] * x + w->state[s].s1;
+			w->state[s].s1 = c[1] * x - c[3] * y + w->state[s].s2;
+			w->state[s].s2 = c[2] * x - c[4] * y;
+			x = y;
+		}
+
+		// back to the raw format (round, re-bias, clamp to 12 bits)
+		int32_t v = (int32_t)(x + ((x < 0.0f) ? -0.5f : 0.5f)) + ADC_MIDRAIL;
+		if (v < 0) {
+			v = 0;
+		} else if (v > 4095) {
+			v = 4095;
+		}
+		out[i] = (uint16_t)v;
+	}
+	return out;
+}
+
+/**
+  * @brief  Weighting letter for reports
+  * @param  *w Pointer to the WEIGHT_Handle_t instance
+  * @retval 'Z', 'A' or 'C'
+**/
+char weighting_letter(WEIGHT_Handle_t* w) {
+
+	return (w->mode == WEIGHT_A) ? 'A' : (w->mode == WEIGHT_C) ? 'C' : 'Z';
+}
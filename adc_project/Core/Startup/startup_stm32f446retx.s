@@ -43,6 +43,10 @@ defined in linker script */
 .word  _sbss
 /* end address for the .bss section. defined in linker script */
 .word  _ebss
+/* load address, start and end of the .ramfunc section. defined in linker script */
+.word  _siramfunc
+.word  _sramfunc
+.word  _eramfunc
 /* stack used for SystemInit_ExtMemCtl; always internal RAM used */
 
 /**
@@ -79,6 +83,23 @@ LoopCopyDataInit:
   adds r4, r0, r3
   cmp r4, r1
   bcc CopyDataInit
+
+/* Copy the RAMFUNC code from flash to SRAM */
+  ldr r0, =_sramfunc
+  ldr r1, =_eramfunc
+  ldr r2, =_siramfunc
+  movs r3, #0
+  b LoopCopyRamFunc
+
+CopyRamFunc:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyRamFunc:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyRamFunc
   
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
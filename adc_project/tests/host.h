@@ -0,0 +1,29 @@
+/**
+ * host.h
+ * -------
+ * Host build shims, force-included into every module under test.
+ *
+ * The Cortex-M4 DSP intrinsics used by the modules only exist in
+ * cmsis_gcc.h when __ARM_FEATURE_DSP is set; plain C versions with
+ * the same semantics stand in for them on the host.
+ **/
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+
+/**
+  * @brief  Dual 16 x 16 multiply with 32-bit accumulate (SMLAD)
+  * @param  x Two signed halfwords
+  * @param  y Two signed halfwords
+  * @param  acc Accumulator
+  * @retval acc + x.lo * y.lo + x.hi * y.hi
+**/
+static inline uint32_t __SMLAD(uint32_t x, uint32_t y, uint32_t acc) {
+	int32_t lo = (int32_t)(int16_t)x * (int16_t)y;
+	int32_t hi = (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+	return acc + (uint32_t)lo + (uint32_t)hi;
+}
+
+#endif
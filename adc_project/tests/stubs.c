@@ -0,0 +1,22 @@
+/**
+ * stubs.c
+ * --------
+ * Host stand-ins for the globals and output calls the modules under
+ * test reference but the tests do not exercise.
+ **/
+
+#include "adc.h"
+#include "uart.h"
+
+ADC_Handle_t adc;
+
+void uart_DMA_printf(UART_Handle_t* uart, char* str) {
+	(void)uart;
+	(void)str;
+}
+
+void uart_DMA_write(UART_Handle_t* uart, const uint8_t* data, uint16_t len) {
+	(void)uart;
+	(void)data;
+	(void)len;
+}
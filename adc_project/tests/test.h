@@ -0,0 +1,33 @@
+/**
+ * test.h
+ * -------
+ * Minimal check macros for the host tests.
+ *
+ * CHECK prints the failing condition with its location and counts
+ * the failure; TEST_END prints a summary and returns the exit code.
+ **/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+static int test_failures;
+static int test_checks;
+
+#define CHECK(cond, ...) do { \
+	test_checks++; \
+	if (!(cond)) { \
+		test_failures++; \
+		printf("%s:%d: FAIL %s: ", __FILE__, __LINE__, #cond); \
+		printf(__VA_ARGS__); \
+		printf("\n"); \
+	} \
+} while (0)
+
+#define TEST_END(name) do { \
+	printf("%s: %d checks, %d failed\n", (name), test_checks, test_failures); \
+	return test_failures ? 1 : 0; \
+} while (0)
+
+#endif
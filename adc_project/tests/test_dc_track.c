@@ -0,0 +1,80 @@
+/**
+ * test_dc_track.c
+ * ----------------
+ * DC-offset tracker: residual offset after settling.
+ *
+ * A 1 kHz, 400-count sine on a fixed bias is pushed through
+ * 'dc_process_block' for ten time constants at the default shift;
+ * the corrected output mean must then sit within half a count of
+ * ADC_MIDRAIL, and the published offset must follow the input mean.
+ * Integer biases come out exact; a fractional bias leaves the rounding
+ * of the offset to whole counts (up to 0.5 LSB) as the only error.
+ **/
+
+#include "dc_track.h"
+#include "adc.h"
+#include "test.h"
+#include <math.h>
+#include <stdint.h>
+
+#define FS_HZ 20000.0
+#define TONE_HZ 1000.0
+#define AMPLITUDE 400.0 // counts
+#define BLOCK 200 // samples per block (ten tone periods)
+#define SETTLE_TAU 10 // time constants before measuring
+#define MEASURE 100 // blocks measured
+#define MEAN_LSB 0.5 // output mean error, counts
+#define OFFSET_LSB 0.25 // tracked offset error, counts (see check_bias)
+
+static uint16_t blk[BLOCK];
+
+/**
+  * @brief  Run the tracker on a biased tone and check the settled output
+  * @param  bias Input bias, counts
+  * @retval Void
+**/
+static void check_bias(double bias) {
+
+	DC_Handle_t d;
+	uint32_t settle = ((1UL << DC_SHIFT_DEFAULT) * SETTLE_TAU) / BLOCK + 1;
+	uint32_t t = 0;
+	double in_sum = 0.0, out_sum = 0.0, offset_sum = 0.0;
+
+	dc_init(&d, DC_SHIFT_DEFAULT);
+	for (uint32_t b = 0; b < settle + MEASURE; b++) {
+		double block_in = 0.0;
+		for (uint32_t i = 0; i < BLOCK; i++, t++) {
+			blk[i] = (uint16_t)lrint(bias + AMPLITUDE * sin(2.0 * M_PI * TONE_HZ * t / FS_HZ));
+			block_in += blk[i];
+		}
+		dc_process_block(&d, blk, BLOCK);
+		if (b < settle) {
+			continue;
+		}
+		in_sum += block_in;
+		for (uint32_t i = 0; i < BLOCK; i++) {
+			out_sum += blk[i];
+		}
+		// published at the block end, so it carries the tone ripple of the
+		// one-pole (~0.16 counts here) and the Q16 shift's truncation (1/16)
+		offset_sum += d.offset_q16 / 65536.0;
+	}
+
+	double in_mean = in_sum / (MEASURE * BLOCK);
+	double out_err = out_sum / (MEASURE * BLOCK) - ADC_MIDRAIL;
+	double offset_err = offset_sum / MEASURE - in_mean;
+	printf("bias %.2f: output mean %+.3f counts from mid-rail, tracked offset %+.3f counts\n", bias, out_err, offset_err);
+	CHECK(fabs(out_err) <= MEAN_LSB, "bias %.2f: output mean %+.3f counts from mid-rail", bias, out_err);
+	CHECK(fabs(offset_err) <= OFFSET_LSB, "bias %.2f: tracked offset %+.3f counts from the input mean", bias, offset_err);
+}
+
+int main(void) {
+
+	static const double bias[] = { 1900.0, 2048.0, 2200.0, 1750.5, 1750.25, 2300.75 };
+
+	for (uint32_t i = 0; i < sizeof(bias) / sizeof(bias[0]); i++) {
+		check_bias(bias[i]);
+	}
+
+	TEST_END("test_dc_track");
+}
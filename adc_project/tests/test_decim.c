@@ -0,0 +1,128 @@
+/**
+ * test_decim.c
+ * -------------
+ * Alias rejection of the polyphase decimator (default table, M = 4).
+ *
+ * From the generated coefficients (tools/gen_tables.py), reassembled
+ * from polyphase order: flat passband up to DECIM_PASS, attenuation
+ * over the whole stopband from DECIM_STOP to the input Nyquist.
+ *
+ * End to end, tones at 20 kHz are pushed through 'decim_process_block':
+ * a passband tone comes out at its level, and every tone above the new
+ * 2.5 kHz Nyquist is measured at the frequency it folds onto, which
+ * must sit below the input by the stopband attenuation.
+ **/
+
+#include "decim.h"
+#include "adc.h"
+#include "test.h"
+#include <complex.h>
+#include <math.h>
+#include <stdint.h>
+
+#define FS_HZ 20000.0
+#define PASS 0.10 // passband edge, fraction of FS_HZ (gen_tables.py DECIM_PASS)
+#define STOP 0.15 // stopband edge (DECIM_STOP)
+#define RIPPLE_DB 0.05 // passband flatness, coefficients
+#define STOP_DB 65.0 // stopband attenuation, coefficients
+#define ALIAS_DB 60.0 // folded tone below the input, end to end (12-bit output)
+#define GAIN_DB 0.1 // passband tone level, end to end
+#define AMPLITUDE 1800.0 // tone amplitude, LSB
+
+#define OUT_LEN 4096 // output samples measured
+#define SETTLE 64 // output samples skipped (filter fill)
+#define IN_LEN ((OUT_LEN + SETTLE) * DSP_DECIM_FACTOR)
+
+static uint16_t in[IN_LEN];
+static uint16_t out[IN_LEN / DSP_DECIM_FACTOR + 1];
+
+/**
+  * @brief  Gain of the generated filter
+  * @param  f Frequency, fraction of the input rate
+  * @retval Gain in dB
+**/
+static double coef_db(double f) {
+
+	uint32_t len = DSP_DECIM_TAPS / DSP_DECIM_FACTOR;
+	double complex h = 0.0;
+	for (uint32_t p = 0; p < DSP_DECIM_FACTOR; p++) {
+		for (uint32_t l = 0; l < len; l++) {
+			uint32_t n = l * DSP_DECIM_FACTOR + p;
+			h += dsp_decim_coef[p * len + l] / 32768.0 * cexp(-I * 2.0 * M_PI * f * n);
+		}
+	}
+	return 20.0 * log10(cabs(h));
+}
+
+/**
+  * @brief  Tone through the decimator, measured at one output frequency
+  * @param  f Tone frequency, Hz
+  * @param  f_out Frequency measured at the output, Hz
+  * @retval Output / input amplitude in dB
+**/
+static double tone_db(double f, double f_out) {
+
+	DECIM_Handle_t d;
+	decim_init(&d, DSP_DECIM_FACTOR, DSP_DECIM_TAPS, dsp_decim_coef);
+
+	for (uint32_t i = 0; i < IN_LEN; i++) {
+		in[i] = (uint16_t)lrint(ADC_MIDRAIL + AMPLITUDE * sin(2.0 * M_PI * f * i / FS_HZ));
+	}
+	uint32_t n = decim_process_block(&d, in, out, IN_LEN);
+	CHECK(n == IN_LEN / DSP_DECIM_FACTOR, "%u outputs for %u inputs", (unsigned)n, (unsigned)IN_LEN);
+
+	// Hann-windowed single-bin DFT, mean removed
+	double mean = 0.0;
+	for (uint32_t i = SETTLE; i < n; i++) {
+		mean += out[i];
+	}
+	mean /= n - SETTLE;
+
+	double complex acc = 0.0;
+	double wsum = 0.0;
+	for (uint32_t i = SETTLE; i < n; i++) {
+		double w = 0.5 - 0.5 * cos(2.0 * M_PI * (i - SETTLE) / (n - SETTLE));
+		acc += w * (out[i] - mean) * cexp(-I * 2.0 * M_PI * f_out * i / (FS_HZ / DSP_DECIM_FACTOR));
+		wsum += w;
+	}
+	return 20.0 * log10(2.0 * cabs(acc) / wsum / AMPLITUDE);
+}
+
+int main(void) {
+
+	static const double alias_hz[] = { 3000.0, 3500.0, 4100.0, 5300.0, 6700.0, 7900.0, 9100.0, 9900.0 };
+	double fs_out = FS_HZ / DSP_DECIM_FACTOR;
+
+	// generated coefficients
+	double ripple = 0.0, stop = -999.0;
+	for (double f = 0.0; f <= PASS; f += 0.001) {
+		double g = coef_db(f);
+		ripple = fmax(ripple, fabs(g));
+		CHECK(fabs(g) <= RIPPLE_DB, "passband %.0f Hz: %+.3f dB", f * FS_HZ, g);
+	}
+	for (double f = STOP; f <= 0.5; f += 0.001) {
+		double g = coef_db(f);
+		stop = fmax(stop, g);
+		CHECK(g <= -STOP_DB, "stopband %.0f Hz: %.1f dB", f * FS_HZ, g);
+	}
+	printf("coefficients: passband +-%.3f dB, stopband %.1f dB\n", ripple, stop);
+
+	// passband tone keeps its level
+	double g = tone_db(1000.0, 1000.0);
+	printf("1000 Hz: %+.3f dB\n", g);
+	CHECK(fabs(g) <= GAIN_DB, "1000 Hz passband tone: %+.3f dB", g);
+
+	// tones above the new Nyquist, measured where they fold
+	for (uint32_t i = 0; i < sizeof(alias_hz) / sizeof(alias_hz[0]); i++) {
+		double f = alias_hz[i];
+		double fa = fmod(f, fs_out);
+		if (fa > fs_out / 2) {
+			fa = fs_out - fa;
+		}
+		g = tone_db(f, fa);
+		printf("%.0f Hz -> %.0f Hz: %.1f dB\n", f, fa, g);
+		CHECK(g <= -ALIAS_DB, "%.0f Hz folded to %.0f Hz: %.1f dB", f, fa, g);
+	}
+
+	TEST_END("test_decim");
+}
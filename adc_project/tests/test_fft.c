@@ -0,0 +1,125 @@
+/**
+ * test_fft.c
+ * -----------
+ * Accuracy of the Q15 real FFT against a double-precision DFT.
+ *
+ * For every size from FFT_POINTS_MIN to FFT_POINTS_MAX, a tone is
+ * quantized to the Q15 input format the ADC collector produces, run
+ * through 'fft_real_q15', and compared bin by bin with a double DFT of
+ * the same samples and the exact periodic Hann window, scaled like the
+ * fixed-point transform (2 / N, a full-scale sine peaks at 8192):
+ *
+ *   - peak bin and its level (dB) against the reference
+ *   - SNR: reference power over the power of the magnitude error,
+ *     which falls 3 dB per doubling of N (one halving per stage)
+ **/
+
+#include "fft.h"
+#include "test.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define FULL_AMP 16000.0 // -0.2 dBFS on the +-16384 collector scale
+#define LOW_AMP 164.0 // -40 dBFS
+#define FULL_PEAK_DB 0.05 // peak level error at full scale, dB
+#define FULL_SNR_DB 50.0 // minimum SNR at full scale (all sizes)
+#define LOW_PEAK_DB 0.5 // peak level error at -40 dBFS, dB
+
+static int16_t buf[FFT_POINTS_MAX];
+static uint32_t mag[FFT_POINTS_MAX / 2];
+static double win[FFT_POINTS_MAX];
+static double ref[FFT_POINTS_MAX / 2];
+static double cs[FFT_POINTS_MAX];
+static double sn[FFT_POINTS_MAX];
+
+typedef struct {
+
+	uint32_t peak; // bin of the largest reference magnitude
+	double peak_db; // level error at that bin, dB
+	double snr_db; // reference power / magnitude error power
+
+} Result_t;
+
+/**
+  * @brief  Transform one tone with both engines and compare
+  * @param  n Transform size
+  * @param  amp Amplitude on the Q15 collector scale
+  * @param  cycles Tone frequency in cycles per frame
+  * @retval Comparison result
+**/
+static Result_t run_tone(uint32_t n, double amp, double cycles) {
+
+	for (uint32_t i = 0; i < n; i++) {
+		cs[i] = cos(2.0 * M_PI * i / n);
+		sn[i] = sin(2.0 * M_PI * i / n);
+		buf[i] = (int16_t)lrint(amp * sin(2.0 * M_PI * cycles * i / n + 0.3));
+		win[i] = buf[i] * 0.5 * (1.0 - cs[i]);
+	}
+
+	// reference: N-point DFT of the windowed samples, scaled by 2 / N
+	for (uint32_t k = 0; k < n / 2; k++) {
+		double re = 0.0, im = 0.0;
+		for (uint32_t i = 0; i < n; i++) {
+			uint32_t idx = (uint32_t)(((uint64_t)k * i) % n);
+			re += win[i] * cs[idx];
+			im -= win[i] * sn[idx];
+		}
+		ref[k] = sqrt(re * re + im * im) * 2.0 / n;
+	}
+
+	fft_real_q15(buf, mag, (uint16_t)n);
+
+	Result_t r = { 0, 0.0, 0.0 };
+	double sig = 0.0, err = 0.0;
+	for (uint32_t k = 0; k < n / 2; k++) {
+		double q = sqrt((double)mag[k]);
+		sig += ref[k] * ref[k];
+		err += (q - ref[k]) * (q - ref[k]);
+		if (ref[k] > ref[r.peak]) {
+			r.peak = k;
+		}
+	}
+	r.peak_db = 20.0 * log10(sqrt((double)mag[r.peak]) / ref[r.peak]);
+	r.snr_db = 10.0 * log10(sig / err);
+	return r;
+}
+
+int main(void) {
+
+	for (uint32_t n = FFT_POINTS_MIN; n <= FFT_POINTS_MAX; n <<= 1) {
+
+		// bin-centred and between two bins, low and high in the band
+		const double tones[] = { 37.0, n / 8 + 0.3, 3 * n / 8 + 0.4 };
+
+		for (uint32_t t = 0; t < sizeof(tones) / sizeof(tones[0]); t++) {
+			Result_t r = run_tone(n, FULL_AMP, tones[t]);
+			uint32_t mag_peak = 0;
+			for (uint32_t k = 1; k < n / 2; k++) {
+				if (mag[k] > mag[mag_peak]) {
+					mag_peak = k;
+				}
+			}
+			printf("n=%4u tone=%7.1f full: peak %+.4f dB, snr %.1f dB\n",
+					(unsigned)n, tones[t], r.peak_db, r.snr_db);
+			CHECK(mag_peak == r.peak, "n=%u tone=%.1f: peak bin %u, reference %u",
+					(unsigned)n, tones[t], (unsigned)mag_peak, (unsigned)r.peak);
+			CHECK(fabs(r.peak_db) <= FULL_PEAK_DB, "n=%u tone=%.1f: peak error %.4f dB",
+					(unsigned)n, tones[t], r.peak_db);
+			CHECK(r.snr_db >= FULL_SNR_DB, "n=%u tone=%.1f: snr %.1f dB",
+					(unsigned)n, tones[t], r.snr_db);
+
+			r = run_tone(n, LOW_AMP, tones[t]);
+			printf("n=%4u tone=%7.1f -40 dBFS: peak %+.4f dB\n", (unsigned)n, tones[t], r.peak_db);
+			CHECK(fabs(r.peak_db) <= LOW_PEAK_DB, "n=%u tone=%.1f -40 dBFS: peak error %.4f dB",
+					(unsigned)n, tones[t], r.peak_db);
+		}
+	}
+
+	// dB conversion: full-scale bin is 0 dBFS, a quarter of the power -6.02 dB
+	CHECK(fft_bin_db(8192UL * 8192UL) == 0, "full scale -> %ld", (long)fft_bin_db(8192UL * 8192UL));
+	CHECK(abs((int)fft_bin_db(4096UL * 4096UL) + 60) <= 1, "-6 dB -> %ld", (long)fft_bin_db(4096UL * 4096UL));
+	CHECK(fft_bin_db(0) == FFT_DB_MIN, "zero -> %ld", (long)fft_bin_db(0));
+
+	TEST_END("test_fft");
+}
@@ -0,0 +1,137 @@
+/**
+ * test_octave.c
+ * --------------
+ * Frequency response of the octave / 1/3-octave filter bank.
+ *
+ * From the generated coefficients (tools/gen_tables.py), evaluated on
+ * the unit circle at the stage-normalized frequencies:
+ *
+ *   - every band-pass: 0 dB at its centre, -3 dB at its edges
+ *     (centre * 2^(+-1/2) for octaves, 2^(+-1/6) for 1/3 octaves),
+ *     attenuation one octave out and, for 1/3 octaves, at the
+ *     neighbouring band centres
+ *   - decimation low-pass: flat over the next stage's bands, and
+ *     enough attenuation where the 2:1 decimation folds back onto them
+ *
+ * End to end, a tone at each octave centre is pushed through the
+ * multirate bank ('octave_push') at 20 kHz: its band must read the
+ * tone's RMS and be the loudest band.
+ **/
+
+#include "octave.h"
+#include "test.h"
+#include <complex.h>
+#include <math.h>
+#include <stdint.h>
+
+#define FS_HZ 20000U // input rate of the end-to-end test
+#define CENTRE_DB 0.1 // band centre gain tolerance, dB
+#define EDGE_DB 0.2 // band edge tolerance around -3.01 dB
+#define OCT_OUT_DB 17.0 // octave band: minimum attenuation one octave from the centre
+#define THIRD_NEXT_DB 15.0 // 1/3 octave: minimum attenuation at the neighbouring centres
+#define THIRD_OUT_DB 40.0 // 1/3 octave: minimum attenuation one octave from the centre
+#define LP_PASS_DB 0.2 // decimation low-pass droop over the next stage's bands
+#define LP_STOP_DB 60.0 // decimation low-pass attenuation where it folds onto them
+#define LEVEL_DB 0.5 // end to end: band level against the tone RMS
+#define NEIGHBOUR_DB 10.0 // end to end: neighbouring octave bands at least this much lower
+
+static OCTAVE_Handle_t oct;
+
+/**
+  * @brief  Gain of a biquad cascade from the generated table
+  * @param  *coef OCTAVE_SECTIONS x {b0, b1, b2, a1, a2}
+  * @param  f Frequency, fraction of the stage rate
+  * @retval Gain in dB
+**/
+static double cascade_db(const float* coef, double f) {
+
+	double complex z1 = cexp(-I * 2.0 * M_PI * f);
+	double complex h = 1.0;
+	for (uint32_t s = 0; s < OCTAVE_SECTIONS; s++, coef += 5) {
+		h *= (coef[0] + coef[1] * z1 + coef[2] * z1 * z1) / (1.0 + coef[3] * z1 + coef[4] * z1 * z1);
+	}
+	return 20.0 * log10(cabs(h));
+}
+
+/**
+  * @brief  Check one band-pass design
+  * @param  *coef Band-pass coefficients
+  * @param  fc Centre, fraction of the stage rate
+  * @param  half_bw Band edges at fc * 2^(+-half_bw)
+  * @param  *name Label for failures
+  * @retval Void
+**/
+static void check_band(const float* coef, double fc, double half_bw, const char* name) {
+
+	double centre = cascade_db(coef, fc);
+	double lo = cascade_db(coef, fc * pow(2.0, -half_bw));
+	double hi = cascade_db(coef, fc * pow(2.0, half_bw));
+
+	printf("%-8s centre %+.3f dB, edges %+.3f / %+.3f dB\n", name, centre, lo, hi);
+	CHECK(fabs(centre) <= CENTRE_DB, "%s centre %.3f dB", name, centre);
+	CHECK(fabs(lo + 3.01) <= EDGE_DB, "%s lower edge %.3f dB", name, lo);
+	CHECK(fabs(hi + 3.01) <= EDGE_DB, "%s upper edge %.3f dB", name, hi);
+}
+
+int main(void) {
+
+	const double fc = 1.0 / DSP_OCT_CENTER_DIV;
+
+	// octave band-pass
+	check_band(dsp_oct_band, fc, 0.5, "octave");
+	CHECK(cascade_db(dsp_oct_band, fc / 2.0) <= -OCT_OUT_DB, "octave below: %.2f dB", cascade_db(dsp_oct_band, fc / 2.0));
+	CHECK(cascade_db(dsp_oct_band, fc * 2.0) <= -OCT_OUT_DB, "octave above: %.2f dB", cascade_db(dsp_oct_band, fc * 2.0));
+
+	// 1/3-octave band-passes, lowest first
+	for (uint32_t j = 0; j < 3; j++) {
+		const float* coef = &dsp_oct_third[j * OCTAVE_SECTIONS * 5];
+		double f = fc * pow(2.0, ((double)j - 1.0) / 3.0);
+		char name[16];
+		snprintf(name, sizeof(name), "third %u", (unsigned)j);
+
+		check_band(coef, f, 1.0 / 6.0, name);
+		double below = cascade_db(coef, f * pow(2.0, -1.0 / 3.0));
+		double above = cascade_db(coef, f * pow(2.0, 1.0 / 3.0));
+		CHECK(below <= -THIRD_NEXT_DB && above <= -THIRD_NEXT_DB, "%s neighbours %.2f / %.2f dB", name, below, above);
+		below = cascade_db(coef, f / 2.0);
+		above = cascade_db(coef, fmin(f * 2.0, 0.499));
+		CHECK(below <= -THIRD_OUT_DB && above <= -THIRD_OUT_DB, "%s octave out %.2f / %.2f dB", name, below, above);
+	}
+
+	// decimation low-pass: next stage (half the rate) has bands up to fc * 2^(1/2) of its rate
+	double top = fc * sqrt(2.0) / 2.0;
+	CHECK(cascade_db(dsp_oct_lp, top) >= -LP_PASS_DB, "low-pass at %.4f: %.3f dB", top, cascade_db(dsp_oct_lp, top));
+	for (double f = 0.5 - top; f < 0.5; f += 0.005) {
+		CHECK(cascade_db(dsp_oct_lp, f) <= -LP_STOP_DB, "low-pass at %.4f: %.2f dB", f, cascade_db(dsp_oct_lp, f));
+	}
+	printf("low-pass %+.3f dB at %.4f fs, %.1f dB at %.4f fs\n", cascade_db(dsp_oct_lp, top), top,
+			cascade_db(dsp_oct_lp, 0.5 - top), 0.5 - top);
+
+	// end to end: tone at each octave centre through the multirate bank
+	octave_init(&oct, OCTAVE_MODE_OCTAVE, OCTAVE_WINDOW_DEFAULT);
+	for (uint32_t b = 0; b < oct.bands; b++) {
+		double f = octave_band_hz(&oct, b, FS_HZ);
+		double amp = 1000.0;
+
+		octave_set_mode(&oct, OCTAVE_MODE_OCTAVE);
+		for (uint32_t n = 0; n < 8U * FS_HZ; n++) {
+			octave_push(&oct, (float)(amp * sin(2.0 * M_PI * f * n / FS_HZ)));
+		}
+
+		double level_db = 20.0 * log10(oct.level[b] / (amp / sqrt(2.0)));
+		printf("band %u %8.2f Hz: level %+.2f dB", (unsigned)b, f, level_db);
+		CHECK(fabs(level_db) <= LEVEL_DB, "band %u (%.2f Hz) level %.2f dB", (unsigned)b, f, level_db);
+		for (int32_t d = -1; d <= 1; d += 2) {
+			int32_t nb = (int32_t)b + d;
+			if (nb < 0 || nb >= oct.bands) {
+				continue;
+			}
+			double rel = 20.0 * log10((oct.level[nb] + 0.5) / (double)oct.level[b]);
+			printf(", band %d %+.1f dB", (int)nb, rel);
+			CHECK(rel <= -NEIGHBOUR_DB, "band %u tone: band %d at %.1f dB", (unsigned)b, (int)nb, rel);
+		}
+		printf("\n");
+	}
+
+	TEST_END("test_octave");
+}
@@ -0,0 +1,161 @@
+/**
+ * test_weighting.c
+ * -----------------
+ * A / C weighting response against IEC 61672-1 class 1 tolerances.
+ *
+ * The generated cascades (dsp_weight_a / dsp_weight_c) are evaluated
+ * on the unit circle at the exact base-10 1/3-octave frequencies
+ * f = 1000 * 10^(n / 10) Hz from 10 Hz up to the last one below
+ * Nyquist, and compared with the standard's analytic weightings
+ * (IEC 61672-1 Annex E, normalized to 0 dB at 1 kHz). The deviation
+ * must stay inside the class 1 acceptance limits of table 3.
+ *
+ * 'weighting_process_block' is also run on a 1 kHz tone to check that
+ * the filter as executed (float DF2T, 12-bit re-biased output) passes
+ * it at 0 dB.
+ **/
+
+#include "weighting.h"
+#include "adc.h"
+#include "test.h"
+#include <complex.h>
+#include <math.h>
+#include <stdint.h>
+
+#define FS_HZ DSP_WEIGHT_FS_HZ
+#define TONE_DB 0.1 // 1 kHz tone through the block filter, dB
+
+// IEC 61672-1 Annex E pole frequencies, Hz
+#define F1 20.598997
+#define F2 107.65265
+#define F3 737.86223
+#define F4 12194.217
+
+typedef struct {
+
+	int16_t n; // band number, f = 1000 * 10^(n / 10)
+	double upper; // class 1 limits, dB (lower < -90: no limit)
+	double lower;
+
+} Limit_t;
+
+// IEC 61672-1:2013 table 3, class 1, 10 Hz .. 8 kHz (10 kHz and up are at or above Nyquist)
+static const Limit_t limits[] = {
+	{ -20, 3.5, -99.0 }, { -19, 3.0, -99.0 }, { -18, 2.5, -4.5 }, { -17, 2.5, -2.5 },
+	{ -16, 2.5, -2.0 }, { -15, 2.0, -2.0 }, { -14, 1.5, -1.5 }, { -13, 1.5, -1.5 },
+	{ -12, 1.5, -1.5 }, { -11, 1.5, -1.5 }, { -10, 1.5, -1.5 }, { -9, 1.5, -1.5 },
+	{ -8, 1.5, -1.5 }, { -7, 1.5, -1.5 }, { -6, 1.4, -1.4 }, { -5, 1.4, -1.4 },
+	{ -4, 1.4, -1.4 }, { -3, 1.4, -1.4 }, { -2, 1.4, -1.4 }, { -1, 1.4, -1.4 },
+	{ 0, 1.1, -1.1 }, { 1, 1.4, -1.4 }, { 2, 1.6, -1.6 }, { 3, 1.6, -1.6 },
+	{ 4, 1.6, -1.6 }, { 5, 1.6, -1.6 }, { 6, 1.6, -1.6 }, { 7, 2.1, -2.1 },
+	{ 8, 2.1, -2.6 }, { 9, 2.1, -3.1 },
+};
+
+static uint16_t blk[FS_HZ / 10];
+static uint16_t out[FS_HZ / 10];
+
+/**
+  * @brief  Analytic C weighting (IEC 61672-1 E.2), not normalized
+  * @param  f Frequency, Hz
+  * @retval Gain in dB
+**/
+static double iec_c(double f) {
+	double f2 = f * f;
+	return 20.0 * log10(F4 * F4 * f2 / ((f2 + F1 * F1) * (f2 + F4 * F4)));
+}
+
+/**
+  * @brief  Analytic A weighting (IEC 61672-1 E.3), not normalized
+  * @param  f Frequency, Hz
+  * @retval Gain in dB
+**/
+static double iec_a(double f) {
+	double f2 = f * f;
+	return 20.0 * log10(F4 * F4 * f2 * f2 / ((f2 + F1 * F1) * sqrt(f2 + F2 * F2) * sqrt(f2 + F3 * F3) * (f2 + F4 * F4)));
+}
+
+/**
+  * @brief  Gain of a generated biquad cascade
+  * @param  *coef {b0, b1, b2, a1, a2} per section
+  * @param  sections Number of sections
+  * @param  f Frequency, Hz
+  * @retval Gain in dB
+**/
+static double cascade_db(const float* coef, uint32_t sections, double f) {
+
+	double complex z1 = cexp(-I * 2.0 * M_PI * f / FS_HZ);
+	double complex h = 1.0;
+	for (uint32_t s = 0; s < sections; s++, coef += 5) {
+		h *= (coef[0] + coef[1] * z1 + coef[2] * z1 * z1) / (1.0 + coef[3] * z1 + coef[4] * z1 * z1);
+	}
+	return 20.0 * log10(cabs(h));
+}
+
+/**
+  * @brief  Check one weighting against the class 1 limits
+  * @param  *coef Generated cascade
+  * @param  sections Number of sections
+  * @param  iec Analytic weighting
+  * @param  letter 'A' or 'C'
+  * @retval Void
+**/
+static void check_curve(const float* coef, uint32_t sections, double (*iec)(double), char letter) {
+
+	double worst = 0.0;
+	for (uint32_t i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+		double f = 1000.0 * pow(10.0, limits[i].n / 10.0);
+		double nominal = iec(f) - iec(1000.0);
+		double dev = cascade_db(coef, sections, f) - nominal;
+		if (fabs(dev) > fabs(worst)) {
+			worst = dev;
+		}
+		CHECK(dev <= limits[i].upper && dev >= limits[i].lower, "%c at %.1f Hz: %+.2f dB from nominal %.2f dB (limits %+.1f / %+.1f)",
+				letter, f, dev, nominal, limits[i].upper, limits[i].lower);
+	}
+	printf("%c-weighting: worst deviation %+.3f dB (10 Hz .. 8 kHz)\n", letter, worst);
+}
+
+/**
+  * @brief  Run a 1 kHz tone through the block filter
+  * @param  mode Weighting
+  * @retval Output / input RMS in dB, after settling
+**/
+static double tone_db(WEIGHT_Mode_t mode) {
+
+	WEIGHT_Handle_t w;
+	double in = 0.0, o = 0.0;
+	weighting_init(&w, mode);
+
+	for (uint32_t pass = 0; pass < 5; pass++) {
+		for (uint32_t i = 0; i < sizeof(blk) / sizeof(blk[0]); i++) {
+			blk[i] = (uint16_t)lrint(ADC_MIDRAIL + 1500.0 * sin(2.0 * M_PI * 1000.0 * i / FS_HZ));
+		}
+		const uint16_t* y = weighting_process_block(&w, blk, out, sizeof(blk) / sizeof(blk[0]));
+		if (pass == 0) {
+			continue;
+		}
+		for (uint32_t i = 0; i < sizeof(blk) / sizeof(blk[0]); i++) {
+			double x = (double)blk[i] - ADC_MIDRAIL;
+			double v = (double)y[i] - ADC_MIDRAIL;
+			in += x * x;
+			o += v * v;
+		}
+	}
+	return 10.0 * log10(o / in);
+}
+
+int main(void) {
+
+	check_curve(dsp_weight_a, DSP_WEIGHT_A_SECTIONS, iec_a, 'A');
+	check_curve(dsp_weight_c, DSP_WEIGHT_C_SECTIONS, iec_c, 'C');
+
+	double a = tone_db(WEIGHT_A);
+	double c = tone_db(WEIGHT_C);
+	double z = tone_db(WEIGHT_Z);
+	printf("1 kHz through the block filter: A %+.3f dB, C %+.3f dB, Z %+.3f dB\n", a, c, z);
+	CHECK(fabs(a) <= TONE_DB, "A at 1 kHz: %.3f dB", a);
+	CHECK(fabs(c) <= TONE_DB, "C at 1 kHz: %.3f dB", c);
+	CHECK(fabs(z) <= 1e-9, "Z at 1 kHz: %.3f dB", z);
+
+	TEST_END("test_weighting");
+}
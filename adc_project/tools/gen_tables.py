@@ -0,0 +1,358 @@
+#!/usr/bin/env python3
+"""
+gen_tables.py
+--------------
+Generates the constant DSP tables used by the firmware.
+
+Writes Core/Inc/dsp_tables.h and Core/Src/dsp_tables.c. Run from the
+project folder after changing any table parameter below, and commit
+the regenerated files together with the change:
+
+    python3 tools/gen_tables.py
+"""
+
+import cmath
+import math
+import os
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+
+# log2 fraction table: log2(1 + i / N) in Q16, i = 0..N-1
+LOG2_BITS = 8
+
+# FFT window / twiddle tables are built for the largest size; smaller
+# power-of-two sizes index them with a stride of FFT_MAX / N
+FFT_MAX_BITS = 11
+
+# octave filter bank: every decimation stage reuses the same designs,
+# normalized to the stage rate. Band centre is fs / 5 (4 kHz at 20 kHz),
+# 1/3-octave bands sit at 2^(-1/3), 1, 2^(1/3) times that. Each band is a
+# 6th-order Butterworth band-pass (3 biquads); the decimation low-pass is
+# a 6th-order Butterworth at OCT_LP_CUTOFF * fs (3 biquads).
+OCT_CENTER = 0.2
+OCT_LP_CUTOFF = 0.18
+OCT_ORDER = 3  # low-pass prototype order (band-pass order 2 * OCT_ORDER)
+
+# A / C frequency weighting (IEC 61672-1) at the ADC sample rate; must
+# match TIM2_RATE_HZ. Low-frequency poles and the zeros at DC go through
+# the bilinear transform; the 12194 Hz pole pair lies above Nyquist and
+# is replaced by an FIR section (1 + beta z^-1)^2 fitted at WEIGHT_FIT_HZ.
+WEIGHT_FS = 20000
+WEIGHT_FIT_HZ = 8000
+WEIGHT_POLES_A = [20.598997, 20.598997, 107.65265, 737.86223]
+WEIGHT_POLES_C = [20.598997, 20.598997]
+WEIGHT_POLE_HI = 12194.217
+
+# polyphase FIR decimator: Kaiser-windowed sinc low-pass, taps a multiple
+# of 2 * DECIM_FACTOR so every phase has an even length (SMLAD pairs).
+# Passband to DECIM_PASS, stopband from DECIM_STOP (fractions of the
+# input rate); everything above DECIM_STOP aliases outside the passband.
+DECIM_FACTOR = 4
+DECIM_TAPS = 96
+DECIM_PASS = 0.10
+DECIM_STOP = 0.15
+DECIM_ATTEN_DB = 70
+
+# oversampling mode: OVS_CIC_ORDER-stage CIC decimating by OVS_CIC_RATIO
+# (600 kHz ADC rate -> 20 kHz), then a compensation FIR decimating by
+# OVS_FIR_DECIM. The FIR inverts the CIC sinc^N droop up to OVS_PASS and
+# stops from OVS_STOP (fractions of the CIC output rate); the desired
+# response is sampled on a dense grid and Kaiser-windowed.
+OVS_CIC_RATIO = 30
+OVS_CIC_ORDER = 4
+OVS_FIR_DECIM = 2
+OVS_FIR_TAPS = 48
+OVS_PASS = 0.18
+OVS_STOP = 0.28
+OVS_ATTEN_DB = 60
+
+
+def c_array(ctype, name, values, per_line=8):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("\t" + ", ".join(str(v) for v in values[i:i + per_line]) + ",")
+    return "const %s %s[%d] = {\n%s\n};\n" % (ctype, name, len(values), "\n".join(lines))
+
+
+def table_log2():
+    n = 1 << LOG2_BITS
+    vals = [int(round(math.log2(1.0 + i / n) * 65536)) for i in range(n)]
+    decl = "#define DSP_LOG2_BITS %d // log2 fraction table index bits\n" % LOG2_BITS
+    decl += "extern const uint16_t dsp_log2_frac[%d]; // log2(1 + i / %d), Q16\n" % (n, n)
+    body = "// log2(1 + i / %d), Q16\n" % n + c_array("uint16_t", "dsp_log2_frac", vals)
+    return decl, body
+
+
+def c_float_array(name, values, per_line=5):
+    return c_array("float", name, ["%.9ef" % v for v in values], per_line)
+
+
+def biquad_lowpass(fc, q):
+    # RBJ cookbook low-pass, fc as a fraction of fs, normalized to a0 = 1
+    w0 = 2 * math.pi * fc
+    alpha = math.sin(w0) / (2 * q)
+    cw = math.cos(w0)
+    a0 = 1 + alpha
+    return [(1 - cw) / 2 / a0, (1 - cw) / a0, (1 - cw) / 2 / a0, -2 * cw / a0, (1 - alpha) / a0]
+
+
+def butter_lowpass(fc, order):
+    # cascade of 'order / 2' biquads, Butterworth pole Qs
+    sections = []
+    for k in range(order // 2):
+        theta = math.pi * (2 * k + 1) / (2 * order)
+        sections.append(biquad_lowpass(fc, 1 / (2 * math.cos(theta))))
+    return sections
+
+
+def butter_bandpass(f1, f2, order):
+    # analog Butterworth low-pass prototype -> band-pass (prewarped edges)
+    # -> bilinear transform; one biquad per conjugate pole pair, zeros at
+    # z = +1 and z = -1, each section unity gain at the band centre
+    fs = 1.0
+    w1 = 2 * fs * math.tan(math.pi * f1 / fs)
+    w2 = 2 * fs * math.tan(math.pi * f2 / fs)
+    w0 = math.sqrt(w1 * w2)
+    bw = w2 - w1
+    poles = []
+    for k in range(order):
+        p = cmath.exp(1j * math.pi * (2 * k + order + 1) / (2 * order))
+        d = cmath.sqrt((p * bw) ** 2 - 4 * w0 * w0)
+        for s in ((p * bw + d) / 2, (p * bw - d) / 2):
+            if s.imag > 0:
+                poles.append(s)
+    wc = 2 * math.atan(w0 / (2 * fs))
+    zc = cmath.exp(1j * wc)
+    sections = []
+    for s in poles:
+        zp = (2 * fs + s) / (2 * fs - s)
+        a1 = -2 * zp.real
+        a2 = abs(zp) ** 2
+        h = (1 - zc ** -2) / (1 + a1 * zc ** -1 + a2 * zc ** -2)
+        g = 1 / abs(h)
+        sections.append([g, 0.0, -g, a1, a2])
+    return sections
+
+
+def table_octave():
+    lp = butter_lowpass(OCT_LP_CUTOFF, 2 * OCT_ORDER)
+    octave = butter_bandpass(OCT_CENTER / math.sqrt(2), OCT_CENTER * math.sqrt(2), OCT_ORDER)
+    third = []
+    for i in (-1, 0, 1):
+        fc = OCT_CENTER * 2 ** (i / 3)
+        third += butter_bandpass(fc * 2 ** (-1 / 6), fc * 2 ** (1 / 6), OCT_ORDER)
+    flat = lambda secs: [v for s in secs for v in s]
+    decl = "#define DSP_OCT_SECTIONS %d // biquads per band / per decimation low-pass\n" % OCT_ORDER
+    decl += "#define DSP_OCT_CENTER_DIV %d // band centre = stage rate / DSP_OCT_CENTER_DIV\n" % round(1 / OCT_CENTER)
+    decl += "extern const float dsp_oct_lp[%d]; // decimation low-pass, {b0, b1, b2, a1, a2} per section\n" % len(flat(lp))
+    decl += "extern const float dsp_oct_band[%d]; // octave band-pass, {b0, b1, b2, a1, a2} per section\n" % len(flat(octave))
+    decl += "extern const float dsp_oct_third[%d]; // 1/3-octave band-passes, low to high\n" % len(flat(third))
+    body = "// 6th-order Butterworth low-pass at %.2f fs\n" % OCT_LP_CUTOFF + c_float_array("dsp_oct_lp", flat(lp))
+    body += "\n// 6th-order Butterworth octave band-pass centred at fs / %d\n" % round(1 / OCT_CENTER) + c_float_array("dsp_oct_band", flat(octave))
+    body += "\n// 6th-order Butterworth 1/3-octave band-passes at fs / %d * 2^(-1/3, 0, 1/3)\n" % round(1 / OCT_CENTER) + c_float_array("dsp_oct_third", flat(third))
+    return decl, body
+
+
+def weight_hi_section(fs):
+    # magnitude of the analog double pole, and of the FIR stand-in
+    analog = lambda f: WEIGHT_POLE_HI ** 2 / (f * f + WEIGHT_POLE_HI ** 2)
+    fir = lambda beta, f: abs((1 + beta * cmath.exp(-2j * math.pi * f / fs)) ** 2) / (1 + beta) ** 2
+    lo, hi = 0.0, 1.0
+    for _ in range(60):
+        beta = (lo + hi) / 2
+        if fir(beta, WEIGHT_FIT_HZ) > analog(WEIGHT_FIT_HZ):
+            lo = beta
+        else:
+            hi = beta
+    return [1.0, 2 * beta, beta * beta, 0.0, 0.0]
+
+
+def weight_design(poles, fs):
+    # pairs of (s / (s + w)) terms -> bilinear -> one biquad per pair
+    k = 2.0 * fs
+    sections = []
+    for i in range(0, len(poles), 2):
+        q = [(k - 2 * math.pi * p) / (k + 2 * math.pi * p) for p in poles[i:i + 2]]
+        g = 1.0
+        for p in poles[i:i + 2]:
+            g *= k / (k + 2 * math.pi * p)
+        sections.append([g, -2 * g, g, -(q[0] + q[1]), q[0] * q[1]])
+    sections.append(weight_hi_section(fs))
+
+    # 0 dB at 1 kHz, applied to the first section
+    z = cmath.exp(-2j * math.pi * 1000 / fs)
+    h = 1.0
+    for b0, b1, b2, a1, a2 in sections:
+        h *= (b0 + b1 * z + b2 * z * z) / (1 + a1 * z + a2 * z * z)
+    sections[0] = [v / abs(h) for v in sections[0][:3]] + sections[0][3:]
+    return sections
+
+
+def table_weighting():
+    a = weight_design(WEIGHT_POLES_A, WEIGHT_FS)
+    c = weight_design(WEIGHT_POLES_C, WEIGHT_FS)
+    flat = lambda secs: [v for s in secs for v in s]
+    decl = "#define DSP_WEIGHT_FS_HZ %d // sample rate the weighting filters were designed for\n" % WEIGHT_FS
+    decl += "#define DSP_WEIGHT_A_SECTIONS %d // biquads in the A-weighting filter\n" % len(a)
+    decl += "#define DSP_WEIGHT_C_SECTIONS %d // biquads in the C-weighting filter\n" % len(c)
+    decl += "extern const float dsp_weight_a[%d]; // A-weighting, {b0, b1, b2, a1, a2} per section\n" % len(flat(a))
+    decl += "extern const float dsp_weight_c[%d]; // C-weighting, {b0, b1, b2, a1, a2} per section\n" % len(flat(c))
+    body = "// A-weighting at %d Hz, 0 dB at 1 kHz\n" % WEIGHT_FS + c_float_array("dsp_weight_a", flat(a))
+    body += "\n// C-weighting at %d Hz, 0 dB at 1 kHz\n" % WEIGHT_FS + c_float_array("dsp_weight_c", flat(c))
+    return decl, body
+
+
+def bessel_i0(x):
+    s, t, k = 1.0, 1.0, 1
+    while t > 1e-12 * s:
+        t *= (x / (2 * k)) ** 2
+        s += t
+        k += 1
+    return s
+
+
+def decim_design():
+    n = DECIM_TAPS
+    beta = 0.1102 * (DECIM_ATTEN_DB - 8.7)
+    fc = (DECIM_PASS + DECIM_STOP) / 2
+    h = []
+    for i in range(n):
+        m = i - (n - 1) / 2
+        sinc = 2 * fc if m == 0 else math.sin(2 * math.pi * fc * m) / (math.pi * m)
+        w = bessel_i0(beta * math.sqrt(1 - (2 * i / (n - 1) - 1) ** 2)) / bessel_i0(beta)
+        h.append(sinc * w)
+    g = sum(h)
+    return [v / g for v in h]
+
+
+def cic_gain(f):
+    # normalized CIC magnitude at f (fraction of the CIC output rate)
+    if f == 0:
+        return 1.0
+    r = OVS_CIC_RATIO
+    return abs(math.sin(math.pi * f) / (r * math.sin(math.pi * f / r))) ** OVS_CIC_ORDER
+
+
+def ovs_design():
+    n = OVS_FIR_TAPS
+    grid = 4096
+    peak = 1 / cic_gain(OVS_PASS)
+
+    def desired(f):
+        if f <= OVS_PASS:
+            return 1 / cic_gain(f)
+        if f >= OVS_STOP:
+            return 0.0
+        # raised-cosine taper across the transition band
+        return peak * 0.5 * (1 + math.cos(math.pi * (f - OVS_PASS) / (OVS_STOP - OVS_PASS)))
+
+    beta = 0.1102 * (OVS_ATTEN_DB - 8.7)
+    d = [desired((k + 0.5) / (2 * grid)) for k in range(grid)]
+    h = []
+    for i in range(n):
+        m = i - (n - 1) / 2
+        v = sum(d[k] * math.cos(2 * math.pi * (k + 0.5) / (2 * grid) * m) for k in range(grid)) / grid
+        w = bessel_i0(beta * math.sqrt(1 - (2 * i / (n - 1) - 1) ** 2)) / bessel_i0(beta)
+        h.append(v * w)
+    g = sum(h)
+    return [v / g for v in h]
+
+
+def table_oversample():
+    h = ovs_design()
+    decl = "#define DSP_OVS_CIC_RATIO %d // CIC decimation ratio R\n" % OVS_CIC_RATIO
+    decl += "#define DSP_OVS_CIC_ORDER %d // CIC stages N\n" % OVS_CIC_ORDER
+    decl += "#define DSP_OVS_FIR_DECIM %d // compensation FIR decimation factor\n" % OVS_FIR_DECIM
+    decl += "#define DSP_OVS_FIR_TAPS %d // compensation FIR length\n" % OVS_FIR_TAPS
+    decl += "extern const float dsp_ovs_fir[%d]; // CIC compensation FIR, unity DC gain\n" % OVS_FIR_TAPS
+    body = "// inverse sinc^%d (R = %d) to %.2f fs, stop from %.2f fs, Kaiser %d dB, unity DC gain\n" % (
+        OVS_CIC_ORDER, OVS_CIC_RATIO, OVS_PASS, OVS_STOP, OVS_ATTEN_DB) + c_float_array("dsp_ovs_fir", h)
+    return decl, body
+
+
+def table_decim():
+    assert DECIM_TAPS % (2 * DECIM_FACTOR) == 0
+    h = [q15(v) for v in decim_design()]
+    phase_len = DECIM_TAPS // DECIM_FACTOR
+    # polyphase order: phase p holds h[p], h[p + M], h[p + 2M], ...
+    poly = [h[l * DECIM_FACTOR + p] for p in range(DECIM_FACTOR) for l in range(phase_len)]
+    decl = "#define DSP_DECIM_FACTOR %d // default decimation factor\n" % DECIM_FACTOR
+    decl += "#define DSP_DECIM_TAPS %d // default decimator length\n" % DECIM_TAPS
+    decl += "extern const int16_t dsp_decim_coef[%d]; // Q15, polyphase order [phase][tap]\n" % DECIM_TAPS
+    body = "// Kaiser-windowed sinc, pass %.2f / stop %.2f fs, %d dB, polyphase order [phase][tap]\n" % (
+        DECIM_PASS, DECIM_STOP, DECIM_ATTEN_DB) + c_array("int16_t", "dsp_decim_coef", poly)
+    return decl, body
+
+
+def q15(v):
+    return max(-32768, min(32767, int(round(v * 32768))))
+
+
+def table_fft_window():
+    n = 1 << FFT_MAX_BITS
+    # periodic Hann, so every strided subset is the Hann window of that size
+    vals = [q15(0.5 - 0.5 * math.cos(2 * math.pi * i / n)) for i in range(n)]
+    decl = "#define DSP_FFT_MAX_BITS %d // log2 of the largest FFT size\n" % FFT_MAX_BITS
+    decl += "extern const int16_t dsp_fft_hann[%d]; // periodic Hann window, Q15\n" % n
+    body = "// periodic Hann window, 0.5 - 0.5 cos(2 pi i / %d), Q15\n" % n + c_array("int16_t", "dsp_fft_hann", vals)
+    return decl, body
+
+
+def table_fft_twiddle():
+    n = 1 << FFT_MAX_BITS
+    vals = []
+    for k in range(n // 2):
+        vals.append(q15(math.cos(2 * math.pi * k / n)))
+        vals.append(q15(-math.sin(2 * math.pi * k / n)))
+    decl = "extern const int16_t dsp_fft_twiddle[%d]; // W^k = exp(-j 2 pi k / %d), k < %d, {re, im} Q15\n" % (n, n, n // 2)
+    body = "// W^k = cos(2 pi k / %d) - j sin(2 pi k / %d), interleaved {re, im}, Q15\n" % (n, n) + c_array("int16_t", "dsp_fft_twiddle", vals)
+    return decl, body
+
+
+TABLES = [table_log2, table_fft_window, table_fft_twiddle, table_octave, table_weighting, table_decim, table_oversample]
+
+HEADER = """/**
+ * dsp_tables.h
+ * -------------
+ * Constant DSP tables.
+ *
+ * GENERATED by tools/gen_tables.py - do not edit by hand.
+ **/
+
+#ifndef DSP_TABLES_H
+#define DSP_TABLES_H
+
+#include <stdint.h>
+
+%s
+#endif
+"""
+
+SOURCE = """/**
+ * dsp_tables.c
+ * -------------
+ * Constant DSP tables.
+ *
+ * GENERATED by tools/gen_tables.py - do not edit by hand.
+ **/
+
+#include "dsp_tables.h"
+#include <stdint.h>
+
+%s"""
+
+
+def main():
+    decls, bodies = [], []
+    for t in TABLES:
+        d, b = t()
+        decls.append(d)
+        bodies.append(b)
+    with open(os.path.join(ROOT, "Core", "Inc", "dsp_tables.h"), "w") as f:
+        f.write(HEADER % "\n".join(decls))
+    with open(os.path.join(ROOT, "Core", "Src", "dsp_tables.c"), "w") as f:
+        f.write(SOURCE % "\n".join(bodies))
+
+
+if __name__ == "__main__":
+    main()